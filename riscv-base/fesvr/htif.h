@@ -29,6 +29,10 @@ class htif_t
   virtual uint32_t num_cores();
   virtual uint32_t mem_mb();
 
+  // In a forked child: drop the target's writes and give it private read
+  // offsets, so that it does not disturb the parent's files (see fds_t::detach).
+  void detach_target_files() { syscall_proxy.detach_files(); }
+
  protected:
   virtual void read_chunk(addr_t taddr, size_t len, void* dst);
   virtual void write_chunk(addr_t taddr, size_t len, const void* src);
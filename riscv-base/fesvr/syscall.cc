@@ -358,6 +358,39 @@ void fds_t::dealloc(reg_t fd)
   fds[fd] = -1;
 }
 
+// Called in a forked child, whose host descriptors share their file offsets
+// with the parent's.  A regular file open for reading only is reopened at the
+// same offset, so the child reads what the parent will; every other descriptor
+// (console, pipes, files open for writing) is pointed at /dev/null, so the
+// child's writes are dropped and it never consumes the parent's input.
+void fds_t::detach()
+{
+  int null_fd = open("/dev/null", O_RDWR);
+  if (null_fd < 0)
+    throw std::runtime_error("could not open /dev/null");
+
+  for (size_t i = 0; i < fds.size(); i++) {
+    int fd = fds[i], flags = fcntl(fd, F_GETFL), copy = -1;
+    struct stat s;
+    if (fd < 0 || flags < 0)
+      continue;
+
+    if ((flags & O_ACCMODE) == O_RDONLY && fstat(fd, &s) == 0 && S_ISREG(s.st_mode)) {
+      off_t off = lseek(fd, 0, SEEK_CUR);
+      copy = open(("/proc/self/fd/" + std::to_string(fd)).c_str(), O_RDONLY);
+      if (copy >= 0 && (off < 0 || lseek(copy, off, SEEK_SET) != off)) {
+        close(copy);
+        copy = -1;
+      }
+    }
+
+    dup2(copy >= 0 ? copy : null_fd, fd);
+    if (copy >= 0)
+      close(copy);
+  }
+  close(null_fd);
+}
+
 int fds_t::lookup(reg_t fd)
 {
   if (int(fd) == RISCV_AT_FDCWD)
@@ -20,6 +20,7 @@ class fds_t
   reg_t alloc(int fd);
   void dealloc(reg_t fd);
   int lookup(reg_t fd);
+  void detach();
  private:
   std::vector<int> fds;
 };
@@ -28,6 +29,9 @@ class syscall_t : public device_t
 {
  public:
   syscall_t(htif_t*);
+
+  // In a forked child: stop sharing the target's files with the parent.
+  void detach_files() { fds.detach(); }
   
  private:
   const char* identity() { return "syscall_proxy"; }
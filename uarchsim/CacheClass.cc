@@ -15,6 +15,7 @@
 
 #include "histogram.h"
 #include "cache.h"
+#include "prefetch.h"
 #include "CacheClass.h"
 #include "pipeline.h"
 #include "stats.h"
@@ -24,16 +25,27 @@ CacheClass::CacheClass(int sets, int assoc, int _lineSize,
                        int _hitLatency, int _missLatency,
                        int _numMHSR, int _numMissSrvPorts,  int _missSrvLatency,
                        pipeline_t* _proc, const char* _identifier, 
-                       CacheClass* _nextLevel, int histLen)
+                       CacheClass* _nextLevel, const char* _policy,
+                       const char* _prefetcher, int histLen)
 	: proc(_proc),
-    array(sets, assoc),  // Allocate cache array.
+    array(sets, assoc, _policy),  // Allocate cache array.
     nextLevel(_nextLevel),
+    nextLevelMissed(false),
     lineSize(_lineSize),
     hitLatency(_hitLatency),
     missLatency(_missLatency),
 	  numMHSR(_numMHSR),
 	  numMissSrvPorts(_numMissSrvPorts),
-	  missSrvLatency(_missSrvLatency)
+	  missSrvLatency(_missSrvLatency),
+	  numHits(0),
+	  numMisses(0),
+	  pfIssuing(false),
+	  pfIssued(0),
+	  pfRedundant(0),
+	  pfDropped(0),
+	  pfUseful(0),
+	  pfLate(0),
+	  pfUseless(0)
 	  /*------------------------------------------------------------------------*\
 	   | Constructor.  Allocates data structures and initializes D-cache state.
 	   |
@@ -50,6 +62,8 @@ CacheClass::CacheClass(int sets, int assoc, int _lineSize,
 	   |                  cycle (number of ports to the backing store.)
 	   |  missSrvLatency     The number of cycles before a miss service port can be
 	   |                  reused (port pipeline latency).
+	   |  policy         The name of the replacement policy (replacement.h).
+	   |  prefetcher     The name of the prefetcher (prefetch.h).
 	  \*------------------------------------------------------------------------*/
 {
 	int i;
@@ -66,6 +80,7 @@ CacheClass::CacheClass(int sets, int assoc, int _lineSize,
 		mhsr[i].resolved = 0;
 		mhsr[i].busy = false;
 	}
+	mhsrOccupancy = new HistogramClass(numMHSR + 1);
 
 	/* Allocate miss service ports. */
 	missPortAvail = new cycle_t[numMissSrvPorts];
@@ -74,6 +89,8 @@ CacheClass::CacheClass(int sets, int assoc, int _lineSize,
 		missPortAvail[i]=0;
 	}
 
+  prefetcher = PrefetcherClass::Create(_prefetcher, lineSize, PREFETCH_DEGREE);
+
   this->stats = proc->get_stats();
 
   assert(stats);
@@ -114,13 +131,16 @@ CacheClass::~CacheClass()
 {
 	delete [] mhsr;
 	delete [] missPortAvail;
+	delete mhsrOccupancy;
+	delete prefetcher;
 
 }
 
 cycle_t CacheClass::Access(unsigned int Tid /* ER 11/16/02 */,
                              cycle_t curCycle, reg_t addr,
                              bool isStore, bool* isHit,
-                             bool probe, bool commit)
+                             bool probe, bool commit, reg_t pc,
+                             bool isPrefetch)
 /*------------------------------------------------------------------------*\
  | Access the data cache.  Determines how many cycles access will take.
  |
@@ -144,12 +164,15 @@ cycle_t CacheClass::Access(unsigned int Tid /* ER 11/16/02 */,
 	reg_t lineAddr;
 	reg_t oldAddr;
 	CacheLineClass* line;
-	CacheLineClass* newLine;
+	CacheLineClass victim;
+	bool demandHit;
+	bool pfTrigger = false;
 	int busyMHSR;
 	int newMHSR;
 	int newPort;
 	cycle_t portAvail;
 	cycle_t lineInArray;
+	HOST_PROF_SCOPE(HP_CACHE);
 
 //	assert (curCycle >= lastCycle);
 //	lastCycle = curCycle;
@@ -159,13 +182,23 @@ cycle_t CacheClass::Access(unsigned int Tid /* ER 11/16/02 */,
 	assert((Tid < 4) && (lineSize >= 2));
 	lineAddr = ((addr >> lineSize) | (Tid << 30));
 
-	line = array.lookup(lineAddr, NULL, &hit, &oldAddr, false);
+	line = array.lookup(lineAddr, &hit, &oldAddr, false, pc);
 
 	if (probe) {
 		(*isHit) = hit;
 		return(curCycle);
 	}
 
+	if (!isPrefetch) {
+		if (hit)
+			numHits++;
+		else
+			numMisses++;
+	}
+	demandHit = hit;
+	if (!isPrefetch)
+		nextLevelMissed = false;
+
   if(isStore){
     inc_counter_str((identifier+"_store_count").c_str());
   } else {
@@ -216,6 +249,16 @@ cycle_t CacheClass::Access(unsigned int Tid /* ER 11/16/02 */,
         inc_counter_str((identifier+"_read_access_count").c_str());
       }
 		}
+
+		// First demand access to a prefetched line.  The prefetch was
+		//  late if the line is still being loaded.
+		if (line->prefetched && !isPrefetch) {
+			line->prefetched = false;
+			pfUseful++;
+			if (lineInArray > curCycle)
+				pfLate++;
+			pfTrigger = true;
+		}
 	}
   // Line has not been allocated in cache.
 	else {
@@ -239,16 +282,18 @@ cycle_t CacheClass::Access(unsigned int Tid /* ER 11/16/02 */,
 		// Find the miss port to use for handling the miss.
 		newPort = FindNextPort(curCycle, &portAvail);
 
-		// Allocate a new cache line structure.
 		if (commit) {
-			// Allocate a new cache line structure.
-			newLine = new CacheLineClass;
-			assert(newLine);
-			newLine -> mhsr = newMHSR;
-			newLine -> dirty = isStore;
-
-			// Replace the old line in the cache.
-			line = array.lookup(lineAddr, newLine, &hit, &oldAddr, true);
+			// Replace the old line in the cache.  The line's state is
+			// kept in place in the array: save the victim's state
+			// before overwriting it with the new line's.
+			line = array.lookup(lineAddr, &hit, &oldAddr, true, pc);
+			victim = *line;
+			line -> mhsr = newMHSR;
+			line -> dirty = isStore;
+			line -> prefetched = pfIssuing;
+			line = ((oldAddr != (reg_t)INVALID) ? &victim : NULL);
+			if (line && line->prefetched)
+				pfUseless++;
 		}
 
 		// Compute the time to load the new line from the next memory level.
@@ -306,7 +351,9 @@ cycle_t CacheClass::Access(unsigned int Tid /* ER 11/16/02 */,
       // as it's access cycle and returns when the line becomes 
       // available for access.
       // This is always a read from the next level as this is a WBWA cache model. 
-  		lineInArray = nextLevel->Access(Tid,lineInArray,addr,false,&hit);
+  		lineInArray = nextLevel->Access(Tid,lineInArray,addr,false,&hit,false,true,pc,isPrefetch);
+		if (!isPrefetch)
+			nextLevelMissed = !hit;
       // Cannot miss in MHSR in the next level if the next level has
       // as many or more MHSRs as this level. A miss in this level can
       // be a hit or a miss in the next level. There can be numMHSR outstanding 
@@ -315,18 +362,19 @@ cycle_t CacheClass::Access(unsigned int Tid /* ER 11/16/02 */,
       assert(lineInArray > curCycle);
     }
 
-		// Free old cache line, allocate miss port and MHSR.
+		// Allocate MHSR.
 		// NOTE: Slight simulation approximation error here.
 		//       MHSR is being allocated this cycle, but in reality, can not
 		//       be allocated until hitLat cycles later, when miss is
 		//       known.
-		if (commit && line) {
-			delete line;
-		}
 		mhsr[newMHSR].resolved = lineInArray;
 		mhsr[newMHSR].busy = true;
 		mhsr[newMHSR].lineAddress = lineAddr;
     inc_counter_str((identifier+"_write_access_count").c_str());
+		if (pfIssuing)
+			pfIssued++;
+		else if (!isPrefetch && commit)
+			demandMissLatency.Increment(lineInArray + hitLatency - curCycle);
 	}
 
 	if (isHit!=NULL) {
@@ -335,9 +383,84 @@ cycle_t CacheClass::Access(unsigned int Tid /* ER 11/16/02 */,
 
   //LOG(proc->lsu_log,proc->cycle,uint64_t(0),uint64_t(0),"Executed %s which %s resolve cycle %" PRIcycle "",isStore?"store":"load",isHit?"hit":"miss",(lineInArray+hitLatency));
 
+	// Train the prefetcher on demand loads (and fills from the level
+	//  above), and issue its prefetches.
+	if (prefetcher && !isPrefetch && !isStore && commit) {
+		reg_t pfAddr[PREFETCH_MAX_DEGREE];
+		unsigned int n = prefetcher->Train(pc, addr, (!demandHit || pfTrigger), pfAddr);
+		for (unsigned int i = 0; i < n; i++)
+			Prefetch(Tid, curCycle, pfAddr[i], pc);
+	}
+
 	return(lineInArray + hitLatency);
 }
 
+void CacheClass::Prefetch(unsigned int Tid, cycle_t curCycle, reg_t addr, reg_t pc)
+{
+	bool hit;
+
+	// A prefetch of a line that is present or being loaded is dropped, as
+	//  is one that would take the last half of the MHSRs, which are kept
+	//  for demand misses.
+	Access(Tid, curCycle, addr, false, &hit, true, true, pc);
+	if (hit) {
+		pfRedundant++;
+		return;
+	}
+	if (!PrefetchMHSRAvailable(curCycle)) {
+		pfDropped++;
+		return;
+	}
+
+	pfIssuing = true;
+	Access(Tid, curCycle, addr, false, NULL, false, true, pc, true);
+	pfIssuing = false;
+}
+
+void CacheClass::Warm(unsigned int Tid, reg_t addr, bool isStore, reg_t pc)
+/*------------------------------------------------------------------------*\
+ | Functional warming.  Probe-and-install without timing.
+ |
+ |  addr              The address of the word being accessed.
+ |  isStore           Indicates whether the access is a store (true) or
+ |                     load (false).
+\*------------------------------------------------------------------------*/
+{
+	bool hit;
+	reg_t lineAddr;
+	reg_t oldAddr;
+	CacheLineClass* line;
+	bool victimDirty;
+
+	assert((Tid < 4) && (lineSize >= 2));
+	lineAddr = ((addr >> lineSize) | (Tid << 30));
+
+	// A hit only updates replacement state (done by the lookup) and the dirty bit.
+	line = array.lookup(lineAddr, &hit, &oldAddr, false, pc);
+	if (hit) {
+		if (isStore) {
+			line->dirty = true;
+		}
+		return;
+	}
+
+	// Install the line.  No MHSR is loading it.
+	line = array.lookup(lineAddr, &hit, &oldAddr, true, pc);
+	victimDirty = ((oldAddr != (reg_t)INVALID) && line->dirty);
+	line -> mhsr = -1;
+	line -> dirty = isStore;
+	line -> prefetched = false;
+
+	if (nextLevel != NULL) {
+		// Write back the victim, if dirty.
+		if (victimDirty) {
+			nextLevel->Warm(Tid, ((oldAddr & ~((reg_t)3 << 30)) << lineSize), true);
+		}
+		// Fill from the next level (always a read in a WBWA cache).
+		nextLevel->Warm(Tid, addr, false, pc);
+	}
+}
+
 void CacheClass::set_nextLevel(CacheClass* nLevel){
 	nextLevel = nLevel;
 }
@@ -356,7 +479,7 @@ int CacheClass::FindFreeMHSR(cycle_t curCycle)
 		}
 		if (mhsr[i].resolved < curCycle) {
 			// MHSR is finished.  Free it.
-			line = array.lookup(mhsr[i].lineAddress, NULL, &hit, &oldAddr, false);
+			line = array.lookup(mhsr[i].lineAddress, &hit, &oldAddr, false);
 			if (hit) {
 				if (line->mhsr == i) {
 					line->mhsr = -1;
@@ -372,6 +495,18 @@ int CacheClass::FindFreeMHSR(cycle_t curCycle)
 	return(-1);
 }
 
+bool CacheClass::PrefetchMHSRAvailable(cycle_t curCycle)
+{
+	int i;
+	int numFree = 0;
+
+	for (i=0; i<numMHSR; i++) {
+		if (!mhsr[i].busy || (mhsr[i].resolved < (int64_t)curCycle))
+			numFree++;
+	}
+	return(numFree > (numMHSR / 2));
+}
+
 int CacheClass::FindNextPort(cycle_t curCycle, cycle_t* portAvail)
 {
 	int i;
@@ -419,6 +554,54 @@ bool CacheClass::Probe(unsigned int Tid, //RBRC
 }
 
 
+int CacheClass::BusyMHSRs(cycle_t curCycle)
+{
+	int i, busy = 0;
+
+	for (i=0; i<numMHSR; i++) {
+		if (mhsr[i].busy && (mhsr[i].resolved > (int64_t)curCycle))
+			busy++;
+	}
+	return(busy);
+}
+
+void CacheClass::dump_stats(FILE* fp)
+{
+	uint64_t accesses = (numHits + numMisses);
+
+	fprintf(fp, "%s (%s replacement)\n", identifier.c_str(), array.policy()->Name());
+	fprintf(fp, "   accesses:   %lu\n", accesses);
+	fprintf(fp, "   hits:       %lu\n", numHits);
+	fprintf(fp, "   misses:     %lu\n", numMisses);
+	fprintf(fp, "   miss ratio: %f\n", (accesses ? ((double)numMisses / (double)accesses) : 0.0));
+	array.policy()->Print(fp);
+	if (mhsrOccupancy->Samples())
+		fprintf(fp, "   busy MHSRs: avg %.2f, p50 %d, p90 %d, p99 %d, all %d busy %.2f%% of cycles\n",
+		        mhsrOccupancy->Average(), mhsrOccupancy->Percentile(0.5), mhsrOccupancy->Percentile(0.9),
+		        mhsrOccupancy->Percentile(0.99), numMHSR,
+		        (100.0 * (double)mhsrOccupancy->Bin(numMHSR) / (double)mhsrOccupancy->Samples()));
+	demandMissLatency.Print(fp, "   miss latency");
+
+	if (prefetcher || pfIssued || pfRedundant || pfDropped) {
+		if (prefetcher)
+			fprintf(fp, "   %s prefetcher (degree %u)\n", prefetcher->Name(), PREFETCH_DEGREE);
+		else
+			fprintf(fp, "   fetch-directed prefetches\n");
+		fprintf(fp, "      issued:             %lu\n", pfIssued);
+		fprintf(fp, "      redundant:          %lu (line present or being loaded)\n", pfRedundant);
+		fprintf(fp, "      dropped:            %lu (no MHSR)\n", pfDropped);
+		fprintf(fp, "      useful:             %lu\n", pfUseful);
+		fprintf(fp, "      late:               %lu\n", pfLate);
+		fprintf(fp, "      evicted unused:     %lu\n", pfUseless);
+		fprintf(fp, "      coverage:           %f (useful / (useful + misses))\n",
+		        ((pfUseful + numMisses) ? ((double)pfUseful / (double)(pfUseful + numMisses)) : 0.0));
+		fprintf(fp, "      accuracy:           %f (useful / issued)\n",
+		        (pfIssued ? ((double)pfUseful / (double)pfIssued) : 0.0));
+		fprintf(fp, "      lateness:           %f (late / useful)\n",
+		        (pfUseful ? ((double)pfLate / (double)pfUseful) : 0.0));
+	}
+}
+
 // ER 06/19/01
 void CacheClass::set_lat(unsigned int hit_lat, unsigned int miss_lat) {
 	hitLatency = hit_lat;
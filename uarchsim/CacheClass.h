@@ -20,13 +20,14 @@
  |  Backing store port reuse latency
  |
  | Fixed cache parameters:
- |  Replacement policy (LRU)
+ |  Replacement policy (LRU, PLRU, SRRIP, BRRIP, DRRIP or SHiP)
  |  Write policy (Write Back)
  |  Number of cache ports (unlimited)
 \*--------------------------------------------------------------------------*/
 #include "decode.h"
 #include "cache.h"
 #include "histogram.h"
+#include "prefetch.h"
 #include <string.h>
 
 /*--------------------------------------------------------------------------*\
@@ -41,13 +42,15 @@ public:
 };
 
 /*--------------------------------------------------------------------------*\
- | State maintained by a D-Cache line.
+ | State maintained by a D-Cache line.  Stored in place in the cache array;
+ |  a line is valid if its tag is.
 \*--------------------------------------------------------------------------*/
 class CacheLineClass {
 public:
 	int mhsr;   /* Index of MHSR that is loading this line.        */
 	bool mhsrValid; /* -1 indicates that the line is not being loaded. */
 	bool dirty; /* Indicates the line is dirty.                    */
+	bool prefetched; /* Brought in by a prefetch, and not yet accessed. */
 };
 
 typedef cache<CacheLineClass> CacheArray;
@@ -62,7 +65,8 @@ public:
 	           int _hitLatency, int _missLatency,
 	           int _numMHSR, int _numMissSrvPorts, int _missSrvLatency,
 	           pipeline_t* _proc, const char* _identifier,
-             CacheClass* _nextLevel=NULL, int histLen = 50);
+             CacheClass* _nextLevel=NULL, const char* _policy = "lru",
+	           const char* _prefetcher = "none", int histLen = 50);
 	/*------------------------------------------------------------------------*\
 	 | Constructor.  Allocates data structures and initializes D-cache state.
 	 |
@@ -81,6 +85,8 @@ public:
 	 |                  cycle (number of ports to the backing store.)
 	 |  missSrvLat     The number of cycles before a miss service port can be
 	 |                  reused (port pipeline latency).
+	 |  policy         The name of the replacement policy (replacement.h).
+	 |  prefetcher     The name of the prefetcher (prefetch.h).
 	\*------------------------------------------------------------------------*/
 
 	~CacheClass();
@@ -94,7 +100,8 @@ public:
 
 	cycle_t Access(unsigned int Tid /* ER 11/16/02 */,
 	               cycle_t curCycle, reg_t addr, bool isStore,
-	               bool* hit=NULL, bool probe=false, bool commit=true);
+	               bool* hit=NULL, bool probe=false, bool commit=true,
+	               reg_t pc=0, bool isPrefetch=false);
 	/*------------------------------------------------------------------------*\
 	 | Access the data cache.  Determines how many cycles access will take.
 	 |
@@ -103,23 +110,81 @@ public:
 	 |  addr              The address of the word being accessed.
 	 |  isStore           Indicates whether the access is a store (true) or
 	 |                     load (false).
+	 |  pc                The instruction making the access, if known, for
+	 |                     the replacement policy and prefetcher (and the
+	 |                     next level's).
+	 |  isPrefetch        The access is a prefetch, not a demand access:
+	 |                     it is not counted as a hit or miss and does not
+	 |                     train the prefetcher.  A miss allocates an MHSR
+	 |                     and a miss port like a load miss, and fetches
+	 |                     the line from the next level as a prefetch too.
+	 |                     Prefetches of this cache's own are issued with
+	 |                     Prefetch().
 	 |
 	 | Returns the cycle when the access will complete.  Returns -1 if the
 	 |  access can not be handled, due to limited miss handleing status
 	 |  registers.
 	\*------------------------------------------------------------------------*/
 
+	void Prefetch(unsigned int Tid, cycle_t curCycle, reg_t addr, reg_t pc=0);
+	/*------------------------------------------------------------------------*\
+	 | Prefetches the line of addr, for this cache's prefetcher (or, for the
+	 |  I$, the fetch unit).  The prefetch is dropped if the line is present
+	 |  or being loaded, or too few MHSRs are free.
+	\*------------------------------------------------------------------------*/
+
+	void Warm(unsigned int Tid, reg_t addr, bool isStore, reg_t pc=0);
+	/*------------------------------------------------------------------------*\
+	 | Functional warming.  Updates the tag array as if the access had been
+	 |  made, without modeling time: no MHSRs or miss ports are allocated
+	 |  and no counters are updated.  Misses fill from, and dirty victims
+	 |  are written back to, the next level in the same way.
+	\*------------------------------------------------------------------------*/
+
 	bool Probe(unsigned int Tid,cycle_t curCycle, reg_t addr1, unsigned int length);
+
+	bool NextLevelMissed() { return(nextLevelMissed); }
+	/*------------------------------------------------------------------------*\
+	 | Returns whether the last demand access missed in the next level too.
+	\*------------------------------------------------------------------------*/
+
+	int BusyMHSRs(cycle_t curCycle);
+	/*------------------------------------------------------------------------*\
+	 | Returns the number of MHSRs still loading a line.
+	\*------------------------------------------------------------------------*/
+
+	void SampleMHSRs(cycle_t curCycle) { mhsrOccupancy->Increment(BusyMHSRs(curCycle)); }
+	/*------------------------------------------------------------------------*\
+	 | Called once per cycle: adds BusyMHSRs() to mhsrOccupancy.
+	\*------------------------------------------------------------------------*/
+
+	uint64_t Hits() { return(numHits); }
+	uint64_t Misses() { return(numMisses); }
+	/*------------------------------------------------------------------------*\
+	 | Hits and misses of timed demand accesses, as in dump_stats().
+	\*------------------------------------------------------------------------*/
+
+	void dump_stats(FILE* fp);
+	/*------------------------------------------------------------------------*\
+	 | Prints the replacement policy and the hits and misses of timed
+	 |  (non-probe) demand accesses, the MHSR occupancy and miss latency
+	 |  distributions, and the prefetcher's coverage, accuracy and lateness.
+	\*------------------------------------------------------------------------*/
+
 	HistogramClass* accessLatency;
+	HistogramClass* mhsrOccupancy;		// Busy MHSRs per cycle (SampleMHSRs).
+	LogHistogramClass demandMissLatency;	// Cycles to complete demand misses that allocated an MHSR.
 	void set_nextLevel(CacheClass* nLevel);
 private:
 
   pipeline_t* proc;
 	int FindFreeMHSR(cycle_t curCycle);
 	int FindNextPort(cycle_t curCycle, cycle_t* portAvail);
+	bool PrefetchMHSRAvailable(cycle_t curCycle);
 
 	CacheArray  array;          /* The D-Cache array.                           */
   CacheClass* nextLevel; 
+	bool        nextLevelMissed;   /* Last demand access missed in nextLevel.   */
   std::string identifier;
 	int         lineSize;        /* D-Cache line size.  Must be a power of 2.    */
 //	cycle_t     lastCycle;         /* curCycle of last access.                     */
@@ -132,6 +197,17 @@ private:
 	MHSRClass*  mhsr;           /* The miss handling status registers.          */
 	int         numMissSrvPorts;       /* Number of miss ports available.              */
 	cycle_t     missSrvLatency;    /* Pipeline reuse latency for miss ports.       */
+	uint64_t    numHits;           /* Timed accesses that hit.                     */
+	uint64_t    numMisses;         /* Timed accesses that missed.                  */
+
+	PrefetcherClass* prefetcher;   /* NULL if none.                                */
+	bool        pfIssuing;         /* Access() is issuing one of our prefetches.   */
+	uint64_t    pfIssued;          /* Prefetches that allocated an MHSR.           */
+	uint64_t    pfRedundant;       /* Prefetches of lines already present.         */
+	uint64_t    pfDropped;         /* Prefetches dropped for lack of MHSRs.        */
+	uint64_t    pfUseful;          /* Prefetched lines later accessed.             */
+	uint64_t    pfLate;            /* ... while still being loaded.                */
+	uint64_t    pfUseless;         /* Prefetched lines evicted before any access.  */
 
   stats_t* stats;
 
@@ -1,10 +1,15 @@
 #include <cstdio>
 #include <cassert>
 #include <cinttypes>
+#include <cstring>
 #include "parameters.h"
 #include "bpred_interface.h"
 #include "stats.h"
 
+// Shadow predictors have no stats module, and do not count accesses.
+#undef inc_counter
+#define inc_counter(x)	do { if (stats) stats->update_counter(#x,1); } while (0)
+
 //unsigned int HIST_MASK = 0xfffc;
 //unsigned int HIST_BIT  = 0x8000;
 //unsigned int PC_MASK   = 0x3fff;
@@ -12,44 +17,101 @@
 //
 // Constructor
 //
-// Initialize control flow prediction stuff.
+// Initialize control flow prediction stuff, configured by the global
+// parameters or by the given configuration.
 //
 bpred_interface::bpred_interface()
+{
+	bpred_config_t config;
+
+	config.btb_size = BTB_SIZE;
+	config.bp_table_size = BP_TABLE_SIZE;
+	config.ctiq_size = CTIQ_SIZE;
+	config.ras_size = RAS_SIZE;
+	config.cond = BP_COND;
+	config.indirect = BP_INDIRECT;
+	init(config);
+}
+
+bpred_interface::bpred_interface(const bpred_config_t& config)
+{
+	init(config);
+}
+
+void bpred_interface::init(const bpred_config_t& config)
 {
 	unsigned int i;
 
-	BTB = new BpredPredictAutomaton[BTB_SIZE];
-	pred_table = new BpredPredictAutomaton[BP_TABLE_SIZE];
-	conf_table = new BpredPredictAutomaton[BP_TABLE_SIZE];
-	fm_table = new BpredPredictAutomaton[BP_TABLE_SIZE];		// "FM"
-  cti_Q = new CTI_entry_b[CTIQ_SIZE];
+	assert (IsPow2(config.btb_size) && IsPow2(config.bp_table_size) && IsPow2(config.ctiq_size));
+	btb_size = config.btb_size;
+	btb_mask = btb_size - 1;
+	bp_table_size = config.bp_table_size;
+	bp_index_mask = bp_table_size - 1;
+	ctiq_size = config.ctiq_size;
+	ctiq_mask = ctiq_size - 1;
+	ras_size = config.ras_size;
+	bp_cond = config.cond;
+	bp_indirect = config.indirect;
+	stats = NULL;
+
+	BTB = new uint32_t[btb_size];
+	BTB_hyst = new uint8_t[btb_size];
+	pred_table = new uint8_t[bp_table_size];
+	conf_table = new uint8_t[bp_table_size];
+	fm_table = new uint8_t[bp_table_size];		// "FM"
+  cti_Q = new CTI_entry_b[ctiq_size];
 
 	cti_head = 0;
 	cti_tail = 0;
-	for (i = 0; i < CTIQ_SIZE; i++)
+	for (i = 0; i < ctiq_size; i++)
 	{
 		cti_Q[i].RAS_action = 0;
 		cti_Q[i].history = 0;
 		cti_Q[i].state = 0;
 	}
 
-	for (i = 0; i < BTB_SIZE; i++)
+	for (i = 0; i < btb_size; i++)
 	{
-		BTB[i].tag = 0;
-		BTB[i].pred = 0;
-		BTB[i].hyst = 0;
+		BTB[i] = 0;
+		BTB_hyst[i] = 0;
 	}
 
-	for (i = 0; i < BP_TABLE_SIZE; i++)
+	assert (CONF_MAX <= 0xff && FM_MAX <= 0xff);
+	for (i = 0; i < bp_table_size; i++)
 	{
-		pred_table[i].tag = 0;
-		pred_table[i].pred = 1;
-		pred_table[i].hyst = 0;
-		conf_table[i].pred = CONF_MAX;
-		fm_table[i].pred = FM_MAX;				// "FM"
+		pred_table[i] = 1;					// predict taken, no hysteresis
+		conf_table[i] = CONF_MAX;
+		fm_table[i] = FM_MAX;					// "FM"
 	}
 
-	RAS = NULL;
+	assert (ras_size > 0);
+	RAS = new uint32_t[ras_size];
+	RAS_commit = new uint32_t[ras_size];
+	for (i = 0; i < ras_size; i++)
+	{
+		RAS[i] = 0;
+		RAS_commit[i] = 0;
+	}
+	RAS_tos = 0;
+	RAS_depth = 0;
+	RAS_commit_tos = 0;
+	RAS_commit_depth = 0;
+
+	// TAGE-SC-L / ITTAGE.
+	bhist = NULL;
+	tage = NULL;
+	ittage = NULL;
+	if (strcmp(bp_cond, "gshare") || strcmp(bp_indirect, "btb")) {
+		// The history buffer must hold the longest history beyond all in-flight CTIs.
+		assert((ctiq_size + TAGE_MAX_HIST) < GHIST_BUFFER_SIZE);
+		bhist = new BranchHistoryClass();
+		for (i = 0; i < ctiq_size; i++)
+			bhist->Init(&cti_Q[i].bh);
+		if (!strcmp(bp_cond, "tage-sc-l"))
+			tage = new TageClass(bhist);
+		if (!strcmp(bp_indirect, "ittage"))
+			ittage = new ITTageClass(bhist);
+	}
 
 	stat_num_pred = 0;
 	stat_num_miss = 0;
@@ -69,10 +131,21 @@ bpred_interface::bpred_interface()
 //
 bpred_interface::~bpred_interface()
 {
-	if (RAS) {
-		delete RAS;
-	}
-	RAS = NULL;
+	delete [] RAS;
+	delete [] RAS_commit;
+	delete [] BTB;
+	delete [] BTB_hyst;
+	delete [] pred_table;
+	delete [] conf_table;
+	delete [] fm_table;
+	delete [] cti_Q;
+
+	if (tage)
+		delete tage;
+	if (ittage)
+		delete ittage;
+	if (bhist)
+		delete bhist;
 }
 
 
@@ -91,7 +164,7 @@ void bpred_interface::update()
 	// Update pointers
 	//
 	current = cti_tail;
-	new_tail = (current + 1) & (CTIQ_MASK);
+	new_tail = (current + 1) & (ctiq_mask);
 	cti_tail = new_tail;
 
 	//
@@ -111,85 +184,98 @@ void bpred_interface::update()
 		cti_Q[new_tail].history = cti_Q[current].history;
 	}
 
+	//
+	// Update the speculative RAS.
+	//
+	RAS_apply(RAS, &RAS_tos, &RAS_depth, current);
+
+	//
+	// Update TAGE-SC-L / ITTAGE history: the outcome of a conditional
+	// branch, or a target bit of a jump.  Then advance the loop
+	// predictor.
+	//
+	if (bhist)
+	{
+		bhist->Push(&cti_Q[current].bh, &cti_Q[new_tail].bh,
+		            (cti_Q[current].is_cond ? cti_Q[current].taken : ((cti_Q[current].target >> 2) & 1)),
+		            cti_Q[current].pc);
+	}
+	if (tage && cti_Q[current].is_cond)
+	{
+		tage->SpecUpdate(cti_Q[current].pc, cti_Q[current].taken, &cti_Q[current].tage);
+	}
 }
 
-void bpred_interface::RAS_update()
+//
+// Undo the speculative loop predictor updates of the CTIs from the tail
+// back to (and including) oldest, youngest first.
+//
+void bpred_interface::spec_undo(unsigned int oldest)
 {
-	RAS_node_b* ptr;
+	unsigned int index;
 
-	if (cti_Q[cti_head].flush_RAS)
+	if (!tage)
+		return;
+
+	index = cti_tail;
+	while (index != oldest)
 	{
-		if (RAS) {
-			delete (RAS);
-		}
-		RAS = NULL;
+		index = (index - 1) & ctiq_mask;
+		if (cti_Q[index].is_cond)
+			tage->SpecUndo(&cti_Q[index].tage);
+	}
+}
+
+//
+// Apply the RAS action of the CTI at index to a RAS.
+//
+void bpred_interface::RAS_apply(uint32_t* stack, unsigned int* tos, unsigned int* depth, unsigned int index)
+{
+	if (cti_Q[index].flush_RAS)
+	{
+		*depth = 0;
 		return;
 	}
 
-	if (cti_Q[cti_head].RAS_action == -1)
+	if (cti_Q[index].RAS_action == -1)
 	{
 		//
 		// POP
 		//
-		assert (RAS);
-		ptr = RAS;
-		RAS = RAS->next;
-
-		assert (ptr->addr == cti_Q[cti_head].RAS_address);
-
-		ptr->next = NULL;
-		delete ptr;
+		if (*depth)
+		{
+			*tos = (*tos + ras_size - 1) % ras_size;
+			(*depth)--;
+		}
 	}
-	else if (cti_Q[cti_head].RAS_action == 1)
+	else if (cti_Q[index].RAS_action == 1)
 	{
 		//
-		// PUSH
+		// PUSH: overwrites the oldest entry if full.
 		//
-		ptr = new RAS_node_b();
-		ptr->addr = cti_Q[cti_head].RAS_address;
-		ptr->next = RAS;
-		RAS = ptr;
-    inc_counter(ras_write_count);
+		*tos = (*tos + 1) % ras_size;
+		stack[*tos] = cti_Q[index].RAS_address;
+		if (*depth < ras_size)
+			(*depth)++;
 	}
 }
 
-bool bpred_interface::RAS_lookup(uint32_t* target)
+void bpred_interface::RAS_update()
 {
-	int count = 0;
-	uint32_t index;
-	uint32_t exit = (cti_head - 1) & CTIQ_MASK;
-
-  inc_counter(ras_read_count);
-
-	for (index = (cti_tail - 1) & CTIQ_MASK;
-	        index != exit;
-	        index = (index - 1) & CTIQ_MASK)
+	RAS_apply(RAS_commit, &RAS_commit_tos, &RAS_commit_depth, cti_head);
+	if (!cti_Q[cti_head].flush_RAS && (cti_Q[cti_head].RAS_action == 1))
 	{
-		count += cti_Q[index].RAS_action;
-		if (cti_Q[index].flush_RAS)
-		{
-			*target = 0;
-			return (false);
-		}
-		if (count == 1)
-		{
-			*target = (cti_Q[index].RAS_address);
-			return (true);
-		}
+		inc_counter(ras_write_count);
 	}
+}
 
-	RAS_node_b* ptr = RAS;
-	for ( ; count < 0; count++)
-	{
-		if (ptr == NULL) {
-			break;
-		}
-		ptr = ptr->next;
-	}
+bool bpred_interface::RAS_lookup(uint32_t* target)
+{
+	inc_counter(ras_read_count);
 
-	if (ptr)
+	if (RAS_depth)
 	{
-		*target = ptr->addr;
+		*target = RAS[RAS_tos];
 		return (true);
 	}
 	else
@@ -197,7 +283,6 @@ bool bpred_interface::RAS_lookup(uint32_t* target)
 		*target = 0;
 		return (false);
 	}
-
 }
 
 void bpred_interface::update_predictions(bool fm)		// "FM"
@@ -213,8 +298,11 @@ void bpred_interface::update_predictions(bool fm)		// "FM"
 	if (cti_Q[cti_head].is_cond)
 	{
 		pred_index = ((cti_Q[cti_head].history & HIST_MASK) ^
-		              ((cti_Q[cti_head].pc / insn_size) & PC_MASK)) & BP_INDEX_MASK;
-		pred_table[pred_index].update((uint32_t)cti_Q[cti_head].taken);
+		              ((cti_Q[cti_head].pc / insn_size) & PC_MASK)) & bp_index_mask;
+		if (tage)
+			tage->Update(cti_Q[cti_head].pc, &cti_Q[cti_head].bh, &cti_Q[cti_head].tage, cti_Q[cti_head].taken);
+		else
+			bp_dir_update(&pred_table[pred_index], (uint32_t)cti_Q[cti_head].taken);
 
 		//
 		// update conf
@@ -228,15 +316,15 @@ void bpred_interface::update_predictions(bool fm)		// "FM"
 		}
 
 		conf_index = ((history & HIST_MASK) ^
-		              ((cti_Q[cti_head].pc / insn_size) & PC_MASK)) & BP_INDEX_MASK;
+		              ((cti_Q[cti_head].pc / insn_size) & PC_MASK)) & bp_index_mask;
 		bool corr = (cti_Q[cti_head].target == cti_Q[cti_head].original_pred);
 
-		conf_table[conf_index].conf_update((uint32_t)corr, CONF_RESET, CONF_MAX);
+		bp_conf_update(&conf_table[conf_index], (uint32_t)corr, CONF_RESET, CONF_MAX);
 
 		//
 		// "FM": update conf
 		//
-		fm_table[pred_index].conf_update((uint32_t)!fm, FM_RESET, FM_MAX);
+		bp_conf_update(&fm_table[pred_index], (uint32_t)!fm, FM_RESET, FM_MAX);
 
     inc_counter(bp_write_count);
 
@@ -249,8 +337,11 @@ void bpred_interface::update_predictions(bool fm)		// "FM"
 	//
 	if (cti_Q[cti_head].use_BTB)
 	{
-		btb_index = (cti_Q[cti_head].pc / insn_size) & BTB_MASK;
-		BTB[btb_index].update(cti_Q[cti_head].target);
+		btb_index = (cti_Q[cti_head].pc / insn_size) & btb_mask;
+		bp_btb_update(&BTB[btb_index], &BTB_hyst[btb_index], cti_Q[cti_head].target);
+		if (ittage)
+			ittage->Update(cti_Q[cti_head].pc, &cti_Q[cti_head].bh, &cti_Q[cti_head].ittage,
+			               cti_Q[cti_head].original_pred, cti_Q[cti_head].target);
 
     inc_counter(btb_write_count);
 	}
@@ -259,6 +350,21 @@ void bpred_interface::update_predictions(bool fm)		// "FM"
 
 
 
+//
+// Clear state of the CTI at the head and advance the head.
+//
+void bpred_interface::retire_head()
+{
+	cti_Q[cti_head].RAS_action = 0;
+	cti_Q[cti_head].RAS_address = 0;
+	cti_Q[cti_head].flush_RAS = false;
+	cti_Q[cti_head].pc = 0;
+	cti_Q[cti_head].comp_target = 0;
+	cti_Q[cti_head].state = 0;
+
+	cti_head = (cti_head + 1) & ctiq_mask;
+}
+
 void bpred_interface::make_predictions(unsigned int branch_history)
 {
 	uint32_t	conf_index;
@@ -267,6 +373,13 @@ void bpred_interface::make_predictions(unsigned int branch_history)
 	uint32_t	temp_target;
 	uint32_t	history;
 
+	//
+	// Checkpoint the speculative RAS, for repair by fix_pred().
+	//
+	cti_Q[cti_tail].ras_tos = RAS_tos;
+	cti_Q[cti_tail].ras_depth = RAS_depth;
+	cti_Q[cti_tail].ras_top = RAS[RAS_tos];
+
 	//
 	// Predict if cti is "taken"
 	//
@@ -276,18 +389,21 @@ void bpred_interface::make_predictions(unsigned int branch_history)
 		{
 			history = cti_Q[cti_tail].history;
 			pred_index = ((cti_Q[cti_tail].history & HIST_MASK) ^
-			              ((cti_Q[cti_tail].pc / insn_size) & PC_MASK)) & BP_INDEX_MASK;
+			              ((cti_Q[cti_tail].pc / insn_size) & PC_MASK)) & bp_index_mask;
 		}
 		else
 		{
 			history = branch_history;
 			pred_index = ((branch_history & HIST_MASK) ^
-			              ((cti_Q[cti_tail].pc / insn_size) & PC_MASK)) & BP_INDEX_MASK;
+			              ((cti_Q[cti_tail].pc / insn_size) & PC_MASK)) & bp_index_mask;
 			cti_Q[cti_tail].use_global_history = true;
 			cti_Q[cti_tail].global_history = branch_history;
 		}
 
-		cti_Q[cti_tail].taken = pred_table[pred_index].pred;
+		if (tage)
+			cti_Q[cti_tail].taken = tage->Predict(cti_Q[cti_tail].pc, &cti_Q[cti_tail].bh, &cti_Q[cti_tail].tage);
+		else
+			cti_Q[cti_tail].taken = BP_DIR_PRED(pred_table[pred_index]);
 
 		if (cti_Q[cti_tail].taken) {
 			history = (history >> 1) | HIST_BIT;
@@ -297,10 +413,10 @@ void bpred_interface::make_predictions(unsigned int branch_history)
 		}
 
 		conf_index = ((history & HIST_MASK) ^
-		              ((cti_Q[cti_tail].pc / insn_size) & PC_MASK)) & BP_INDEX_MASK;
-		cti_Q[cti_tail].conf = conf_table[conf_index].pred;
+		              ((cti_Q[cti_tail].pc / insn_size) & PC_MASK)) & bp_index_mask;
+		cti_Q[cti_tail].conf = conf_table[conf_index];
 
-		cti_Q[cti_tail].fm = fm_table[pred_index].pred;		// "FM"
+		cti_Q[cti_tail].fm = fm_table[pred_index];		// "FM"
     inc_counter(ctiq_write_count);
 	}
 	else
@@ -339,8 +455,11 @@ void bpred_interface::make_predictions(unsigned int branch_history)
 			//
 			if (cti_Q[cti_tail].use_BTB)
 			{
-				btb_index = (cti_Q[cti_tail].pc / insn_size) & BTB_MASK;
-				cti_Q[cti_tail].target = BTB[btb_index].pred;
+				btb_index = (cti_Q[cti_tail].pc / insn_size) & btb_mask;
+				cti_Q[cti_tail].target = BTB[btb_index];
+				if (ittage)
+					cti_Q[cti_tail].target = ittage->Predict(cti_Q[cti_tail].pc, &cti_Q[cti_tail].bh,
+					                                         BTB[btb_index], &cti_Q[cti_tail].ittage);
 			}
 			else
 			{
@@ -515,8 +634,14 @@ void bpred_interface::fix_pred(unsigned int pred_tag, unsigned int next_pc)
 {
 	uint32_t temp_target;
 
+	spec_undo(pred_tag);
 	cti_tail = pred_tag;
 
+	// Restore the speculative RAS to its state before the CTI.
+	RAS_tos = cti_Q[cti_tail].ras_tos;
+	RAS_depth = cti_Q[cti_tail].ras_depth;
+	RAS[RAS_tos] = cti_Q[cti_tail].ras_top;
+
 	if (cti_Q[cti_tail].is_cond)
 	{
 		bool taken;
@@ -580,7 +705,7 @@ void bpred_interface::verify_pred(unsigned int pred_tag, unsigned int next_pc,
 		if (conf)
 		{
 			//printf("%08x (%08x) pred:%08x act:%08x\n", cti_Q[cti_head].pc,
-			//    cti_Q[(cti_head - 1) & CTIQ_MASK].target,
+			//    cti_Q[(cti_head - 1) & ctiq_mask].target,
 			//	cti_Q[cti_head].original_pred,
 			//	cti_Q[cti_head].target);
 			stat_num_conf_ncorr++;
@@ -612,14 +737,60 @@ void bpred_interface::verify_pred(unsigned int pred_tag, unsigned int next_pc,
 	//
 	// Clear state
 	//
-	cti_Q[cti_head].RAS_action = 0;
-	cti_Q[cti_head].RAS_address = 0;
-	cti_Q[cti_head].flush_RAS = false;
-	cti_Q[cti_head].pc = 0;
-	cti_Q[cti_head].comp_target = 0;
-	cti_Q[cti_head].state = 0;
+	retire_head();
+}
+
+//
+//      warm()
+//
+// Functional warming: predict, repair and verify a committed CTI in one step.
+//
+bool bpred_interface::warm(unsigned int PC, insn_t inst,
+                           unsigned int comp_target, unsigned int next_pc)
+{
+	unsigned int tag;
+	bool miss;
+	stats_t* counting = stats;
+
+	assert (cti_head == cti_tail);
+
+	// Warming accesses are not counted: inc_counter() skips a NULL stats.
+	stats = NULL;
+
+	miss = (get_pred(0xFFFFFFFF, PC, inst, comp_target, &tag) != next_pc);
+	if (miss) {
+		fix_pred(tag, next_pc);
+	}
 
-	cti_head = (cti_head + 1) & CTIQ_MASK;
+	update_predictions(false);
+	RAS_update();
+	retire_head();
+
+	stats = counting;
+	return (miss);
+}
+
+//
+// Parse a predictor configuration: <bp>,<btb>,<ras>[,<cond>[,<indirect>]].
+//
+bool bpred_interface::parse_config(const char* spec, bpred_config_t* config)
+{
+	char cond[16], indirect[16];
+	int n;
+
+	strcpy(cond, "gshare");
+	strcpy(indirect, "btb");
+	n = sscanf(spec, "%u,%u,%u,%15[^,],%15s", &config->bp_table_size, &config->btb_size,
+	           &config->ras_size, cond, indirect);
+	if ((n < 3) || !IsPow2(config->bp_table_size) || !IsPow2(config->btb_size) || (config->ras_size == 0) ||
+	    (strcmp(cond, "gshare") && strcmp(cond, "tage-sc-l")) ||
+	    (strcmp(indirect, "btb") && strcmp(indirect, "ittage")))
+		return (false);
+
+	config->ctiq_size = 16;		// warm() has one CTI in flight.
+	config->cond = (strcmp(cond, "gshare") ? "tage-sc-l" : "gshare");
+	config->indirect = (strcmp(indirect, "btb") ? "ittage" : "btb");
+	return (true);
 }
 
 //
@@ -627,7 +798,16 @@ void bpred_interface::verify_pred(unsigned int pred_tag, unsigned int next_pc,
 //
 void bpred_interface::flush()
 {
+	unsigned int i;
+
+	spec_undo(cti_head);
 	cti_tail = cti_head;
+
+	// Restore the speculative RAS from the committed RAS.
+	for (i = 0; i < ras_size; i++)
+		RAS[i] = RAS_commit[i];
+	RAS_tos = RAS_commit_tos;
+	RAS_depth = RAS_commit_depth;
 }
 
 //
@@ -635,14 +815,22 @@ void bpred_interface::flush()
 //
 void bpred_interface::dump_config(FILE* fp) {
 	fprintf(fp, "BTB:\n");
-	fprintf(fp, "   # entries    = %d\n", BTB_SIZE);
-	fprintf(fp, "   pc mask      = 0x%x\n", BTB_MASK);
+	fprintf(fp, "   # entries    = %d\n", btb_size);
+	fprintf(fp, "   pc mask      = 0x%x\n", btb_mask);
+	fprintf(fp, "RAS:\n");
+	fprintf(fp, "   # entries    = %d\n", ras_size);
 	fprintf(fp, "Cond. BP:\n");
-	fprintf(fp, "   # entries    = %d\n", BP_TABLE_SIZE);
-	fprintf(fp, "   index mask   = 0x%x\n", BP_INDEX_MASK);
+	fprintf(fp, "   # entries    = %d\n", bp_table_size);
+	fprintf(fp, "   index mask   = 0x%x\n", bp_index_mask);
 	fprintf(fp, "   pc mask      = 0x%x\n", PC_MASK);
 	fprintf(fp, "   history mask = 0x%x\n", HIST_MASK);
 	fprintf(fp, "   history bit  = 0x%x\n", HIST_BIT);
+	if (tage)
+		fprintf(fp, "   TAGE-SC-L    = %d tagged tables of %d entries, history %d-%d\n",
+		        TAGE_TABLES, (1 << TAGE_LOG_ENTRIES), TAGE_MIN_HIST, TAGE_MAX_HIST);
+	if (ittage)
+		fprintf(fp, "Indirect BP:\n   ITTAGE       = %d tagged tables of %d entries, history %d-%d\n",
+		        ITTAGE_TABLES, (1 << ITTAGE_LOG_ENTRIES), ITTAGE_MIN_HIST, ITTAGE_MAX_HIST);
 }
 
 //
@@ -657,6 +845,10 @@ void bpred_interface::dump_stats(FILE* fp) {
 	fprintf(fp, "   predictions:         %d\n", stat_num_cond_pred);
 	fprintf(fp, "   mispredictions:      %d\n", stat_num_cond_miss);
 	fprintf(fp, "   misprediction ratio: %f\n", ((float)stat_num_cond_miss/(float)stat_num_cond_pred));
+	if (tage)
+		tage->Print(fp);
+	if (ittage)
+		ittage->Print(fp);
 }
 
 unsigned int bpred_interface::update_global_history(unsigned int ghistory,
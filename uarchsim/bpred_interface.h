@@ -7,6 +7,7 @@
 //
 #include "decode.h"
 #include "parameters.h"
+#include "tage.h"
 //
 //-------------------------------------------------------------------
 //-------------------------------------------------------------------
@@ -37,83 +38,58 @@
 
 class stats_t;
 
-class BpredPredictAutomaton
-{
-public:
-	uint32_t			tag;
-	uint32_t                      	pred;
-	uint8_t			hyst;
-
-	BpredPredictAutomaton()
-	{
-		tag = 0;
-		hyst = 0;
-		pred = 0;
-	}
+//
+// Packed predictor automata: each table is a flat array of small
+// entries, updated by these functions.
+//
 
-	~BpredPredictAutomaton()
-	{
-	}
+// Direction: one byte per entry, bit 0 the prediction and bit 1 the
+// hysteresis bit.
+#define BP_DIR_PRED(e)		((e) & 1)
+#define BP_DIR_HYST		2
 
-	void update(uint32_t outcome)
-	{
-		if (outcome == pred)
-		{
-			if (hyst < 1) {
-				hyst++;
-			}
-		}
-		else
-		{
-			if (hyst) {
-				hyst--;
-			}
-			else {
-				pred = outcome;
-			}
-		}
+static inline void bp_dir_update(uint8_t* e, uint32_t outcome)
+{
+	if (outcome == BP_DIR_PRED(*e)) {
+		*e |= BP_DIR_HYST;
 	}
-
-	void conf_update(uint32_t outcome, bool use_reset, uint32_t max_value)
-	{
-		if (outcome)
-		{
-			if (pred < max_value) {
-				pred++;
-			}
-		}
-		else
-		{
-			if (use_reset) {
-				pred = 0;
-			}
-			else if (pred) {
-				pred--;
-			}
-		}
+	else if (*e & BP_DIR_HYST) {
+		*e &= ~BP_DIR_HYST;
 	}
+	else {
+		*e = (outcome ? 1 : 0);
+	}
+}
 
-};
-
-
-class RAS_node_b
+// BTB: a target, replaced after two consecutive different targets.
+static inline void bp_btb_update(uint32_t* target, uint8_t* hyst, uint32_t outcome)
 {
-public:
-	uint32_t		addr;
-	RAS_node_b*		next;
-
-	RAS_node_b()
-	{
-		next = NULL;
+	if (outcome == *target) {
+		*hyst = 1;
+	}
+	else if (*hyst) {
+		*hyst = 0;
+	}
+	else {
+		*target = outcome;
 	}
+}
 
-	~RAS_node_b()
-	{
-		if (next) {
-			delete next;
+// Confidence (resetting or up/down) counter.
+static inline void bp_conf_update(uint8_t* ctr, uint32_t outcome, bool use_reset, uint32_t max_value)
+{
+	if (outcome) {
+		if (*ctr < max_value) {
+			(*ctr)++;
 		}
 	}
-};
+	else if (use_reset) {
+		*ctr = 0;
+	}
+	else if (*ctr) {
+		(*ctr)--;
+	}
+}
 
 class CTI_entry_b
 {
@@ -142,7 +118,29 @@ public:
 
 	bool			use_global_history;
 	uint32_t			global_history;
+
+	// RAS checkpoint: top-of-stack, depth and top entry before this CTI.
+	unsigned int		ras_tos;
+	unsigned int		ras_depth;
+	uint32_t			ras_top;
+
+	// TAGE-SC-L / ITTAGE: history before this CTI, and predictions.
+	bp_history_t		bh;
+	tage_pred_t		tage;
+	ittage_pred_t		ittage;
 };
+//
+// Configuration of a predictor instance.
+//
+typedef struct {
+	unsigned int	btb_size;
+	unsigned int	bp_table_size;
+	unsigned int	ctiq_size;
+	unsigned int	ras_size;
+	const char*	cond;		// gshare or tage-sc-l
+	const char*	indirect;	// btb or ittage
+} bpred_config_t;
+
 //-------------------------------------------------------------------
 //-------------------------------------------------------------------
 //
@@ -157,15 +155,33 @@ private:
 
   stats_t* stats;
 
+	//
+	// Configuration
+	//
+	unsigned int	btb_size;
+	unsigned int	btb_mask;
+	unsigned int	bp_table_size;
+	unsigned int	bp_index_mask;
+	unsigned int	ctiq_size;
+	unsigned int	ctiq_mask;
+	unsigned int	ras_size;
+	const char*	bp_cond;
+	const char*	bp_indirect;
+
+	void init(const bpred_config_t& config);
+
 	//
 	// Internal functions
 	//
 	void update();
 	void RAS_update();
 	bool RAS_lookup(uint32_t* target);
+	void RAS_apply(uint32_t* stack, unsigned int* tos, unsigned int* depth, unsigned int index);
 	void update_predictions(bool fm);				// "FM"
 	void make_predictions(unsigned int branch_history);
 	void decode();
+	void retire_head();
+	void spec_undo(unsigned int oldest);
 
 
 	//
@@ -176,12 +192,28 @@ private:
 	unsigned int	cti_head;
 	unsigned int	cti_tail;
 
-	RAS_node_b*	RAS;
-
-	BpredPredictAutomaton*	BTB;
-	BpredPredictAutomaton*	pred_table;
-	BpredPredictAutomaton*	conf_table;
-	BpredPredictAutomaton*	fm_table;	// "FM": false-misprediction estimator
+	// Return address stacks: circular buffers of ras_size entries.
+	// The speculative RAS is updated at prediction, and repaired from
+	// the checkpoint in the CTI queue entry of a mispredicted CTI.
+	// The committed RAS is updated at retirement, and restores the
+	// speculative RAS on a flush.
+	uint32_t*	RAS;
+	unsigned int	RAS_tos;
+	unsigned int	RAS_depth;
+	uint32_t*	RAS_commit;
+	unsigned int	RAS_commit_tos;
+	unsigned int	RAS_commit_depth;
+
+	uint32_t*	BTB;		// BTB targets
+	uint8_t*	BTB_hyst;
+	uint8_t*	pred_table;	// direction automata (BP_DIR_PRED)
+	uint8_t*	conf_table;
+	uint8_t*	fm_table;	// "FM": false-misprediction estimator
+
+	// TAGE-SC-L replaces pred_table, and ITTAGE backs the BTB, if selected (else NULL).
+	BranchHistoryClass*	bhist;
+	TageClass*		tage;
+	ITTageClass*		ittage;
 
 
 public:
@@ -217,6 +249,7 @@ public:
 	// Initialize control flow prediction stuff.
 	//
 	bpred_interface();
+	bpred_interface(const bpred_config_t& config);
 
 
 	//
@@ -272,6 +305,24 @@ public:
 	                 bool fm);		// "FM"
 
 
+	//      warm()
+	//
+	// Functional warming: predict, repair and verify a committed CTI in
+	// one step.  Trains the BTB, RAS and direction tables without
+	// updating the stat counters.  Requires that no predictions are pending.
+	// Returns whether the CTI was mispredicted.
+	//
+	bool warm(unsigned int PC, insn_t inst,
+	          unsigned int comp_target, unsigned int next_pc);
+
+	//      parse_config()
+	//
+	// Parse a predictor configuration string, <bp>,<btb>,<ras>[,<cond>[,<indirect>]]:
+	// the direction table and BTB entries, RAS entries, and the conditional
+	// and indirect predictors.  Returns false if it is malformed.
+	//
+	static bool parse_config(const char* spec, bpred_config_t* config);
+
 	//  flush()
 	//
 	// flush pending predictions
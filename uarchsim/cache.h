@@ -3,8 +3,11 @@
 #pragma interface
 #include <cstdio>
 #include <cassert>
+#include <cstdlib>
+#include <cstdint>
 #include "common.h"
 #include "decode.h"
+#include "replacement.h"
 
 
 #define	INVALID		-1
@@ -16,18 +19,29 @@
 template<class T>
 class cache {
 private:
-	// The cache is a 2-D array of entries, each entry
-	// is a tag + lru + pointer to object of type T.
+	// The cache is one contiguous, cache-line-aligned array of
+	// entries, set by set.  Each entry is a tag + the object of
+	// type T, stored in place.  An entry is invalid if its tag
+	// is INVALID.
 
 	typedef
 	struct {
 		reg_t tag;
-		unsigned int lru;
-		T* contents;
+		T contents;
 	} entry;
 
-	entry**	C;
+	entry*	C;
 
+	// Replacement state.
+	ReplacementClass* repl;
+
+	void* alloc(size_t bytes) {
+		void* p;
+		if (posix_memalign(&p, 64, bytes))
+			p = NULL;
+		assert(p);
+		return(p);
+	}
 
 public:
 	// size = number of entries deep
@@ -39,33 +53,30 @@ public:
 	unsigned int num_misses;
 
 	// constructor
-	cache(unsigned int size, unsigned int assoc) {
-		unsigned int i,j;
-
+	// policy = name of the replacement policy (see replacement.h)
+	cache(unsigned int size, unsigned int assoc, const char* policy = "lru") {
 		// First ensure that 'size' is a power of 2.
 		assert( IsPow2(size) );
 
-		C = new entry *[size];
-		for (i = 0; i < size; i++) {
-			C[i] = new entry[assoc];
-			for (j = 0; j < assoc; j++) {
-				C[i][j].tag = INVALID;
-				C[i][j].lru = j;
-				C[i][j].contents = (T*)NULL;
-			}
-		}
-
 		this->size = size;
 		this->assoc = assoc;
 		this->num_misses = 0;
+
+		repl = ReplacementClass::Create(policy, size, assoc);
+		assert(repl);
+
+		C = (entry*)alloc(sizeof(entry) * size * assoc);
+		flush();
 	}
 
 	// destructor
 	~cache() {
-		//unsigned int i;
-		//for (i = 0; i < size; i++)
-		//   delete C[i];
-		//delete C;
+		free(C);
+		delete repl;
+	}
+
+	ReplacementClass* policy() {
+		return(repl);
 	}
 
 	//
@@ -74,117 +85,85 @@ public:
 	// Added by Quinn Jacobson, October 7, 1998.
 	//
 	void flush() {
-		unsigned int i,j;
-
-		for (i = 0; i < size; i++) {
-			for (j = 0; j < assoc; j++) {
-				C[i][j].tag = INVALID;
-				C[i][j].lru = j;
-				C[i][j].contents = (T*)NULL;
-			}
+		unsigned int i;
+
+		for (i = 0; i < size*assoc; i++) {
+			C[i].tag = INVALID;
+			C[i].contents = T();
 		}
+		repl->Reset();
 	}
 
 
 	// Cache lookup and maintenance.
 	// Inputs:
 	//   (1) object id
-	//   (2) pointer to object's contents
-	//   (3) replace the entry on a cache miss
+	//   (2) replace the entry on a cache miss
+	//   (3) PC of the instruction making the access, for replacement
+	//       policies that use it (0 if unknown)
 	// Outputs:
 	//   (1) hit
-	//   (2) old object id (i.e. id that was replaced, if miss)
-	//   (3) return value: pointer to old object's contents
-	T* lookup(reg_t id, T* contents,
+	//   (2) old object id (i.e. id that was replaced, if miss;
+	//       INVALID if the replaced entry was empty or nothing was
+	//       replaced)
+	//   (3) return value: pointer to the contents stored in the array
+	//       for the hit entry, or for the replaced entry on a miss with
+	//       replace (NULL on a miss without).  A replaced entry keeps
+	//       the old object's contents, for the caller to inspect before
+	//       overwriting them with the new object's.
+	T* lookup(reg_t id,
 	          bool* hit, reg_t* old_id,
 	          bool replace,
+	          reg_t pc = 0,
 	          bool use_raw_index = false,
 	          unsigned int raw_index = 0);
 };
 
 
 template<class T>
-T* cache<T>::lookup(reg_t id, T* contents,
+T* cache<T>::lookup(reg_t id,
                     bool* hit, reg_t* old_id,
-                    bool replace,
+                    bool replace, reg_t pc,
                     bool use_raw_index, unsigned int raw_index) {
 	unsigned int index;
 	entry* set;
-	unsigned int i;
-	bool found;
-	unsigned int hit_way;
-	int replace_way;
-	T* old_contents;
+	unsigned int way;
 
 	index = MOD((use_raw_index ? raw_index : id), size);
-	set = C[index];
+	set = &C[index*assoc];
 
-	i = 0;
-	found = false;
-	while (i < assoc && !found) {
-		if (set[i].tag == id) {
-			found = true;
-		}
-		else {
-			i += 1;
+	for (way = 0; way < assoc; way++) {
+		if (set[way].tag == id) {
+			// Update replacement state.
+			repl->Hit(index, way, pc);
+
+			// Set outputs of function.
+			*hit = true;
+			*old_id = id;
+			return(&set[way].contents);
 		}
 	}
 
-	if (found) {
-		hit_way = i;
+	// record the miss
+	num_misses += 1;
 
-		// Update LRU state.
-		for (i = 0; i < assoc; i++) {
-			if (set[i].lru < set[hit_way].lru) {
-				set[i].lru += 1;
-			}
-		}
-		set[hit_way].lru = 0;
-
-		// Set outputs of function.
-		*hit = true;
-		*old_id = set[hit_way].tag;
-		old_contents = set[hit_way].contents;
+	*hit = false;
+	if (!replace) {
+		*old_id = INVALID;
+		return((T*)NULL);
 	}
-	else {
-		// record the miss
-		num_misses += 1;
-
-		// Find replacement entry, and update LRU state.
-		replace_way = -1;
-		if (replace) {
-			for (i = 0; i < assoc; i++) {
-				if (set[i].lru == (assoc-1)) {	// least-recently used
-					replace_way = (int)i;
-					set[i].lru = 0;
-				}
-				else {
-					set[i].lru += 1;
-				}
-			}
-		}
-		else {
-			for (i = 0; i < assoc; i++) {
-				if (set[i].lru == (assoc-1)) {	// least-recently used
-					replace_way = (int)i;
-				}
-			}
-		}
-		assert(replace_way != -1);
 
-		// Set outputs of function.
-		*hit = false;
-		*old_id = set[replace_way].tag;
-		old_contents = set[replace_way].contents;
+	// Find replacement entry.
+	way = repl->Victim(index);
 
-		// Perform the actual replacement.
-		if (replace) {
-			set[replace_way].tag = id;
-			set[replace_way].contents = contents;
-		}
-	}
+	// Set outputs of function.
+	*old_id = set[way].tag;
+
+	// Perform the actual replacement, and update replacement state.
+	set[way].tag = id;
+	repl->Fill(index, way, pc);
 
-	return(old_contents);
+	return(&set[way].contents);
 }
 
 
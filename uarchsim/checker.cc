@@ -58,6 +58,7 @@ void pipeline_t::check_state(state_t* micro_state, state_t* isa_state, db_t* act
 }
 
 void pipeline_t::checker() {
+   HOST_PROF_SCOPE(HP_CHECKER);
 
    #ifdef RISCV_MICRO_DEBUG
     fflush(0);
@@ -0,0 +1,211 @@
+/*--------------------------------------------------------------------------*\
+ | crit_path.cc
+ |
+ | Critical-path analysis of the retired instruction stream.  See
+ |  crit_path.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cassert>
+
+#include "crit_path.h"
+
+// Nodes of an instruction.
+#define CP_F	0
+#define CP_D	1
+#define CP_E	2
+#define CP_C	3
+#define CP_R	4
+
+static const char* cp_edge_names[CP_EDGES] = {
+	"fetch", "data", "memory", "branch", "serialize", "resource"
+};
+
+CritPathClass::CritPathClass(unsigned int window, unsigned int activeListSize, unsigned int numPhysRegs)
+	: window(window), activeListSize(activeListSize), squash(CP_NONE),
+	  windows(0), instructions(0)
+{
+	assert(window > 0);
+	producer = new uint64_t[numPhysRegs];
+	for (unsigned int i = 0; i < numPhysRegs; i++)
+		producer[i] = CP_NO_PRODUCER;
+	for (unsigned int e = 0; e < CP_EDGES; e++) {
+		cycles[e] = 0;
+		edges[e] = 0;
+	}
+	insns.reserve(window);
+}
+
+CritPathClass::~CritPathClass()
+{
+	delete [] producer;
+}
+
+const char* CritPathClass::Name(cp_edge_t e)
+{
+	return(cp_edge_names[e]);
+}
+
+void CritPathClass::Retire(cp_insn_t& insn)
+{
+	insn.squash = squash;
+	squash = CP_NONE;
+	insns.push_back(insn);
+	if (insns.size() == window)
+		Analyze();
+}
+
+// Index of the instruction in the window, or -1 if it is not there.
+// The window is in retirement order, hence sorted by sequence number.
+int CritPathClass::Find(uint64_t sequence)
+{
+	int lo = 0, hi = ((int)insns.size() - 1), mid;
+
+	if ((sequence == CP_NO_PRODUCER) || insns.empty() ||
+	    (sequence < insns[0].sequence) || (sequence > insns[hi].sequence))
+		return(-1);
+
+	while (lo <= hi) {
+		mid = ((lo + hi) / 2);
+		if (insns[mid].sequence == sequence)
+			return(mid);
+		else if (insns[mid].sequence < sequence)
+			lo = (mid + 1);
+		else
+			hi = (mid - 1);
+	}
+	return(-1);
+}
+
+static inline uint64_t cp_time(const cp_insn_t& insn, unsigned int node)
+{
+	switch (node) {
+		case CP_F: return(insn.fetch);
+		case CP_D: return(insn.dispatch);
+		case CP_E: return(insn.issue);
+		case CP_C: return(insn.complete);
+		default:   return(insn.retire);
+	}
+}
+
+void CritPathClass::Analyze()
+{
+	int i, n = (int)insns.size();
+	unsigned int node;
+	uint64_t t;
+
+	// Predecessors of the current node.
+	int pred_insn[6];
+	unsigned int pred_node[6];
+	cp_edge_t pred_edge[6];
+	unsigned int num_pred, p, best;
+	uint64_t best_t;
+
+	if (n == 0)
+		return;
+
+	i = (n - 1);
+	node = CP_R;
+	t = insns[i].retire;
+
+	while (true) {
+		const cp_insn_t& insn = insns[i];
+		num_pred = 0;
+
+		#define CP_PRED(_i, _node, _edge) \
+			{ pred_insn[num_pred] = (_i); pred_node[num_pred] = (_node); pred_edge[num_pred] = (_edge); num_pred++; }
+
+		switch (node) {
+			case CP_F:
+				if (i > 0) {
+					CP_PRED(i - 1, CP_F, CP_FETCH);
+					if (insns[i - 1].mispredicted)
+						CP_PRED(i - 1, CP_C, CP_BRANCH);
+					if (insn.squash != CP_NONE)
+						CP_PRED(i - 1, CP_R, insn.squash);
+				}
+				break;
+
+			case CP_D:
+				CP_PRED(i, CP_F, CP_FETCH);
+				if (i > 0)
+					CP_PRED(i - 1, CP_D, CP_RESOURCE);
+				if (i >= (int)activeListSize)
+					CP_PRED(i - (int)activeListSize, CP_R, CP_RESOURCE);
+				break;
+
+			case CP_E:
+				CP_PRED(i, CP_D, CP_RESOURCE);
+				for (unsigned int s = 0; s < 3; s++) {
+					int j = Find(insn.producer[s]);
+					if (j >= 0)
+						CP_PRED(j, CP_C, CP_DATA);
+				}
+				{
+					int j = Find(insn.mem_producer);
+					if (j >= 0)
+						CP_PRED(j, CP_C, CP_MEMORY);
+				}
+				break;
+
+			case CP_C:
+				CP_PRED(i, CP_E, (insn.load ? CP_MEMORY : CP_DATA));
+				break;
+
+			default:
+				CP_PRED(i, CP_C, CP_RESOURCE);
+				if (i > 0)
+					CP_PRED(i - 1, CP_R, CP_RESOURCE);
+				break;
+		}
+
+		#undef CP_PRED
+
+		if (num_pred == 0)
+			break;
+
+		// Follow the last-arriving edge; ties go to the first listed.
+		// Clamping to the current time keeps every edge's share
+		// non-negative, and the shares sum to the window's cycles.
+		best = 0;
+		best_t = cp_time(insns[pred_insn[0]], pred_node[0]);
+		for (p = 1; p < num_pred; p++) {
+			uint64_t pt = cp_time(insns[pred_insn[p]], pred_node[p]);
+			if (pt > best_t) {
+				best = p;
+				best_t = pt;
+			}
+		}
+		if (best_t > t)
+			best_t = t;
+
+		cycles[pred_edge[best]] += (t - best_t);
+		edges[pred_edge[best]]++;
+		t = best_t;
+		i = pred_insn[best];
+		node = pred_node[best];
+	}
+
+	windows++;
+	instructions += n;
+	insns.clear();
+}
+
+void CritPathClass::Print(FILE* fp)
+{
+	uint64_t total = 0;
+	unsigned int e;
+
+	Analyze();
+
+	for (e = 0; e < CP_EDGES; e++)
+		total += cycles[e];
+
+	fprintf(fp, "\n=== CRITICAL PATH ===============================================================\n\n");
+	fprintf(fp, "windows of %u retired instructions = %lu (%lu instructions)\n", window, windows, instructions);
+	fprintf(fp, "critical path length                = %lu cycles\n", total);
+	fprintf(fp, "%-10s %14s %7s %12s\n", "edge", "cycles", "%", "edges");
+	for (e = 0; e < CP_EDGES; e++)
+		fprintf(fp, "%-10s %14lu %6.2f%% %12lu\n",
+		        cp_edge_names[e], cycles[e], (total ? (100.0 * (double)cycles[e] / (double)total) : 0.0), edges[e]);
+}
@@ -0,0 +1,120 @@
+#ifndef CRIT_PATH_H
+#define CRIT_PATH_H
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+/*--------------------------------------------------------------------------*\
+ | crit_path.h
+ |
+ | Critical-path analysis of the retired instruction stream (see
+ |  --critical-path), after Fields, Rubin and Bodik's dependence-graph
+ |  model.  Each retired instruction contributes five nodes -- fetch (F),
+ |  dispatch (D), issue (E), complete (C) and retire (R) -- timed with
+ |  the cycles recorded in its payload, and these edges:
+ |
+ |   F(i-1) -> F(i)   fetch       in-order fetch (bandwidth, I$ misses)
+ |   C(i-1) -> F(i)   branch      i-1 was a mispredicted branch
+ |   R(i-1) -> F(i)   (squash)    i-1 retired and squashed the pipeline:
+ |                                a serializing instruction, an exception,
+ |                                a load violation (memory) or a
+ |                                retire-time misprediction (branch)
+ |   F(i)   -> D(i)   fetch       front-end pipeline and fetch queue
+ |   D(i-1) -> D(i)   resource    in-order dispatch (width, IQ, LSQ)
+ |   R(i-W) -> D(i)   resource    Active List of W entries full
+ |   D(i)   -> E(i)   resource    ready, but waiting to issue
+ |   C(p)   -> E(i)   data        p produced a source register of i
+ |   C(s)   -> E(i)   memory      store s forwarded its value to load i
+ |   E(i)   -> C(i)   data        execution (memory, for loads)
+ |   C(i)   -> R(i)   resource    completion to retirement
+ |   R(i-1) -> R(i)   resource    in-order retirement (width)
+ |
+ | The retired instructions are analyzed in windows of a fixed number of
+ |  instructions.  Walking back from the last instruction's retirement,
+ |  the critical path follows each node's last-arriving edge, and each
+ |  edge's share of the window's cycles is charged to its type.  Edges
+ |  from instructions before the window are ignored.
+\*--------------------------------------------------------------------------*/
+
+#define CP_NO_PRODUCER	(~0ULL)
+
+typedef enum {
+	CP_FETCH,
+	CP_DATA,
+	CP_MEMORY,
+	CP_BRANCH,
+	CP_SERIALIZE,
+	CP_RESOURCE,
+	CP_EDGES,
+	CP_NONE = CP_EDGES
+} cp_edge_t;
+
+// One retired instruction, as recorded by the Retire Stage.
+typedef struct {
+	uint64_t sequence;
+	uint64_t fetch;			// Cycles.
+	uint64_t dispatch;
+	uint64_t issue;
+	uint64_t complete;
+	uint64_t retire;
+	uint64_t producer[3];		// Sequence numbers of the producers of its source registers...
+	uint64_t mem_producer;		// ...and of the store that forwarded to it, or CP_NO_PRODUCER.
+	bool load;
+	bool mispredicted;		// Mispredicted branch.
+	cp_edge_t squash;		// Edge from the previous instruction's retirement, or CP_NONE.
+} cp_insn_t;
+
+class CritPathClass
+{
+public:
+	CritPathClass(unsigned int window, unsigned int activeListSize, unsigned int numPhysRegs);
+	~CritPathClass();
+
+	uint64_t Producer(unsigned int physReg) { return(producer[physReg]); }
+	void Produce(unsigned int physReg, uint64_t sequence) { producer[physReg] = sequence; }
+	/*------------------------------------------------------------------------*\
+	 | The Rename Stage looks up the producer of each source register, then
+	 |  records the instruction as the producer of its destination register.
+	\*------------------------------------------------------------------------*/
+
+	void Retire(cp_insn_t& insn);
+	/*------------------------------------------------------------------------*\
+	 | Adds a retired instruction, and analyzes the window when it is full.
+	\*------------------------------------------------------------------------*/
+
+	void Squash(cp_edge_t kind) { squash = kind; }
+	/*------------------------------------------------------------------------*\
+	 | The instruction just retired (or, for a load violation, at the head)
+	 |  squashed the pipeline: the next retired instruction was fetched
+	 |  after it.
+	\*------------------------------------------------------------------------*/
+
+	uint64_t Cycles(cp_edge_t e) { return(cycles[e]); }
+	const char* Name(cp_edge_t e);
+
+	void Print(FILE* fp);
+	/*------------------------------------------------------------------------*\
+	 | Analyzes the last, partial window, and prints each edge type's share
+	 |  of the critical path.
+	\*------------------------------------------------------------------------*/
+
+private:
+	unsigned int window;
+	unsigned int activeListSize;
+	uint64_t* producer;		// Per physical register.
+	cp_edge_t squash;
+
+	std::vector<cp_insn_t> insns;	// The current window, in retirement order.
+
+	// Totals over the analyzed windows.
+	uint64_t windows;
+	uint64_t instructions;
+	uint64_t cycles[CP_EDGES];
+	uint64_t edges[CP_EDGES];
+
+	int Find(uint64_t sequence);
+	void Analyze();
+};
+
+#endif //CRIT_PATH_H
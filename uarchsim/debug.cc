@@ -291,9 +291,12 @@ db_t* debug_buffer_t::pop(debug_index_t i) {
    // Fill out the debug buffer
    // Make sure the simulator is still running and is not already 
    // done with the program.
-   while(hungry() && isa_sim->running()){
-    ifprintf(logging_on,stderr, "Functional simulator hungry\n");
-     isa_sim->step(1);
+   {
+     HOST_PROF_SCOPE(HP_RUN_AHEAD);
+     while(hungry() && isa_sim->running()){
+      ifprintf(logging_on,stderr, "Functional simulator hungry\n");
+       isa_sim->step(1);
+     }
    }
 
    // Check for underflow and maintain 'length'.
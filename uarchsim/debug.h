@@ -127,6 +127,7 @@ public:
 	~debug_buffer_t();
 
   void set_isa_sim(sim_t* _isa_sim){ isa_sim = _isa_sim; }
+  sim_t* get_isa_sim(){ return isa_sim; }
   void run_ahead();
   void skip_till_pc(reg_t pc, unsigned int proc_id);
 
@@ -24,6 +24,7 @@ void pipeline_t::dispatch() {
    // (4) There aren't enough LQ/SQ entries for the dispatch bundle.
 
    // First stall condition: There isn't a dispatch bundle.
+   dispatch_slots = TD_FE_FQ_EMPTY;
    if (!DISPATCH[0].valid) {
       return;
    }
@@ -35,8 +36,10 @@ void pipeline_t::dispatch() {
    //   then stall the Dispatch Stage. Stalling is achieved by returning from this function ('return').
    // * Else, don't stall the Dispatch Stage. This is achieved by doing nothing and proceeding to the next statements.
 	
-	if(REN->stall_dispatch(dispatch_width))
+	if(REN->stall_dispatch(dispatch_width)) {
+		dispatch_slots = TD_BE_ROB;
 		return;
+	}
 
 
    //
@@ -84,9 +87,15 @@ void pipeline_t::dispatch() {
    }
 
    // Now, check for available entries in the unified IQ and the LQ/SQ.
-   if (IQ.stall(bundle_inst) || LSU.stall(bundle_load, bundle_store)) {
+   if (IQ.stall(bundle_inst)) {
+      dispatch_slots = TD_BE_IQ;
       return;
    }
+   if (LSU.stall(bundle_load, bundle_store)) {
+      dispatch_slots = TD_BE_LSQ;
+      return;
+   }
+   dispatch_slots = TD_DISPATCHED;
 
 
    //
@@ -141,6 +150,11 @@ void pipeline_t::dispatch() {
 	  
 	  PAY.buf[index].AL_index=REN->dispatch_inst(destination, log_reg, phys_reg, load_flag, store_flag, branch_flag, amo_flag, csr_flag, pc);
 
+	  // Instructions that bypass the IQs issue and complete now.
+	  PAY.buf[index].dispatch_cycle = cycle;
+	  PAY.buf[index].issue_cycle = cycle;
+	  PAY.buf[index].complete_cycle = cycle;
+
       // FIX_ME #8
       // Determine initial ready bits for the instruction's three source registers.
       // These will be used to initialize the instruction's ready bits in the Issue Queue.
@@ -186,6 +200,13 @@ void pipeline_t::dispatch() {
 		if(PAY.buf[index].C_valid)
 			REN->clear_ready(PAY.buf[index].C_phys_reg);
 
+      // Value prediction: write the predicted value into the destination register and mark it ready,
+      // so that dependents do not wait for the producer. The producer validates it when it executes.
+      if (PAY.buf[index].C_valid && PAY.buf[index].vp.lookup && PAY.buf[index].vp.predicted) {
+         REN->write(PAY.buf[index].C_phys_reg, PAY.buf[index].vp.value);
+         REN->set_ready(PAY.buf[index].C_phys_reg);
+      }
+
 
       // FIX_ME #10
       // Dispatch the instruction into the Issue Queue, or circumvent the Issue Queue and immediately update status in the Active List.
@@ -317,6 +338,16 @@ void pipeline_t::dispatch() {
       // Dispatch loads and stores into the LQ/SQ and record their LQ/SQ indices.
       if (IS_MEM_OP(PAY.buf[index].flags)) {
          if (!PAY.buf[index].split_store || PAY.buf[index].upper) {
+            // Without speculative disambiguation, loads wait for all prior store addresses.
+            // With it, the store-set predictor (if enabled) makes loads wait for their predicted store.
+            bool mdp_stall = !SPEC_DISAMBIG;
+            int mdp_store = MDP_ALL_STORES;
+            unsigned int sq_index;
+            if (SPEC_DISAMBIG && MDP && IS_LOAD(PAY.buf[index].flags) && MDP->Load(PAY.buf[index].pc, &sq_index)) {
+               mdp_stall = true;
+               mdp_store = (int)sq_index;
+            }
+
             LSU.dispatch(IS_LOAD(PAY.buf[index].flags),
                          PAY.buf[index].size,
                          PAY.buf[index].left,
@@ -325,7 +356,10 @@ void pipeline_t::dispatch() {
                          index,
                          PAY.buf[index].LQ_index, PAY.buf[index].LQ_phase,
                          PAY.buf[index].SQ_index, PAY.buf[index].SQ_phase,
-			 (IS_LOAD(PAY.buf[index].flags) && (!SPEC_DISAMBIG || (MEM_DEP_PRED && (MDP.find(PAY.buf[index].pc) != MDP.end())))));
+			 (IS_LOAD(PAY.buf[index].flags) && mdp_stall), mdp_store);
+
+            if (MDP && IS_STORE(PAY.buf[index].flags))
+               MDP->Store(PAY.buf[index].pc, PAY.buf[index].SQ_index);
 
             // The lower part of a split-store should inherit the same LSU indices.
             if (PAY.buf[index].split_store) {
@@ -75,6 +75,7 @@ void pipeline_t::execute(unsigned int lane_number) {
 				IQ.wakeup(PAY.buf[index].C_phys_reg);
 				REN->set_ready(PAY.buf[index].C_phys_reg);
 				REN->write(PAY.buf[index].C_phys_reg,PAY.buf[index].C_value.dw);
+				vp_validate(index);
 			}
 
 
@@ -163,6 +164,7 @@ void pipeline_t::execute(unsigned int lane_number) {
 		 {
 		 	REN->write(PAY.buf[index].C_phys_reg,(PAY.buf[index].C_value.dw));
 		 	//REN->set_ready(destination_reg);
+		 	vp_validate(index);
 		 }
 			
 
@@ -278,6 +280,7 @@ void pipeline_t::load_replay() {
 		IQ.wakeup(destination_reg);
 		REN->set_ready(destination_reg);
 		REN->write(destination_reg,PAY.buf[index].C_value.dw);
+		vp_validate(index);
 	
 
       // FIX_ME #18b
@@ -288,6 +291,15 @@ void pipeline_t::load_replay() {
       // 2. Set the completed bit for this instruction in the Active List.
 		unsigned int AL=PAY.buf[index].AL_index;
 		REN->set_complete(PAY.buf[index].AL_index);
+		PAY.buf[index].complete_cycle = cycle;
 
    }
 }
+
+// Validate a value prediction once the instruction's value is known.
+// A misprediction is recovered when the instruction retires: everything after it is squashed
+// ("approach #1 recovery"), since its dependents may have consumed the predicted value.
+void pipeline_t::vp_validate(unsigned int index) {
+   if (PAY.buf[index].vp.lookup && PAY.buf[index].vp.predicted && (PAY.buf[index].C_value.dw != PAY.buf[index].vp.value))
+      set_value_misprediction(PAY.buf[index].AL_index);
+}
@@ -16,6 +16,12 @@ void pipeline_t::fetch() {
    unsigned int i;	// iterate up to fetch width
    bool stop;		// branch, icache block boundary, etc.
 
+   // Fetch source: the I$, the uop cache (trace of uc_length instructions and their next PCs), or the loop buffer.
+   unsigned int source;
+   unsigned int uc_length;
+   const reg_t* uc_next;
+   bool injected;	// NOP injected for a fetch stall
+
    // Instruction fetched from mmu.
    insn_t insn;		// "insn" is used by some MACROs, hence, need to use this name for the instruction variable.
    reg_t trap_cause = 0;
@@ -35,6 +41,12 @@ void pipeline_t::fetch() {
    bool fm;
 
 
+   // The decoupled front-end fetches the blocks predicted by the Branch Prediction Stage.
+   if (ftq_size) {
+      fetch_ftq();
+      return;
+   }
+
    /////////////////////////////
    // Stall logic.
    /////////////////////////////
@@ -47,17 +59,33 @@ void pipeline_t::fetch() {
       return;
    }
 
+   /////////////////////////////
+   // Select fetch source.
+   /////////////////////////////
+
+   // The loop buffer and uop cache supply decoded instructions, bypassing the I$.
+   // They are not consulted while NOPs are injected for a fetch stall (see below).
+   source = FETCH_IC;
+   uc_length = 0;
+   uc_next = NULL;
+   if (!fetch_exception && !fetch_csr && !fetch_amo) {
+      if (LB && LB->Supplies(pc))
+         source = FETCH_LB;
+      else if (UC && (uc_length = UC->Lookup(pc, &uc_next)))
+         source = FETCH_UC;
+   }
+
    /////////////////////////////
    // Model I$ misses.
    /////////////////////////////
 
-   if (!PERFECT_ICACHE) {
+   if (!PERFECT_ICACHE && (source == FETCH_IC)) {
       line1 = (pc >> L1_IC_LINE_SIZE);
-      resolve_cycle1 = IC->Access(Tid, cycle, (line1 << L1_IC_LINE_SIZE), false, &hit1);
+      resolve_cycle1 = IC->Access(Tid, cycle, (line1 << L1_IC_LINE_SIZE), false, &hit1, false, true, pc);
       if (IC_INTERLEAVED) {
          // Access next consecutive line.
          line2 = (pc >> L1_IC_LINE_SIZE) + 1;
-         resolve_cycle2 = IC->Access(Tid, cycle, (line2 << L1_IC_LINE_SIZE), false, &hit2);
+         resolve_cycle2 = IC->Access(Tid, cycle, (line2 << L1_IC_LINE_SIZE), false, &hit2, false, true, pc);
       }
       else {
          hit2 = true;
@@ -82,7 +110,8 @@ void pipeline_t::fetch() {
       // Fetch instruction -or- inject NOP for fetch stall.
       //////////////////////////////////////////////////////
 
-      if (fetch_exception || fetch_csr || fetch_amo) {
+      injected = (fetch_exception || fetch_csr || fetch_amo);
+      if (injected) {
          // Stall the fetch unit if there is a prior unresolved fetch exception, CSR instruction, or AMO instruction.
          // A literal stall may deadlock the Rename Stage: it requires a full bundle from the FQ to progress.
          // Thus, instead of literally stalling the fetch unit, stall it by injecting NOPs after the offending
@@ -112,8 +141,10 @@ void pipeline_t::fetch() {
       PAY.buf[index].inst = insn;
       PAY.buf[index].pc = pc;
       PAY.buf[index].sequence = sequence;
+      PAY.buf[index].fetch_cycle = cycle;
       PAY.buf[index].fetch_exception = fetch_exception;
       PAY.buf[index].fetch_exception_cause = trap_cause;
+      PAY.buf[index].vp.lookup = false;
 
       //////////////////////////////////////////////////////
       // map_to_actual()
@@ -179,12 +210,34 @@ void pipeline_t::fetch() {
       // Keep count of number of fetched instructions.
       i++;
 
-      // If not already stopped:
-      // Stop if the I$ is not interleaved and if a line boundary is crossed.
-      if (!stop && !IC_INTERLEAVED) {
-         line1 = (pc >> L1_IC_LINE_SIZE);
-         line2 = (next_pc >> L1_IC_LINE_SIZE);
-         stop = (line1 != line2);
+      // Train the loop buffer, and the uop cache's fill unit, on the instructions fetched (not NOPs injected).
+      if (!injected) {
+         if (LB)
+            LB->Train(pc, next_pc);
+         if (UC && (source == FETCH_IC))
+            UC->Fill(pc, next_pc, fetch_exception);
+      }
+
+      switch (source) {
+         case FETCH_LB:
+            // The loop buffer supplies multiple iterations of the loop, until fetch leaves it.
+            stop = !LB->Supplies(next_pc);
+            break;
+
+         case FETCH_UC:
+            // The uop cache supplies the trace for as long as the predicted path follows it.
+            stop = ((i >= uc_length) || (next_pc != uc_next[i - 1]));
+            break;
+
+         default:
+            // If not already stopped:
+            // Stop if the I$ is not interleaved and if a line boundary is crossed.
+            if (!stop && !IC_INTERLEAVED) {
+               line1 = (pc >> L1_IC_LINE_SIZE);
+               line2 = (next_pc >> L1_IC_LINE_SIZE);
+               stop = (line1 != line2);
+            }
+            break;
       }
 
       // Go to next PC.
@@ -192,4 +245,354 @@ void pipeline_t::fetch() {
       state.pc = pc;
       sequence++;
    }			// while()
+
+   fetch_bundles[source]++;
+   fetch_insns[source] += i;
+   if (source == FETCH_UC)
+      UC->Supplied(i);
+   else if (source == FETCH_LB)
+      LB->Supplied(i);
 }			// fetch()
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Decoupled front-end.
+//
+// The Branch Prediction Stage, predict(), runs ahead of the Fetch Stage.
+// Each cycle it predicts one fetch block -- the same instructions a fetch
+// bundle would hold, ending at a predicted-taken branch or I$ line
+// boundary -- and pushes it onto the Fetch Target Queue (FTQ).  The
+// Fetch Stage, fetch_ftq(), pops one block per cycle, accesses the I$,
+// and moves the block's instructions into the payload buffer.  Meanwhile
+// ftq_prefetch() prefetches the I$ lines of blocks still in the FTQ
+// (fetch-directed instruction prefetching, FDIP), so the Fetch Stage
+// finds them in the I$.
+//
+// The predictor needs each instruction's opcode and direct target, which
+// real hardware gets from its BTB and predecode bits.  Here the Branch
+// Prediction Stage predecodes instructions via the MMU.
+/////////////////////////////////////////////////////////////////////////////
+
+void pipeline_t::predict() {
+   ftq_block_t* block;
+   ftq_insn_t* f;
+   insn_t insn;
+   bool stop;
+
+   // Local variables related to branch prediction.
+   unsigned int history_reg;
+   unsigned int direct_target;
+   reg_t next_pc;
+   unsigned int pred_tag;
+   bool conf;
+   bool fm;
+
+   /////////////////////////////
+   // Stall logic.
+   /////////////////////////////
+
+   // Stall the Branch Prediction Stage if either:
+   // 1. It predicted a trap, AMO, or SYSTEM instruction.  The Fetch Stage stalls on these
+   //    until they retire, and the pipeline is then redirected (see ftq_flush()).
+   // 2. The FTQ is full.
+   if (bpu_stalled) {
+      ftq_prefetch();
+      return;
+   }
+   if (ftq_length == ftq_size) {
+      inc_counter(ftq_full_count);
+      ftq_prefetch();
+      return;
+   }
+
+   /////////////////////////////
+   // Predict fetch block.
+   /////////////////////////////
+
+   block = &FTQ[ftq_tail];
+   block->length = 0;
+   block->prefetched = PERFECT_ICACHE;
+
+   stop = false;
+   while ((block->length < fetch_width) && (PERFECT_FETCH || !stop)) {
+      f = &block->insn[block->length];
+      f->pc = bpu_pc;
+      f->fetch_exception = false;
+      f->trap_cause = 0;
+
+      // Predecode the instruction.
+      // Predict a "NOP with fetch exception" if the MMU reference generates an exception.
+      try {
+         insn = (mmu->load_insn(bpu_pc)).insn;
+      }
+      catch (trap_t& t) {
+         insn = insn_t(INSN_NOP);
+         f->fetch_exception = true;
+         f->trap_cause = t.cause();
+      }
+
+      // Initialize some predictor-related flags.
+      pred_tag = 0;
+      history_reg = 0xFFFFFFFF;
+
+      switch (insn.opcode()) {
+         case OP_JAL:
+            direct_target = (bpu_pc + insn.uj_imm());
+            next_pc = BP.get_pred(history_reg, bpu_pc, insn, direct_target, &pred_tag, &conf, &fm);
+            assert(next_pc == direct_target);
+            stop = true;
+            break;
+
+         case OP_JALR:
+            next_pc = BP.get_pred(history_reg, bpu_pc, insn, 0, &pred_tag, &conf, &fm);
+            stop = true;
+            break;
+
+         case OP_BRANCH:
+            direct_target = (bpu_pc + insn.sb_imm());
+            next_pc = BP.get_pred(history_reg, bpu_pc, insn, direct_target, &pred_tag, &conf, &fm);
+            assert((next_pc == direct_target) || (next_pc == INCREMENT_PC(bpu_pc)));
+            if (next_pc != INCREMENT_PC(bpu_pc))
+               stop = true;
+            break;
+
+         default:
+            next_pc = INCREMENT_PC(bpu_pc);
+            break;
+      }
+
+      f->inst = insn;
+      f->next_pc = next_pc;
+      f->pred_tag = pred_tag;
+      block->length++;
+
+      // Nothing is predicted past an instruction that stalls the Fetch Stage.
+      if (f->fetch_exception || (insn.opcode() == OP_AMO) || (insn.opcode() == OP_SYSTEM))
+         bpu_stalled = true;
+
+      // If not already stopped:
+      // Stop if the I$ is not interleaved and if a line boundary is crossed.
+      if (!stop && !IC_INTERLEAVED)
+         stop = ((bpu_pc >> L1_IC_LINE_SIZE) != (next_pc >> L1_IC_LINE_SIZE));
+
+      // Go to next PC.
+      bpu_pc = next_pc;
+
+      if (bpu_stalled)
+         break;
+   }
+
+   // Push the block onto the FTQ.
+   ftq_tail = MOD_S((ftq_tail + 1), ftq_size);
+   ftq_length++;
+   inc_counter(ftq_block_count);
+
+   ftq_prefetch();
+}			// predict()
+
+
+void pipeline_t::fetch_ftq() {
+   ftq_block_t* block;
+   ftq_insn_t* f;
+   unsigned int n;
+   bool inject;
+   bool stop;
+
+   // Variables related to instruction cache.
+   unsigned int line1;
+   unsigned int line2;
+   bool hit1;
+   bool hit2;
+   cycle_t resolve_cycle1;
+   cycle_t resolve_cycle2;
+
+   unsigned int i;
+   insn_t insn;
+   reg_t trap_cause;
+   reg_t next_pc;
+   unsigned int pred_tag;
+   unsigned int index;
+
+   /////////////////////////////
+   // Stall logic.
+   /////////////////////////////
+
+   // Stall the Fetch Stage if either:
+   // 1. The Decode Stage is stalled.
+   // 2. An I$ miss has not yet resolved.
+   if ((DECODE[0].valid) ||		// Decode Stage is stalled.
+       (cycle < next_fetch_cycle)) {	// I$ miss has not yet resolved.
+      return;
+   }
+
+   // As in fetch(), stall on a prior unresolved fetch exception, CSR instruction, or AMO instruction
+   // by injecting NOPs.  The Branch Prediction Stage stopped at the offending instruction.
+   inject = (fetch_exception || fetch_csr || fetch_amo);
+
+   block = NULL;
+   n = fetch_width;
+   if (!inject) {
+      // Stall if the Branch Prediction Stage has not predicted the next fetch block.
+      if (ftq_length == 0) {
+         inc_counter(ftq_empty_count);
+         return;
+      }
+
+      block = &FTQ[ftq_head];
+      n = block->length;
+      assert(block->insn[0].pc == pc);
+
+      /////////////////////////////
+      // Model I$ misses.
+      /////////////////////////////
+
+      if (!PERFECT_ICACHE) {
+         line1 = (block->insn[0].pc >> L1_IC_LINE_SIZE);
+         line2 = (block->insn[n - 1].pc >> L1_IC_LINE_SIZE);
+         resolve_cycle1 = IC->Access(Tid, cycle, (line1 << L1_IC_LINE_SIZE), false, &hit1, false, true, pc);
+         if (line2 != line1)
+            resolve_cycle2 = IC->Access(Tid, cycle, (line2 << L1_IC_LINE_SIZE), false, &hit2, false, true, pc);
+         else
+            hit2 = true;
+
+         if (!hit1 || !hit2) {
+            next_fetch_cycle = MAX((hit1 ? 0 : resolve_cycle1), (hit2 ? 0 : resolve_cycle2));
+            assert(next_fetch_cycle > cycle);
+            return;
+         }
+      }
+   }
+
+   /////////////////////////////
+   // Compose fetch bundle.
+   /////////////////////////////
+
+   stop = false;
+   for (i = 0; (i < n) && !stop; i++) {
+      trap_cause = 0;
+      if (inject) {
+         insn = insn_t(INSN_NOP);
+         next_pc = INCREMENT_PC(pc);
+         pred_tag = 0;
+      }
+      else {
+         f = &block->insn[i];
+         insn = f->inst;
+         next_pc = f->next_pc;
+         pred_tag = f->pred_tag;
+         if (f->fetch_exception) {
+            set_fetch_exception();
+            trap_cause = f->trap_cause;
+         }
+         if (insn.opcode() == OP_AMO)
+            set_fetch_amo();
+         else if (insn.opcode() == OP_SYSTEM)
+            set_fetch_csr();
+      }
+
+      // Put the instruction's information into PAY.
+      index = PAY.push();
+      PAY.buf[index].inst = insn;
+      PAY.buf[index].pc = pc;
+      PAY.buf[index].sequence = sequence;
+      PAY.buf[index].fetch_cycle = cycle;
+      PAY.buf[index].fetch_exception = fetch_exception;
+      PAY.buf[index].fetch_exception_cause = trap_cause;
+      PAY.buf[index].vp.lookup = false;
+      PAY.map_to_actual(this, index, Tid);
+
+      // Set payload buffer entry's next_pc and pred_tag.
+      PAY.buf[index].next_pc = next_pc;
+      PAY.buf[index].pred_tag = pred_tag;
+
+      // Latch instruction into fetch-decode pipeline register.
+      DECODE[i].valid = true;
+      DECODE[i].index = index;
+
+      // Go to next PC.
+      line1 = (pc >> L1_IC_LINE_SIZE);
+      pc = next_pc;
+      state.pc = pc;
+      sequence++;
+
+      // Injected NOPs stop at a line boundary, like fetch().
+      stop = (inject && !PERFECT_FETCH && !IC_INTERLEAVED && (line1 != (pc >> L1_IC_LINE_SIZE)));
+   }
+
+   fetch_bundles[FETCH_IC]++;
+   fetch_insns[FETCH_IC] += i;
+
+   // Pop the block from the FTQ.
+   if (!inject) {
+      ftq_head = MOD_S((ftq_head + 1), ftq_size);
+      ftq_length--;
+   }
+}			// fetch_ftq()
+
+
+void pipeline_t::ftq_prefetch() {
+   unsigned int i, j;
+   unsigned int issued;
+   ftq_block_t* block;
+   reg_t line1;
+   reg_t line2;
+
+   // Prefetch the I$ lines of the oldest blocks not yet prefetched, up to FTQ_PREFETCHES lines per cycle.
+   // The I$ drops prefetches of lines it holds or is fetching, and when its MHSRs are busy.
+   issued = 0;
+   for (i = 0, j = ftq_head; (i < ftq_length) && (issued < FTQ_PREFETCHES); i++, j = MOD_S((j + 1), ftq_size)) {
+      block = &FTQ[j];
+      if (block->prefetched)
+         continue;
+
+      line1 = (block->insn[0].pc >> L1_IC_LINE_SIZE);
+      line2 = (block->insn[block->length - 1].pc >> L1_IC_LINE_SIZE);
+      if ((line1 != line2) && ((issued + 2) > FTQ_PREFETCHES) && (issued > 0))
+         break;
+
+      IC->Prefetch(Tid, cycle, (line1 << L1_IC_LINE_SIZE), block->insn[0].pc);
+      issued++;
+      if (line1 != line2) {
+         IC->Prefetch(Tid, cycle, (line2 << L1_IC_LINE_SIZE), block->insn[0].pc);
+         issued++;
+      }
+      block->prefetched = true;
+   }
+}			// ftq_prefetch()
+
+
+void pipeline_t::ftq_flush() {
+   // Discard all predicted blocks and restart prediction at the redirected fetch PC.
+   // The branch predictor itself is rolled back by the caller (fix_pred() or flush()).
+   if (ftq_length || bpu_stalled)
+      inc_counter(ftq_flush_count);
+   ftq_head = 0;
+   ftq_tail = 0;
+   ftq_length = 0;
+   bpu_pc = pc;
+   bpu_stalled = false;
+}			// ftq_flush()
+
+
+void pipeline_t::dump_fetch_stats(FILE* fp) {
+   static const char* const source_name[FETCH_SOURCES] = {"I$", "uop cache", "loop buffer"};
+   uint64_t bundles = 0;
+   uint64_t insns = 0;
+   unsigned int i;
+
+   fprintf(fp, "fetch bandwidth (fetch width %u)\n", fetch_width);
+   for (i = 0; i < FETCH_SOURCES; i++) {
+      bundles += fetch_bundles[i];
+      insns += fetch_insns[i];
+      if (fetch_bundles[i])
+         fprintf(fp, "   %-12s bundles = %lu  instructions = %lu  instructions/bundle = %f\n", source_name[i],
+                 fetch_bundles[i], fetch_insns[i], ((double)fetch_insns[i] / (double)fetch_bundles[i]));
+   }
+   fprintf(fp, "   %-12s bundles = %lu  instructions = %lu  instructions/bundle = %f\n", "all",
+           bundles, insns, (bundles ? ((double)insns / (double)bundles) : 0.0));
+
+   if (UC)
+      UC->Print(fp);
+   if (LB)
+      LB->Print(fp);
+}
@@ -23,6 +23,8 @@ public:
 	unsigned int pop();			// pop an instruction (its payload buffer index) from the fetch queue
 
 	void flush();				// flush the fetch queue (make it empty)
+
+	unsigned int occupancy() {return(length);}	// number of instructions in fetch queue
 };
 
 #endif //FETCH_QUEUE_H
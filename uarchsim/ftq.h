@@ -0,0 +1,29 @@
+#ifndef FTQ_H
+#define FTQ_H
+
+#include "decode.h"
+
+// Fetch target queue (FTQ) of the decoupled front-end.  The branch
+// prediction stage runs ahead of the Fetch Stage and pushes predicted
+// fetch blocks; the Fetch Stage pops them, accesses the I$, and moves
+// their instructions into the payload buffer.
+
+// One predicted instruction of a fetch block.
+typedef struct {
+	insn_t inst;		// Predecoded instruction (NOP if fetching it excepted).
+	reg_t pc;
+	reg_t next_pc;		// Predicted next PC.
+	unsigned int pred_tag;	// Branch predictor tag (see bpred_interface::get_pred()).
+	bool fetch_exception;	// Fetching the instruction excepted.
+	reg_t trap_cause;
+} ftq_insn_t;
+
+// One predicted fetch block: up to fetch width instructions, ending at
+// a predicted-taken branch or I$ line boundary, like a fetch bundle.
+typedef struct {
+	unsigned int length;	// Number of instructions.
+	bool prefetched;	// FDIP: the block's I$ line(s) have been prefetched.
+	ftq_insn_t* insn;	// [fetch width]
+} ftq_block_t;
+
+#endif //FTQ_H
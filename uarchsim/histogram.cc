@@ -11,6 +11,7 @@
 //#include <stream.h>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 
 #include "histogram.h"
 
@@ -30,7 +31,7 @@ HistogramClass::HistogramClass(int bins)
 
 	assert(bins>0);
 
-	hist = new int[bins];
+	hist = new uint64_t[bins];
 	assert(hist);
 
 	len = bins;
@@ -103,7 +104,7 @@ void HistogramClass::Clear()
 	}
 }
 
-int HistogramClass::Bin(int bin)
+uint64_t HistogramClass::Bin(int bin)
 /*------------------------------------------------------------------------*\
  | Returns the number of samples added to a bin.  The bin must be
  |  non-negative, but can be of any size.
@@ -117,12 +118,13 @@ int HistogramClass::Bin(int bin)
 	return(hist[bin]);
 }
 
-int HistogramClass::Samples()
+uint64_t HistogramClass::Samples()
 /*------------------------------------------------------------------------*\
  | Returns the total number of samples added to all bins.
 \*------------------------------------------------------------------------*/
 {
-	int samp, i;
+	uint64_t samp;
+	int i;
 
 	for(samp = 0,i=0; i<len; samp = samp + hist[i], i++);
 
@@ -179,6 +181,25 @@ double HistogramClass::Variance()
 	return( ( samp * sumSq - ((double) sum) * sum ) / (samp * samp) );
 }
 
+int HistogramClass::Percentile(double p)
+/*------------------------------------------------------------------------*\
+ | Returns the smallest bin at or below which at least fraction p
+ |  (0 < p <= 1) of the samples fall.  The last bin stands for all
+ |  higher sample values.
+\*------------------------------------------------------------------------*/
+{
+	uint64_t samp, cum;
+	int i;
+
+	samp = Samples();
+	for (cum = 0, i = 0; i < (len - 1); i++) {
+		cum = cum + hist[i];
+		if ((double)cum >= (p * (double)samp))
+			break;
+	}
+	return(i);
+}
+
 void HistogramClass::Print(FILE* fp, unsigned int norm_value)
 /*------------------------------------------------------------------------*\
  | Prints out the histogram data to the output stream specified.
@@ -193,7 +214,7 @@ void HistogramClass::Print(FILE* fp, unsigned int norm_value)
 	}
 	else {
 		for (i=0; i<len; i++) {
-			fprintf(fp, "%d\t%d\n", i, hist[i]);
+			fprintf(fp, "%d\t%lu\n", i, hist[i]);
 		}
 	}
 }
@@ -212,3 +233,66 @@ void HistogramClass::PrintStat(ostream& out)
 	out << "Standard Deviation: " << sqrt(Variance()) << "\n";
 }
 #endif
+
+LogHistogramClass::LogHistogramClass()
+{
+	Clear();
+}
+
+void LogHistogramClass::Clear()
+{
+	memset(hist, 0, sizeof(hist));
+	samples = 0;
+	sum = 0;
+	max = 0;
+}
+
+uint64_t LogHistogramClass::LowerBound(unsigned int bin)
+{
+	unsigned int e;
+
+	if (bin < LOG_HIST_EXACT)
+		return(bin);
+	e = (((bin - LOG_HIST_EXACT) / LOG_HIST_SUB) + 3);
+	return((uint64_t)(LOG_HIST_SUB + ((bin - LOG_HIST_EXACT) % LOG_HIST_SUB)) << (e - 2));
+}
+
+uint64_t LogHistogramClass::Percentile(double p)
+{
+	uint64_t cum = 0;
+	unsigned int i;
+
+	if (!samples)
+		return(0);
+	for (i = 0; i < (LOG_HIST_BINS - 1); i++) {
+		cum += hist[i];
+		if ((double)cum >= (p * (double)samples))
+			break;
+	}
+	// The bin's upper bound, but no more than the largest sample.
+	if ((i == (LOG_HIST_BINS - 1)) || ((LowerBound(i + 1) - 1) > max))
+		return(max);
+	return(LowerBound(i + 1) - 1);
+}
+
+void LogHistogramClass::Print(FILE* fp, const char* name, bool bins)
+{
+	uint64_t cum = 0;
+	unsigned int i;
+
+	fprintf(fp, "%-24s samples %12lu  avg %9.2f  p50 %7lu  p90 %7lu  p99 %7lu  max %7lu\n",
+	        name, samples, Average(), Percentile(0.5), Percentile(0.9), Percentile(0.99), max);
+	if (!bins)
+		return;
+	for (i = 0; i < LOG_HIST_BINS; i++) {
+		if (hist[i]) {
+			cum += hist[i];
+			if ((i == (LOG_HIST_BINS - 1)) || (LowerBound(i + 1) - 1) == LowerBound(i))
+				fprintf(fp, "   %21lu %12lu %7.2f%%\n", LowerBound(i), hist[i],
+				        (100.0 * (double)cum / (double)samples));
+			else
+				fprintf(fp, "   %10lu-%-10lu %12lu %7.2f%%\n", LowerBound(i), (LowerBound(i + 1) - 1), hist[i],
+				        (100.0 * (double)cum / (double)samples));
+		}
+	}
+}
@@ -2,6 +2,8 @@
 #define HISTOGRAM_H
 
 #include <iostream>
+#include <cstdio>
+#include <cstdint>
 
 /*--------------------------------------------------------------------------*\
  | histogram.h
@@ -48,13 +50,13 @@ public:
 	 | Clears out the histogram for reuse.
 	\*------------------------------------------------------------------------*/
 
-	int Bin(int bin);
+	uint64_t Bin(int bin);
 	/*------------------------------------------------------------------------*\
 	 | Returns the number of samples added to a bin.  The bin must be
 	 |  non-negative, but can be of any size.
 	\*------------------------------------------------------------------------*/
 
-	int Samples();
+	uint64_t Samples();
 	/*------------------------------------------------------------------------*\
 	 | Returns the total number of samples added to all bins.
 	\*------------------------------------------------------------------------*/
@@ -93,6 +95,13 @@ public:
 	 | SumSq().
 	\*------------------------------------------------------------------------*/
 
+	int Percentile(double p);
+	/*------------------------------------------------------------------------*\
+	 | Returns the smallest bin at or below which at least fraction p
+	 |  (0 < p <= 1) of the samples fall.  The last bin stands for all
+	 |  higher sample values.
+	\*------------------------------------------------------------------------*/
+
 	void Print(FILE* fp, unsigned int norm_value = 0);
 	/*------------------------------------------------------------------------*\
 	 | Prints out the histogram data to the output stream specified.
@@ -108,7 +117,7 @@ public:
 
 
 private:
-	int* hist;   /* Actually contains the histogram data.                   */
+	uint64_t* hist;   /* Actually contains the histogram data.              */
 	int len;     /* Number of bins in the histogram data.                   */
 	unsigned long long sum;    /* Keeps a running sum of the sampled data.  */
 	unsigned long long sumSq;  /* Keeps a running sum of the squares of the
@@ -116,5 +125,76 @@ private:
 
 };
 
+/*--------------------------------------------------------------------------*\
+ | Histogram of unbounded sample values (e.g., latencies) in log-scaled
+ |  bins: values below LOG_HIST_EXACT have a bin each; above that, each
+ |  power of two is split into LOG_HIST_SUB bins, so a bin's width is at
+ |  most 1/LOG_HIST_SUB of its lower bound.  Recording a sample is O(1).
+\*--------------------------------------------------------------------------*/
+
+#define LOG_HIST_EXACT	8
+#define LOG_HIST_SUB	4	// LOG_HIST_EXACT = 2 * LOG_HIST_SUB
+#define LOG_HIST_BINS	(LOG_HIST_EXACT + (64 - 3) * LOG_HIST_SUB)
+
+class LogHistogramClass
+{
+public:
+	LogHistogramClass();
+
+	inline void Increment(uint64_t value)
+	{
+		hist[BinOf(value)]++;
+		samples++;
+		sum += value;
+		if (value > max)
+			max = value;
+	}
+	/*------------------------------------------------------------------------*\
+	 | Adds one sample.
+	\*------------------------------------------------------------------------*/
+
+	void Clear();
+
+	uint64_t Samples() { return(samples); }
+	uint64_t Max() { return(max); }
+	double Average() { return(samples ? ((double)sum / (double)samples) : 0.0); }
+
+	uint64_t Percentile(double p);
+	/*------------------------------------------------------------------------*\
+	 | Returns the upper bound of the bin holding the sample at fraction p
+	 |  (0 < p <= 1) of the sorted samples: i.e., at least fraction p of the
+	 |  samples are at or below the value returned.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp, const char* name, bool bins = false);
+	/*------------------------------------------------------------------------*\
+	 | Prints one line with the samples, average, median, 90th and 99th
+	 |  percentiles, and maximum; and, if bins, each non-empty bin with its
+	 |  range and cumulative share of the samples.
+	\*------------------------------------------------------------------------*/
+
+	uint64_t Bin(unsigned int bin) { return(hist[bin]); }
+	static uint64_t LowerBound(unsigned int bin);
+	/*------------------------------------------------------------------------*\
+	 | The samples in a bin (0 <= bin < LOG_HIST_BINS), and the smallest
+	 |  value it holds.  Powers of two are always bin boundaries.
+	\*------------------------------------------------------------------------*/
+
+private:
+	uint64_t hist[LOG_HIST_BINS];
+	uint64_t samples;
+	uint64_t sum;
+	uint64_t max;
+
+	static inline unsigned int BinOf(uint64_t value)
+	{
+		unsigned int e;
+
+		if (value < LOG_HIST_EXACT)
+			return((unsigned int)value);
+		e = (63 - __builtin_clzll(value));	// >= 3
+		return(LOG_HIST_EXACT + ((e - 3) * LOG_HIST_SUB) + ((value >> (e - 2)) & (LOG_HIST_SUB - 1)));
+	}
+};
 
 #endif //HISTOGRAM_H
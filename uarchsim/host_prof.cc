@@ -0,0 +1,81 @@
+/*--------------------------------------------------------------------------*\
+ | host_prof.cc
+ |
+ | Host-time profiler.  See host_prof.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+
+#include "host_prof.h"
+
+HostProfClass host_prof;
+
+static const char* const host_prof_names[HP_REGIONS] = {
+	"retire", "writeback", "load_replay", "execute", "register_read",
+	"schedule", "dispatch", "rename2", "rename1", "decode", "fetch",
+	"predict", "cache access", "checker", "run-ahead", "htif tick"
+};
+
+HostProfClass::HostProfClass()
+{
+	period = 0;
+	countdown = 0;
+	sampling = false;
+	cycles = 0;
+	sampled = 0;
+	memset(depth, 0, sizeof(depth));
+	memset(ticks, 0, sizeof(ticks));
+	memset(calls, 0, sizeof(calls));
+	open = 0;
+	top_ticks = 0;
+	start_ticks = 0;
+	memset(&start_time, 0, sizeof(start_time));
+}
+
+void HostProfClass::Configure(unsigned int period)
+{
+	this->period = period;
+	countdown = period;
+	sampling = false;
+	start_ticks = Now();
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+}
+
+void HostProfClass::Print(FILE* fp, uint64_t insns)
+{
+	struct timespec now;
+	double seconds, ticks_per_second, scale, est, outside;
+	uint64_t total_ticks = (Now() - start_ticks);
+	unsigned int i;
+
+	if (!period)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	seconds = ((double)(now.tv_sec - start_time.tv_sec) + 1e-9 * (double)(now.tv_nsec - start_time.tv_nsec));
+	ticks_per_second = ((seconds > 0.0) ? ((double)total_ticks / seconds) : 1.0);
+	scale = (sampled ? ((double)cycles / (double)sampled) : 0.0);
+
+	fprintf(fp, "=================== HOST-TIME PROFILE ===================\n");
+	fprintf(fp, "host time:              %.2f s\n", seconds);
+	fprintf(fp, "simulated instructions: %lu (%.1f KIPS)\n", insns,
+	        ((seconds > 0.0) ? ((double)insns / seconds / 1000.0) : 0.0));
+	fprintf(fp, "timed cycles:           %lu of %lu (1 in %u)\n", sampled, cycles, period);
+	fprintf(fp, "region            est. host s   share    KIPS alone   timed calls\n");
+
+	// Only the time of the outermost regions, which do not overlap.
+	outside = ((double)total_ticks - (scale * (double)top_ticks));
+	for (i = 0; i < HP_REGIONS; i++) {
+		est = (scale * (double)ticks[i]);
+		fprintf(fp, "%-16s %12.3f %7.2f%% %12.1f %13lu\n", host_prof_names[i],
+		        (est / ticks_per_second),
+		        (total_ticks ? (100.0 * est / (double)total_ticks) : 0.0),
+		        ((est > 0.0) ? ((double)insns / (est / ticks_per_second) / 1000.0) : 0.0),
+		        calls[i]);
+	}
+	fprintf(fp, "%-16s %12.3f %7.2f%%\n", "other", (outside / ticks_per_second),
+	        (total_ticks ? (100.0 * outside / (double)total_ticks) : 0.0));
+	fprintf(fp, "(cache access, checker and run-ahead are nested in the stages, as are the\n");
+	fprintf(fp, " checker's htif ticks; other is the time outside all the regions.)\n");
+}
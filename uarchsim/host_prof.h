@@ -0,0 +1,155 @@
+#ifndef HOST_PROF_H
+#define HOST_PROF_H
+
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*--------------------------------------------------------------------------*\
+ | host_prof.h
+ |
+ | Host-time profiler (see --host-prof): where the simulator itself spends
+ |  its time.  Each pipeline stage call in step_micro() and each of the
+ |  instrumented subsystems is a region; a region's time includes the
+ |  regions nested in it (e.g., checker includes run-ahead, the stages
+ |  include cache accesses).  Recursive entries into a region (an L1
+ |  access that accesses the L2) are timed once, at the outermost entry.
+ |
+ | To keep overhead low, only one in every <period> simulated cycles is
+ |  timed, with the time-stamp counter, and the totals are scaled up by
+ |  the sampling ratio.  Outside sampled cycles a region costs one branch.
+\*--------------------------------------------------------------------------*/
+
+typedef enum {
+	HP_RETIRE,
+	HP_WRITEBACK,
+	HP_LOAD_REPLAY,
+	HP_EXECUTE,
+	HP_REGISTER_READ,
+	HP_SCHEDULE,
+	HP_DISPATCH,
+	HP_RENAME2,
+	HP_RENAME1,
+	HP_DECODE,
+	HP_FETCH,
+	HP_PREDICT,
+	HP_CACHE,		// CacheClass::Access
+	HP_CHECKER,		// pipeline_t::checker
+	HP_RUN_AHEAD,		// Functional simulator refilling the debug buffer.
+	HP_HTIF,		// htif->tick
+	HP_REGIONS
+} host_prof_region_t;
+
+class HostProfClass
+{
+public:
+	HostProfClass();
+
+	void Configure(unsigned int period);
+	/*------------------------------------------------------------------------*\
+	 | Enables the profiler, timing one in every period cycles (0 disables
+	 |  it), and starts the host clock for the whole run.
+	\*------------------------------------------------------------------------*/
+
+	inline void Cycle()
+	{
+		if (period) {
+			cycles++;
+			sampling = (--countdown == 0);
+			if (sampling) {
+				countdown = period;
+				sampled++;
+			}
+		}
+	}
+	/*------------------------------------------------------------------------*\
+	 | Called at the start of every simulated cycle.
+	\*------------------------------------------------------------------------*/
+
+	inline uint64_t Begin(host_prof_region_t r)
+	{
+		if (!sampling || depth[r])
+			return(0);
+		depth[r] = (open ? 1 : 2);
+		open++;
+		return(Now());
+	}
+
+	inline void End(host_prof_region_t r, uint64_t start)
+	{
+		if (start) {
+			uint64_t t = (Now() - start);
+			ticks[r] += t;
+			if (depth[r] == 2)
+				top_ticks += t;
+			calls[r]++;
+			depth[r] = 0;
+			open--;
+		}
+	}
+	/*------------------------------------------------------------------------*\
+	 | Bracket a region.  End() is passed Begin()'s return value.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp, uint64_t insns);
+	/*------------------------------------------------------------------------*\
+	 | Prints each region's estimated host time, its share of the run, and
+	 |  the simulated instructions per host second it alone would allow.
+	\*------------------------------------------------------------------------*/
+
+	static inline uint64_t Now()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		return(__rdtsc());
+#else
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#endif
+	}
+
+private:
+	unsigned int period;
+	unsigned int countdown;
+	bool sampling;			// Timing the current cycle.
+	uint64_t cycles;		// Cycles seen...
+	uint64_t sampled;		// ...and timed.
+
+	uint8_t depth[HP_REGIONS];	// Region is being timed: 2 if entered outside any other, else 1.
+	uint64_t ticks[HP_REGIONS];
+	uint64_t calls[HP_REGIONS];
+	unsigned int open;		// Regions being timed.
+	uint64_t top_ticks;		// Time in regions entered outside any other.
+
+	uint64_t start_ticks;		// Host clock at Configure().
+	struct timespec start_time;
+};
+
+extern HostProfClass host_prof;
+
+// Times a call, e.g. HOST_PROF_CALL(HP_FETCH, fetch()).
+#define HOST_PROF_CALL(r, call) \
+  do  {\
+    uint64_t host_prof_start_ = host_prof.Begin(r);  \
+    call;  \
+    host_prof.End(r, host_prof_start_);  \
+  } while(0)
+
+// Times the rest of the enclosing scope.
+class HostProfScope
+{
+public:
+	HostProfScope(host_prof_region_t r) : r(r), start(host_prof.Begin(r)) {}
+	~HostProfScope() { host_prof.End(r, start); }
+
+private:
+	host_prof_region_t r;
+	uint64_t start;
+};
+
+#define HOST_PROF_SCOPE(r)	HostProfScope host_prof_scope_(r)
+
+#endif //HOST_PROF_H
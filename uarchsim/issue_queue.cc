@@ -14,6 +14,11 @@ issue_queue::issue_queue(unsigned int size, unsigned int num_parts, pipeline_t*
 	assert((size % num_parts) == 0);
         this->part_size = (size/num_parts);
         this->part_next = 0;
+	this->num_parts = num_parts;
+	part_length = new unsigned int[num_parts];
+	for (unsigned int i = 0; i < num_parts; i++) {
+		part_length[i] = 0;
+	}
 
 	// Initialize the issue queue's free list.
 	fl = new unsigned int[size];
@@ -28,6 +33,8 @@ issue_queue::issue_queue(unsigned int size, unsigned int num_parts, pipeline_t*
 	oldest = -1;
 	youngest = -1;
 
+	blocked = 0;
+
   // Needed for macro
   stats = proc->get_stats();
 }
@@ -55,6 +62,7 @@ void issue_queue::dispatch(unsigned int index, unsigned long long branch_mask, u
 
 	// Dispatch the instruction into the free issue queue entry.
 	length++;
+	part_length[free / part_size]++;
 	assert(!q[free].valid);
 	q[free].valid = true;
 	q[free].index = index;
@@ -135,6 +143,8 @@ void issue_queue::select_and_issue(unsigned int num_lanes, lane* Execution_Lanes
    unsigned int dyn_lane_id;
    bool issuedThisCycle = false;
 
+   blocked = 0;
+
    // Set up the first IQ index to be examined this cycle.
    if (IDEAL_AGE_BASED) {
       if (oldest == -1) { // IQ empty, so no age-based list to sequence through.
@@ -185,6 +195,7 @@ void issue_queue::select_and_issue(unsigned int num_lanes, lane* Execution_Lanes
             Execution_Lanes[q[i].lane_id].rr.valid = true;
             Execution_Lanes[q[i].lane_id].rr.index = q[i].index;
             Execution_Lanes[q[i].lane_id].rr.branch_mask = q[i].branch_mask;
+            proc->PAY.buf[q[i].index].issue_cycle = proc->cycle;
 
             // Remove the instruction from the issue queue.
             remove(i);
@@ -192,6 +203,9 @@ void issue_queue::select_and_issue(unsigned int num_lanes, lane* Execution_Lanes
             issuedThisCycle = true;
             inc_counter(issued_inst_count);
          }
+         else {
+            blocked++;
+         }
       }
 
       if (IDEAL_AGE_BASED) {
@@ -226,6 +240,7 @@ void issue_queue::remove(unsigned int i) {
 	// Remove the instruction from the issue queue.
 	q[i].valid = false;
 	length--;
+	part_length[i / part_size]--;
 
 	// Push the issue queue entry back onto the free list.
 	fl[fl_tail] = i;
@@ -267,6 +282,9 @@ void issue_queue::remove(unsigned int i) {
 
 void issue_queue::flush() {
 	length = 0;
+	for (unsigned int i = 0; i < num_parts; i++) {
+		part_length[i] = 0;
+	}
 	for (unsigned int i = 0; i < size; i++) {
 		q[i].valid = false;
 	}
@@ -54,6 +54,8 @@ private:
  
         // Round-robin scheduling among issue queue partitions.
 	unsigned int part_size;		// size of a partition
+	unsigned int num_parts;		// number of partitions
+	unsigned int* part_length;	// Number of instructions in each partition.
         unsigned int part_next;		// which partition has priority this cycle
 
 	// Support for ideal age-based priority.
@@ -67,6 +69,8 @@ private:
 
 	void remove(unsigned int i);	// Remove the instruction in issue queue entry 'i' from the issue queue.
 
+	unsigned int blocked;		// Ready instructions that found no free Execution Lane this cycle.
+
 
 public:
 	issue_queue(unsigned int size, unsigned int num_parts, pipeline_t* _proc=NULL);	// constructor
@@ -77,6 +81,10 @@ public:
 	              bool D_valid, bool D_ready, unsigned int D_tag);
 	void wakeup(unsigned int tag);
 	void select_and_issue(unsigned int num_lanes, lane* Execution_Lanes);
+	unsigned int lane_blocked() {return(blocked);}	// Functional-unit contention in the last select_and_issue().
+	unsigned int occupancy() {return(length);}
+	unsigned int partitions() {return(num_parts);}
+	unsigned int part_occupancy(unsigned int p) {return(part_length[p]);}
 	void flush();
 	void clear_branch_bit(unsigned int branch_ID);
 	void squash(unsigned int branch_ID);
@@ -0,0 +1,122 @@
+/*--------------------------------------------------------------------------*\
+ | json_writer.cc
+ |
+ | Minimal streaming JSON writer.  See json_writer.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cmath>
+#include <cassert>
+#include <cinttypes>
+
+#include "json_writer.h"
+
+JsonWriter::JsonWriter(FILE* fp)
+	: fp(fp), depth(0)
+{
+	first[0] = true;
+}
+
+// Starts a member (or array element) at the current depth.
+void JsonWriter::Member(const char* key)
+{
+	if (depth > 0) {
+		fprintf(fp, (first[depth] ? "\n" : ",\n"));
+		fprintf(fp, "%*s", (2 * depth), "");
+	}
+	first[depth] = false;
+	if (key) {
+		Quoted(key);
+		fprintf(fp, ": ");
+	}
+}
+
+void JsonWriter::Quoted(const char* s)
+{
+	fputc('"', fp);
+	for (; *s; s++) {
+		switch (*s) {
+			case '"':  fputs("\\\"", fp); break;
+			case '\\': fputs("\\\\", fp); break;
+			case '\n': fputs("\\n", fp); break;
+			case '\t': fputs("\\t", fp); break;
+			default:
+				if ((unsigned char)*s < 0x20)
+					fprintf(fp, "\\u%04x", (unsigned char)*s);
+				else
+					fputc(*s, fp);
+				break;
+		}
+	}
+	fputc('"', fp);
+}
+
+void JsonWriter::BeginObject(const char* key)
+{
+	Member(key);
+	fputc('{', fp);
+	assert((depth + 1) < JSON_MAX_DEPTH);
+	first[++depth] = true;
+}
+
+void JsonWriter::EndObject()
+{
+	assert(depth > 0);
+	if (!first[depth--])
+		fprintf(fp, "\n%*s", (2 * depth), "");
+	fputc('}', fp);
+	if (depth == 0)
+		fputc('\n', fp);
+}
+
+void JsonWriter::BeginArray(const char* key)
+{
+	Member(key);
+	fputc('[', fp);
+	assert((depth + 1) < JSON_MAX_DEPTH);
+	first[++depth] = true;
+}
+
+void JsonWriter::EndArray()
+{
+	assert(depth > 0);
+	if (!first[depth--])
+		fprintf(fp, "\n%*s", (2 * depth), "");
+	fputc(']', fp);
+}
+
+void JsonWriter::Uint(const char* key, uint64_t value)
+{
+	Member(key);
+	fprintf(fp, "%" PRIu64, value);
+}
+
+void JsonWriter::Int(const char* key, int64_t value)
+{
+	Member(key);
+	fprintf(fp, "%" PRId64, value);
+}
+
+void JsonWriter::Double(const char* key, double value)
+{
+	Member(key);
+	if (std::isfinite(value))
+		fprintf(fp, "%.6g", value);
+	else
+		fprintf(fp, "null");
+}
+
+void JsonWriter::Bool(const char* key, bool value)
+{
+	Member(key);
+	fprintf(fp, (value ? "true" : "false"));
+}
+
+void JsonWriter::String(const char* key, const char* value)
+{
+	Member(key);
+	if (value)
+		Quoted(value);
+	else
+		fprintf(fp, "null");
+}
@@ -0,0 +1,43 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdio>
+#include <cstdint>
+
+/*--------------------------------------------------------------------------*\
+ | json_writer.h
+ |
+ | Minimal streaming JSON writer for the structured stats (--stats=json).
+ |  Members are written in order; the writer tracks nesting to place
+ |  commas and indentation.  Every member of an object has a key; array
+ |  elements are written with a NULL key.
+\*--------------------------------------------------------------------------*/
+
+#define JSON_MAX_DEPTH	16
+
+class JsonWriter
+{
+public:
+	JsonWriter(FILE* fp);
+
+	void BeginObject(const char* key = NULL);
+	void EndObject();
+	void BeginArray(const char* key = NULL);
+	void EndArray();
+
+	void Uint(const char* key, uint64_t value);
+	void Int(const char* key, int64_t value);
+	void Double(const char* key, double value);
+	void Bool(const char* key, bool value);
+	void String(const char* key, const char* value);	// NULL is written as null.
+
+private:
+	FILE* fp;
+	unsigned int depth;
+	bool first[JSON_MAX_DEPTH];	// No member written yet at this depth.
+
+	void Member(const char* key);
+	void Quoted(const char* s);
+};
+
+#endif //JSON_WRITER_H
@@ -0,0 +1,143 @@
+#ifndef KEYED_TABLE_H
+#define KEYED_TABLE_H
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+/*--------------------------------------------------------------------------*\
+ | keyed_table.h
+ |
+ | Open-addressing hash table of profile records keyed by a uint64_t (a PC,
+ |  or a line or region address), shared by the profilers: the per-PC
+ |  profile (stats.h), the miss profile (miss_prof.h) and the reuse-
+ |  distance stacks (reuse_dist.h).
+ |
+ | T is a plain struct, zeroed when inserted, and Key is its key field;
+ |  KEYED_TABLE_EMPTY is not a valid key.  Linear probing; the table
+ |  doubles when half full, which moves the records, so a pointer returned
+ |  by Get() is only valid until the next insertion.
+\*--------------------------------------------------------------------------*/
+
+#define KEYED_TABLE_EMPTY	(~0ULL)
+
+template <typename T, uint64_t T::*Key>
+class KeyedTable
+{
+public:
+	KeyedTable(size_t size = 1024);
+	/*------------------------------------------------------------------------*\
+	 | Creates an empty table of size slots (a power of 2).
+	\*------------------------------------------------------------------------*/
+
+	~KeyedTable() { delete [] t; }
+
+	T* Get(uint64_t key, bool* inserted = NULL);
+	/*------------------------------------------------------------------------*\
+	 | Returns the record of key, inserting a zeroed one if there is none.
+	 |  If inserted is not NULL, it is set to whether the record is new.
+	\*------------------------------------------------------------------------*/
+
+	size_t Used() { return(used); }
+	size_t Size() { return(size); }
+	T* Slot(size_t i) { return((t[i].*Key == KEYED_TABLE_EMPTY) ? NULL : &t[i]); }
+	/*------------------------------------------------------------------------*\
+	 | Iteration: the record in slot i (0 <= i < Size()), or NULL.
+	\*------------------------------------------------------------------------*/
+
+	template <typename Pred, typename Less>
+	std::vector<T*> Select(Pred pred, Less less);
+	/*------------------------------------------------------------------------*\
+	 | Returns the records satisfying pred, sorted by less.
+	\*------------------------------------------------------------------------*/
+
+private:
+	T* t;
+	size_t size;
+	size_t used;
+
+	size_t Hash(uint64_t key) { return((size_t)((key * 0x9e3779b97f4a7c15ULL) >> 32) & (size - 1)); }
+	static T* Alloc(size_t n);
+	void Grow();
+};
+
+template <typename T, uint64_t T::*Key>
+KeyedTable<T, Key>::KeyedTable(size_t size)
+	: size(size), used(0)
+{
+	assert(size && !(size & (size - 1)));
+	t = Alloc(size);
+}
+
+template <typename T, uint64_t T::*Key>
+T* KeyedTable<T, Key>::Alloc(size_t n)
+{
+	T* a = new T[n];
+
+	for (size_t i = 0; i < n; i++)
+		a[i].*Key = KEYED_TABLE_EMPTY;
+	return(a);
+}
+
+template <typename T, uint64_t T::*Key>
+void KeyedTable<T, Key>::Grow()
+{
+	T* old = t;
+	size_t old_size = size;
+
+	size *= 2;
+	t = Alloc(size);
+	for (size_t i = 0; i < old_size; i++) {
+		if (old[i].*Key != KEYED_TABLE_EMPTY) {
+			size_t j = Hash(old[i].*Key);
+			while (t[j].*Key != KEYED_TABLE_EMPTY)
+				j = ((j + 1) & (size - 1));
+			t[j] = old[i];
+		}
+	}
+	delete [] old;
+}
+
+template <typename T, uint64_t T::*Key>
+T* KeyedTable<T, Key>::Get(uint64_t key, bool* inserted)
+{
+	size_t i = Hash(key);
+
+	assert(key != KEYED_TABLE_EMPTY);
+	if (inserted)
+		*inserted = false;
+	while (t[i].*Key != key) {
+		if (t[i].*Key == KEYED_TABLE_EMPTY) {
+			// Insert.
+			if ((2 * (used + 1)) > size) {
+				Grow();
+				return(Get(key, inserted));
+			}
+			memset(&t[i], 0, sizeof(T));
+			t[i].*Key = key;
+			used++;
+			if (inserted)
+				*inserted = true;
+			break;
+		}
+		i = ((i + 1) & (size - 1));
+	}
+	return(&t[i]);
+}
+
+template <typename T, uint64_t T::*Key>
+template <typename Pred, typename Less>
+std::vector<T*> KeyedTable<T, Key>::Select(Pred pred, Less less)
+{
+	std::vector<T*> v;
+
+	for (size_t i = 0; i < size; i++)
+		if ((t[i].*Key != KEYED_TABLE_EMPTY) && pred(&t[i]))
+			v.push_back(&t[i]);
+	std::sort(v.begin(), v.end(), less);
+	return(v);
+}
+
+#endif //KEYED_TABLE_H
@@ -41,7 +41,9 @@ bool lsu::disambiguate(unsigned int lq_index,
 			mask = (~(max_size - 1));
 
 			if (!SQ[store_entry].addr_avail) {
-				stall = LQ[lq_index].mdp_stall;  // stall (if prediction says to): possible conflict
+				// stall (if prediction says to): possible conflict
+				stall = (LQ[lq_index].mdp_stall &&
+				         ((LQ[lq_index].mdp_store == MDP_ALL_STORES) || (LQ[lq_index].mdp_store == (int)store_entry)));
 			}
 			else if ((SQ[store_entry].addr & mask) ==
 			         (LQ[lq_index].addr    & mask)) {
@@ -113,7 +115,9 @@ lsu::lsu(unsigned int lq_size, unsigned int sq_size, unsigned int Tid, mmu_t* _m
           	            L1_DC_MISS_SRV_LATENCY,
                         _proc,
                         "l1_dc",
-                        _proc->L2C);
+                        _proc->L2C,
+                        L1_DC_REPL,
+                        L1_DC_PREFETCHER);
 
 	// LQ initialization.
 	this->lq_size = lq_size;
@@ -162,6 +166,14 @@ bool lsu::stall(unsigned int bundle_load, unsigned int bundle_store) {
 	return( load_stall || store_stall );
 }
 
+bool lsu::head_load_missed(bool& l2_missed) {
+   l2_missed = false;
+   if ((lq_length == 0) || LQ[lq_head].value_avail || !LQ[lq_head].missed)
+      return(false);
+   l2_missed = LQ[lq_head].l2_missed;
+   return(true);
+}
+
 
 void lsu::dispatch(bool load,
                    unsigned int size,
@@ -171,7 +183,7 @@ void lsu::dispatch(bool load,
                    unsigned int pay_index,
                    unsigned int& lq_index, bool& lq_index_phase,
                    unsigned int& sq_index, bool& sq_index_phase,
-                   bool mdp_stall) {
+                   bool mdp_stall, int mdp_store) {
 	// Assign indices to the load or store.
 	lq_index = lq_tail;
 	lq_index_phase = lq_tail_phase;
@@ -191,12 +203,14 @@ void lsu::dispatch(bool load,
 		LQ[lq_tail].addr_avail = false;
 		LQ[lq_tail].value_avail = false;
 		LQ[lq_tail].missed = false;
+		LQ[lq_tail].l2_missed = false;
 
 		LQ[lq_tail].pay_index = pay_index;
 		LQ[lq_tail].sq_index = sq_index;
 		LQ[lq_tail].sq_index_phase = sq_index_phase;
 
                 LQ[lq_tail].mdp_stall = mdp_stall;
+                LQ[lq_tail].mdp_store = mdp_store;
 
 		// STATS
 		LQ[lq_tail].stat_load_stall_disambig = false;
@@ -231,6 +245,7 @@ void lsu::dispatch(bool load,
 		SQ[sq_tail].addr_avail = false;
 		SQ[sq_tail].value_avail = false;
 		SQ[sq_tail].missed = false;
+		SQ[sq_tail].l2_missed = false;
 
 		SQ[sq_tail].pay_index = pay_index;
 
@@ -292,17 +307,26 @@ void lsu::store_addr(cycle_t cycle,
       unsigned int al_index;
       if (ld_violation(sq_index, lq_index, lq_index_phase, load_entry)) {
          al_index = proc->PAY.buf[LQ[load_entry].pay_index].AL_index;
+         proc->PAY.buf[LQ[load_entry].pay_index].viol_store_pc = proc->PAY.buf[SQ[sq_index].pay_index].pc;
          proc->set_load_violation(al_index);
       }
    }
 
+   // Loads in the store's set need no longer wait for it.
+   if (proc->MDP)
+      proc->MDP->StoreIssued(proc->PAY.buf[SQ[sq_index].pay_index].pc, sq_index);
+
    if (!PERFECT_DCACHE) {
       bool hit;
-      SQ[sq_index].miss_resolve_cycle = DC->Access(Tid, cycle, addr, true, &hit);
+      SQ[sq_index].miss_resolve_cycle = DC->Access(Tid, cycle, addr, true, &hit, false, true,
+                                                   proc->PAY.buf[SQ[sq_index].pay_index].pc);
       SQ[sq_index].missed = !hit;
+      SQ[sq_index].l2_missed = (!hit && DC->NextLevelMissed());
 
       if (!hit) inc_counter(spec_store_miss_count);
       if (SQ[sq_index].miss_resolve_cycle == -1) inc_counter(store_mhsr_miss_count);
+      if (proc->MP)
+         profile_miss(cycle, SQ[sq_index]);
    }
 
 #ifdef RISCV_MICRO_DEBUG
@@ -320,6 +344,14 @@ void lsu::store_value(unsigned int sq_index, reg_t value) {
 }
 
 
+// Records a D$ access by a load or store in the delinquent-load profile.
+void lsu::profile_miss(cycle_t cycle, lsq_entry& e) {
+   bool full = (e.miss_resolve_cycle == (cycle_t)-1);
+   proc->MP->Access(proc->PAY.buf[e.pay_index].pc, e.addr, full, (!full && e.missed), (!full && e.l2_missed),
+                    ((!full && e.missed) ? (e.miss_resolve_cycle - cycle) : 0),
+                    ((!full && e.missed) ? DC->BusyMHSRs(cycle) : 0));
+}
+
 bool lsu::load_addr(cycle_t cycle,
                     reg_t addr,
                     unsigned int lq_index,
@@ -331,6 +363,7 @@ bool lsu::load_addr(cycle_t cycle,
 	// Set up information for executing the load.
 	LQ[lq_index].addr_avail = true;
 	LQ[lq_index].addr = addr;
+	LQ[lq_index].addr_cycle = cycle;
 	//LQ[lq_index].back_data = back_data;
 
   #ifdef RISCV_MICRO_DEBUG
@@ -340,14 +373,18 @@ bool lsu::load_addr(cycle_t cycle,
 
 	if (!PERFECT_DCACHE) {
 		bool hit;
-		LQ[lq_index].miss_resolve_cycle = DC->Access(Tid, cycle, addr, false, &hit);
+		LQ[lq_index].miss_resolve_cycle = DC->Access(Tid, cycle, addr, false, &hit, false, true,
+		                                             proc->PAY.buf[LQ[lq_index].pay_index].pc);
 		LQ[lq_index].missed = !hit;
+		LQ[lq_index].l2_missed = (!hit && DC->NextLevelMissed());
     if(!hit){
       inc_counter(spec_load_miss_count);
     }
     if(LQ[lq_index].miss_resolve_cycle == -1){
       inc_counter(load_mhsr_miss_count);
     }
+    if (proc->MP)
+      profile_miss(cycle, LQ[lq_index]);
 
 	}
 
@@ -370,8 +407,12 @@ bool lsu::load_unstall(cycle_t cycle, unsigned int& pay_index, reg_t& value) {
          if (!PERFECT_DCACHE && (LQ[scan].miss_resolve_cycle == -1)) {
             bool hit;
             assert(LQ[scan].addr_avail);
-            LQ[scan].miss_resolve_cycle = DC->Access(Tid, cycle, LQ[scan].addr, false, &hit);
+            LQ[scan].miss_resolve_cycle = DC->Access(Tid, cycle, LQ[scan].addr, false, &hit, false, true,
+                                                     proc->PAY.buf[LQ[scan].pay_index].pc);
             LQ[scan].missed = !hit;
+            LQ[scan].l2_missed = (!hit && DC->NextLevelMissed());
+            if (proc->MP)
+               profile_miss(cycle, LQ[scan]);
          }
 
          // Check if load is unstalled.
@@ -415,6 +456,10 @@ void lsu::execute_load(cycle_t cycle,
 		// STATS
 		LQ[lq_index].stat_forward = true;
 
+		// Critical-path analysis: the load depends on the store.
+		if (proc->CP)
+			proc->PAY.buf[LQ[lq_index].pay_index].mem_producer = proc->PAY.buf[SQ[store_entry].pay_index].sequence;
+
 		// Forward the data from the store entry.
 		switch (LQ[lq_index].size) {
 			case 1:
@@ -535,6 +580,8 @@ void lsu::execute_load(cycle_t cycle,
 		LQ[lq_index].stat_load_stall_miss = true;
 	}
 
+	if (LQ[lq_index].value_avail)
+		load_to_use.Increment(cycle - LQ[lq_index].addr_cycle);
 }
 
 
@@ -629,6 +676,13 @@ bool lsu::commit(bool load, bool atomic_op, bool& atomic_success) {
       if (LQ[lq_head].missed) {
          inc_counter(load_miss_count);
       }
+      if (proc->get_histogram()) {
+         pc_profile_t* p = stats->get_pc_profile(proc->PAY.buf[LQ[lq_head].pay_index].pc);
+         p->l1d_misses += LQ[lq_head].missed;
+         p->l2_misses += LQ[lq_head].l2_missed;
+         p->forwards += LQ[lq_head].stat_forward;
+         p->disambig_stalls += LQ[lq_head].stat_load_stall_disambig;
+      }
 
       // Invalidate the entry.
       LQ[lq_head].valid = false;
@@ -693,6 +747,11 @@ bool lsu::commit(bool load, bool atomic_op, bool& atomic_success) {
       if (SQ[sq_head].missed) {
          inc_counter(store_miss_count);
       }
+      if (proc->get_histogram()) {
+         pc_profile_t* p = stats->get_pc_profile(proc->PAY.buf[SQ[sq_head].pay_index].pc);
+         p->l1d_misses += SQ[sq_head].missed;
+         p->l2_misses += SQ[sq_head].l2_missed;
+      }
 
       // Invalidate the entry.
       SQ[sq_head].valid = false;
@@ -733,6 +792,19 @@ void lsu::flush() {
 	for (unsigned int i = 0; i < sq_size; i++) {
 		SQ[i].valid = false;
 	}
+
+	if (proc->MDP)
+		proc->MDP->Flush();
+}
+
+// Functional warming of the D$ by a committed load or store.
+void lsu::warm(reg_t addr, bool store, reg_t pc) {
+	if (!PERFECT_DCACHE)
+		DC->Warm(Tid, addr, store, pc);
+}
+
+void lsu::dump_cache_stats(FILE* fp) {
+	DC->dump_stats(fp);
 }
 
 
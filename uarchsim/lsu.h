@@ -7,6 +7,9 @@
 // 3. Committed memory state.
 ///////////////////////////////////////////////////////////////
 //#include "CcacheClass.h"
+#include "histogram.h"
+
+#define MDP_ALL_STORES	(-1)
 
 // Single entry in the load-store queue.
 typedef struct {
@@ -25,7 +28,9 @@ typedef struct {
   reg_t value;  // value (up to two words)
 
   bool missed;        // The memory block referenced by load or store is not in cache.
+  bool l2_missed;     // ...nor in the next level.
   cycle_t miss_resolve_cycle; // Cycle when referenced memory block will be in cache.
+  cycle_t addr_cycle;         // Cycle when the load's address became available.
 
   // These three fields are needed for replaying stalled loads.
   unsigned int pay_index; // Index into PAY buffer.
@@ -35,7 +40,10 @@ typedef struct {
   // Dynamic loads may be classed as "stall type" or "speculate type",
   // based on whether or not speculative memory disambiguation is enabled
   // and a prediction from the memory dependence predictor (MDP).
+  // A stall type load waits for the unknown addresses of all prior stores
+  // (mdp_store == MDP_ALL_STORES), or only for the store at SQ index mdp_store.
   bool mdp_stall;
+  int mdp_store;
 
   // STATS
   bool stat_load_stall_disambig;  // Load stalled due to unknown store address and/or value.
@@ -111,10 +119,15 @@ private:
   unsigned int n_load;
   unsigned int n_store;
 
+  // Cycles from each load's address to its value being available.
+  LogHistogramClass load_to_use;
+
   //////////////////////////
   //  Private functions
   //////////////////////////
 
+  void profile_miss(cycle_t cycle, lsq_entry& e);
+
   // The core disambiguation algorithm.
   //
   // Inputs:
@@ -153,11 +166,15 @@ public:
 
   bool stall(unsigned int bundle_load, unsigned int bundle_store);
 
+  // Returns true if the oldest load is waiting for a D$ miss;
+  // l2_missed is set if it also missed in the L2$.
+  bool head_load_missed(bool& l2_missed);
+
   void dispatch(bool load, unsigned int size, bool left, bool right, bool is_signed,
                 unsigned int pay_index,
                 unsigned int& lq_index, bool& lq_index_phase,
                 unsigned int& sq_index, bool& sq_index_phase,
-		bool mdp_stall);
+		bool mdp_stall, int mdp_store);
 
   void store_addr(cycle_t cycle,
                   reg_t addr,
@@ -182,11 +199,22 @@ public:
 
   void flush();
 
+  void warm(reg_t addr, bool store, reg_t pc);
+
+  void dump_cache_stats(FILE* fp);
+  CacheClass* get_dcache() {return DC;}
+
+  // Occupancy histograms.
+  unsigned int lq_occupancy() {return lq_length;}
+  unsigned int sq_occupancy() {return sq_length;}
+  LogHistogramClass& load_to_use_latency() {return load_to_use;}
+
   void copy_mem(char** master_mem_table);
 
   // STATS
   void set_stats(stats_t* _stats){this->stats = _stats;}
   void dump_stats(FILE* fp);
+  unsigned int get_load_miss_count(){return n_stall_miss_l;}
 
   void dump_lq(pipeline_t* proc, unsigned int index,FILE* file=stderr);
   void dump_sq(pipeline_t* proc, unsigned int index,FILE* file=stderr);
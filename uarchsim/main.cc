@@ -8,6 +8,7 @@
 #include <fesvr/option_parser.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <getopt.h>
 #include <vector>
 #include <string>
@@ -15,7 +16,17 @@
 #include <algorithm>
 #include "debug.h"
 #include "parameters.h"
+#include "replacement.h"
+#include "prefetch.h"
+#include "bpred_interface.h"
+#include "value_pred.h"
+#include "host_prof.h"
+#include "pipeline.h"
 #include <signal.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
 
 static void help()
 {
@@ -24,19 +35,36 @@ static void help()
   fprintf(stderr, "  -c<gz_chkpt_file>  Start simulation from a .gz checkpoint file.\n");
   fprintf(stderr, "  -d                 Interactive debug mode\n");
   fprintf(stderr, "  -e<n>              End simulation after <n> instructions have been committed by microarchitectural simulation\n");
-  fprintf(stderr, "  -g                 Track histogram of PCs\n");
+  fprintf(stderr, "  -g                 Track histogram of PCs: per-PC profile of retired instructions\n");
+  fprintf(stderr, "  --profile=<n>[,<file>]\tPer-PC profile (implies -g): print the top <n> PCs; dump all PCs to binary <file>\n");
+  fprintf(stderr, "  --miss-prof=<n>[,<r>[,<file>]]\tDelinquent loads: print the top <n> load/store PCs and <r>-byte regions (default 4096) by D$ misses; dump a cache-line heat map to binary <file>\n");
+  fprintf(stderr, "  --critical-path=<n>\tCritical-path analysis: break the path through each window of <n> retired instructions down by edge type (fetch, data, memory, branch, serialize, resource)\n");
+  fprintf(stderr, "  --reuse-dist=<n>[,<l>...]\tReuse-distance profile of committed fetches, loads and stores, sampling 1/<n> of the lines (1: exact), for line sizes <l> (default: the cache line sizes); miss-ratio curves go to the stats log and mrc.<name>.csv\n");
+  fprintf(stderr, "  --host-prof=<n>    Profile the simulator's host time per stage and subsystem, timing one in every <n> cycles\n");
+  fprintf(stderr, "  --heartbeat=<s>    Every <s> host seconds, report KIPS, ETA and memory use, and write partial stats to <stats file>.partial\n");
+  fprintf(stderr, "  --name=<name>      Name the logs <x>.<name>.log (default: run-<hash of the command line>)\n");
+  fprintf(stderr, "  --stats=<fmt>      Stats format: text, or json to add stats.<name>.json and replace the text phases with phase.<name>.bin\n");
   fprintf(stderr, "  -h                 Print this help message\n");
   fprintf(stderr, "  -l<n>              Enable logging after <n> commits if compiled with support\n");
   fprintf(stderr, "  -m<n>              Provide <n> MB of target memory\n");
   fprintf(stderr, "  -p<n>              Simulate <n> processors\n");
   fprintf(stderr, "  -s<n>              Fast skip <n> instructions before microarchitectural simulation\n");
+  fprintf(stderr, "  --warm             Functionally warm the caches and branch predictor while fast skipping\n");
+  fprintf(stderr, "  --sample=<P>,<W>,<U>\tPeriodic sampling: every <P> instructions, simulate <W> warm-up and <U> measured instructions in detail, functionally warm the rest\n");
+  fprintf(stderr, "  --sweep=<file>     Restore/skip once, then fork one simulation per line of <file>, each line holding options that override this configuration; logs are named <name>.sweep.<i>, and the --profile and --miss-prof files get the suffix .<name>.sweep.<i>\n");
+  fprintf(stderr, "  --fork=<n>         Run --sample windows or --sweep configurations in up to <n> parallel child processes\n");
   fprintf(stderr, "  --perf=<pbp>,<pdc>,<pic>,<ptc>\tEach of pbp (perf. branch pred.), pdc (perf. D$), pic (perf. I$), and ptc (perf. T$), are 0 or 1\n");
   fprintf(stderr, "  --cp=<n>           <n> branch checkpoints for mispredict recovery\n");
   fprintf(stderr, "  --btb=<n>          BTB has <n> entries\n");
   fprintf(stderr, "  --ctiq=<n>         CTIQ / BranchQ has <n> entries\n");
   fprintf(stderr, "  --bp=<n>           Brach Counter Table has <n> entries\n");
   fprintf(stderr, "  --ras=<n>          RAS has <n> entries\n");
+  fprintf(stderr, "  --bpred=<c>[,<i>]  Conditional branch predictor <c> is gshare or tage-sc-l; indirect target predictor <i> is btb or ittage\n");
+  fprintf(stderr, "  --shadow-bp=<bp>,<btb>,<ras>[,<c>[,<i>]]\tAdd a shadow branch predictor, trained on the retired branches, with <bp> direction table, <btb> BTB and <ras> RAS entries and predictors <c> and <i> (as --bpred); repeatable\n");
   fprintf(stderr, "  --fq=<n>           Fetch queue has <n> entries\n");
+  fprintf(stderr, "  --ftq=<n>[,<p>]    Decoupled front-end: fetch target queue has <n> fetch blocks (0: coupled fetch); <p> I$ prefetches per cycle from it\n");
+  fprintf(stderr, "  --uc=<s>,<a>[,<b>] Decoded-uop (trace) cache with <s> sets of <a> traces, each up to fetch width instructions in <b> basic blocks\n");
+  fprintf(stderr, "  --lb=<n>           Loop buffer supplies loops of up to <n> instructions\n");
   fprintf(stderr, "  --al=<n>           Active List has <n> entries\n");
   fprintf(stderr, "  --iq=<n>           Issue Queue has <n> entries\n");
   fprintf(stderr, "  --iqnp=<n>         Issue Queue has <n> partitions for round-robin partition-based priority adjustment\n");
@@ -44,6 +72,8 @@ static void help()
   fprintf(stderr, "  -b                 Enable ideal age-based scheduling (override position-based scheduling)\n");
   fprintf(stderr, "  --lsq=<n>          Load/Store Queue has <n> entries\n");
   fprintf(stderr, "  --disambig=<oracle>,<spec>,<mdp>\tEach of <oracle> (oracle memory disambig.), <spec> (speculative memory disambig.), and <mdp> (mem. dep. predictor), are 0 or 1\n");
+  fprintf(stderr, "  --vp=<p>[,<n>]     Value predictor <p> (none, lvp, stride, or vtage) for loads and integer ALU instructions, with <n>-entry tables\n");
+  fprintf(stderr, "  --mdp=<ssit>,<lfst>[,<clear>]\tStore-set mem. dep. predictor has <ssit> SSIT and <lfst> LFST entries; SSIT cleared every <clear> cycles\n");
   fprintf(stderr, "  --fw=<n>           <n> wide fetch\n");
   fprintf(stderr, "  --dw=<n>           <n> wide dispatch\n");
   fprintf(stderr, "  --iw=<n>           <n> wide issue / <n> execution lanes\n");
@@ -55,6 +85,8 @@ static void help()
   fprintf(stderr, "  --ic=<S>:<W>:<B>   Instantiate a cache model with S sets,\n");
   fprintf(stderr, "  --dc=<S>:<W>:<B>   W ways, and B-byte blocks (with S and\n");
   fprintf(stderr, "  --l2=<S>:<W>:<B>   B both powers of 2).\n");
+  fprintf(stderr, "  --pf=<dc>,<l2>[,<d>]\tPrefetcher of the L1 D$ and L2$: each is none, nextline, stride or stream; <d> lines are prefetched per trigger\n");
+  fprintf(stderr, "  --repl=<ic>,<dc>,<l2>\tReplacement policy of the L1 I$, L1 D$ and L2$: each is lru, plru, srrip, brrip, drrip or ship\n");
   fprintf(stderr, "  --extension=<name> Specify RoCC Extension\n");
   fprintf(stderr, "  --extlib=<name>    Shared library to load\n");
   exit(1);
@@ -156,6 +188,243 @@ static void set_disambig_flags(const char* config) {
    }
 }
 
+static void set_mdp(const char* config) {
+   unsigned int ssit, lfst;
+   uint64_t clear = MDP_CLEAR_INTERVAL;
+   if ((sscanf(config, "%u,%u,%lu", &ssit, &lfst, &clear) < 2) ||
+       (ssit == 0) || (ssit & (ssit - 1)) || (lfst == 0) || (lfst > 65536)) {
+      fprintf(stderr, "Incorrect usage of --mdp=<ssit>,<lfst>[,<clear>]\n");
+      fprintf(stderr, "...where ssit (store set ID table entries) is a power of 2, lfst (last fetched store table entries) is 1 to 65536, and clear is the number of cycles between SSIT clears (0: never).\n");
+      exit(-1);
+   }
+   else {
+      MDP_SSIT_SIZE = ssit;
+      MDP_LFST_SIZE = lfst;
+      MDP_CLEAR_INTERVAL = clear;
+   }
+}
+
+static void set_vp(const char* config) {
+   char name[16];
+   unsigned int size = VP_TABLE_SIZE;
+   if ((sscanf(config, "%15[^,],%u", name, &size) < 1) || !ValuePredClass::Exists(name) ||
+       (size < 64) || (size & (size - 1))) {
+      fprintf(stderr, "Incorrect usage of --vp=<p>[,<n>]\n");
+      fprintf(stderr, "...where p (value predictor) is none, lvp, stride, or vtage, and n (table entries) is a power of 2, at least 64.\n");
+      exit(-1);
+   }
+   else {
+      VALUE_PRED = strdup(name);
+      VP_TABLE_SIZE = size;
+   }
+}
+
+static void set_profile(const char* config) {
+   char file[256];
+   int n = sscanf(config, "%u,%255s", &PC_PROFILE_TOP, file);
+   if (n < 1) {
+      fprintf(stderr, "Incorrect usage of --profile=<n>[,<file>]\n");
+      fprintf(stderr, "...where n is the number of PCs printed, and file receives the binary profile of all PCs.\n");
+      exit(-1);
+   }
+   else if (n == 2) {
+      PC_PROFILE_FILE = strdup(file);
+   }
+}
+
+static void set_miss_prof(const char* config) {
+   char file[256];
+   unsigned int region = MISS_PROF_REGION;
+   int n = sscanf(config, "%u,%u,%255s", &MISS_PROF_TOP, &region, file);
+   if ((n < 1) || (MISS_PROF_TOP == 0) || (region < 64) || (region & (region - 1))) {
+      fprintf(stderr, "Incorrect usage of --miss-prof=<n>[,<r>[,<file>]]\n");
+      fprintf(stderr, "...where n (> 0) PCs and regions are printed, r is the region size in bytes (a power of 2, at least 64), and file receives the binary cache-line heat map.\n");
+      exit(-1);
+   }
+   MISS_PROF_REGION = region;
+   if (n == 3)
+      MISS_PROF_FILE = strdup(file);
+}
+
+static void set_critical_path(const char* config) {
+   if ((sscanf(config, "%u", &CRIT_PATH_WINDOW) != 1) || (CRIT_PATH_WINDOW == 0)) {
+      fprintf(stderr, "Incorrect usage of --critical-path=<n>\n");
+      fprintf(stderr, "...where n (> 0) is the number of retired instructions per analysis window.\n");
+      exit(-1);
+   }
+}
+
+static void set_reuse_dist(const char* config) {
+   char buf[256];
+   char* tok;
+   unsigned int line;
+   bool ok;
+
+   strncpy(buf, config, sizeof(buf) - 1);
+   buf[sizeof(buf) - 1] = '\0';
+   tok = strtok(buf, ",");
+   ok = (tok && (sscanf(tok, "%u", &REUSE_DIST_SAMPLING) == 1) && (REUSE_DIST_SAMPLING > 0));
+   REUSE_DIST_NUM_LINES = 0;
+   while (ok && (tok = strtok(NULL, ","))) {
+      ok = ((sscanf(tok, "%u", &line) == 1) && (line >= 4) && !(line & (line - 1)) && (REUSE_DIST_NUM_LINES < REUSE_DIST_MAX_LINES));
+      if (ok) {
+         for (REUSE_DIST_LINES[REUSE_DIST_NUM_LINES] = 0; (1U << REUSE_DIST_LINES[REUSE_DIST_NUM_LINES]) < line; REUSE_DIST_LINES[REUSE_DIST_NUM_LINES]++)
+            ;
+         REUSE_DIST_NUM_LINES++;
+      }
+   }
+   if (!ok) {
+      fprintf(stderr, "Incorrect usage of --reuse-dist=<n>[,<l>...]\n");
+      fprintf(stderr, "...where 1/n (n > 0) of the lines are sampled, and each l is a line size in bytes (a power of 2, at least 4; up to %u sizes).\n", REUSE_DIST_MAX_LINES);
+      exit(-1);
+   }
+}
+
+static void set_host_prof(const char* config) {
+   if ((sscanf(config, "%u", &HOST_PROF_PERIOD) != 1) || (HOST_PROF_PERIOD == 0)) {
+      fprintf(stderr, "Incorrect usage of --host-prof=<n>\n");
+      fprintf(stderr, "...where one in every n cycles (n > 0) is timed.\n");
+      exit(-1);
+   }
+}
+
+static void set_heartbeat(const char* config) {
+   if ((sscanf(config, "%u", &HEARTBEAT_INTERVAL) != 1) || (HEARTBEAT_INTERVAL == 0)) {
+      fprintf(stderr, "Incorrect usage of --heartbeat=<s>\n");
+      fprintf(stderr, "...where s is the interval in host seconds (s > 0).\n");
+      exit(-1);
+   }
+}
+
+static void set_stats(const char* config) {
+   if (!strcmp(config, "text"))
+      structured_stats = false;
+   else if (!strcmp(config, "json"))
+      structured_stats = true;
+   else {
+      fprintf(stderr, "Incorrect usage of --stats=<fmt>\n");
+      fprintf(stderr, "...where fmt is text or json.\n");
+      exit(-1);
+   }
+}
+
+// Default log name: a hash (64-bit FNV-1a) of the command line, so that
+// reruns of the same command overwrite, rather than accumulate, their logs.
+static const char* default_log_name(int argc, char** argv) {
+   uint64_t h = 0xcbf29ce484222325ULL;
+   for (int i = 1; i < argc; i++) {
+      for (const char* p = argv[i]; ; p++) {
+         h = ((h ^ (unsigned char)*p) * 0x100000001b3ULL);
+         if (!*p)
+            break;
+      }
+   }
+   char name[32];
+   sprintf(name, "run-%016lx", h);
+   return strdup(name);
+}
+
+static void set_bpred(const char* config) {
+   char cond[16], ind[16] = "btb";
+   if ((sscanf(config, "%15[^,],%15s", cond, ind) < 1) ||
+       (strcmp(cond, "gshare") && strcmp(cond, "tage-sc-l")) ||
+       (strcmp(ind, "btb") && strcmp(ind, "ittage"))) {
+      fprintf(stderr, "Incorrect usage of --bpred=<c>[,<i>]\n");
+      fprintf(stderr, "...where c (conditional branches) is gshare or tage-sc-l, and i (indirect jumps) is btb or ittage.\n");
+      exit(-1);
+   }
+   else {
+      BP_COND = strdup(cond);
+      BP_INDIRECT = strdup(ind);
+   }
+}
+
+static void set_shadow_bp(const char* config) {
+   bpred_config_t c;
+   if ((NUM_SHADOW_BP >= MAX_SHADOW_BP) || !bpred_interface::parse_config(config, &c)) {
+      fprintf(stderr, "Incorrect usage of --shadow-bp=<bp>,<btb>,<ras>[,<c>[,<i>]]\n");
+      fprintf(stderr, "...where bp (direction table entries) and btb (BTB entries) are powers of 2, ras (RAS entries) is non-zero, c is gshare or tage-sc-l, and i is btb or ittage; at most %d shadow predictors.\n", MAX_SHADOW_BP);
+      exit(-1);
+   }
+   else {
+      SHADOW_BP[NUM_SHADOW_BP++] = strdup(config);
+   }
+}
+
+static void set_ftq(const char* config) {
+   unsigned int size, prefetches = FTQ_PREFETCHES;
+   if (sscanf(config, "%u,%u", &size, &prefetches) < 1) {
+      fprintf(stderr, "Incorrect usage of --ftq=<n>[,<p>]\n");
+      fprintf(stderr, "...where n is the number of fetch blocks in the fetch target queue (0 disables the decoupled front-end), and p is the number of I$ prefetches issued from it per cycle.\n");
+      exit(-1);
+   }
+   else {
+      FTQ_SIZE = size;
+      FTQ_PREFETCHES = prefetches;
+   }
+}
+
+static void set_uop_cache(const char* config) {
+   unsigned int sets, assoc, blocks = UOP_CACHE_BLOCKS;
+   if ((sscanf(config, "%u,%u,%u", &sets, &assoc, &blocks) < 2) ||
+       (sets && ((sets & (sets - 1)) || (assoc == 0) || (blocks == 0)))) {
+      fprintf(stderr, "Incorrect usage of --uc=<s>,<a>[,<b>]\n");
+      fprintf(stderr, "...where s (sets) is 0 (no uop cache) or a power of 2, a (ways) is non-zero, and b (basic blocks per trace) is non-zero.\n");
+      exit(-1);
+   }
+   else {
+      UOP_CACHE_SETS = sets;
+      UOP_CACHE_ASSOC = assoc;
+      UOP_CACHE_BLOCKS = blocks;
+   }
+}
+
+static void set_repl_policies(const char* config) {
+   char ic[16], dc[16], l2[16];
+   if ((sscanf(config, "%15[^,],%15[^,],%15s", ic, dc, l2) != 3) ||
+       !ReplacementClass::Exists(ic) || !ReplacementClass::Exists(dc) || !ReplacementClass::Exists(l2)) {
+      fprintf(stderr, "Incorrect usage of --repl=<ic>,<dc>,<l2>\n");
+      fprintf(stderr, "...where each of ic (L1 I$), dc (L1 D$), and l2 (L2$) is lru, plru, srrip, brrip, drrip or ship.\n");
+      exit(-1);
+   }
+   else {
+      L1_IC_REPL = strdup(ic);
+      L1_DC_REPL = strdup(dc);
+      L2_REPL = strdup(l2);
+   }
+}
+
+static void set_prefetchers(const char* config) {
+   char dc[16], l2[16];
+   unsigned int degree = PREFETCH_DEGREE;
+   int n = sscanf(config, "%15[^,],%15[^,],%u", dc, l2, &degree);
+   if ((n < 2) || !PrefetcherClass::Exists(dc) || !PrefetcherClass::Exists(l2) ||
+       (degree == 0) || (degree > PREFETCH_MAX_DEGREE)) {
+      fprintf(stderr, "Incorrect usage of --pf=<dc>,<l2>[,<d>]\n");
+      fprintf(stderr, "...where each of dc (L1 D$) and l2 (L2$) is none, nextline, stride or stream, and d (degree) is 1 to %d.\n", PREFETCH_MAX_DEGREE);
+      exit(-1);
+   }
+   else {
+      L1_DC_PREFETCHER = strdup(dc);
+      L2_PREFETCHER = strdup(l2);
+      PREFETCH_DEGREE = degree;
+   }
+}
+
+static void set_sample_params(const char* config) {
+   uint64_t period, warmup, window;
+   if ((sscanf(config, "%lu,%lu,%lu", &period, &warmup, &window) != 3) || (period <= (warmup + window)) || (window == 0)) {
+      fprintf(stderr, "Incorrect usage of --sample=<P>,<W>,<U>\n");
+      fprintf(stderr, "...where every <P> instructions, <W> warm-up and <U> measured instructions are simulated in detail; <P> must exceed <W>+<U> and <U> must be non-zero.\n");
+      exit(-1);
+   }
+   else {
+      sample_period = period;
+      sample_warmup = warmup;
+      sample_window = window;
+   }
+}
+
 /* exit when this becomes non-zero */
 //int sim_exit_now = FALSE;
 // Should be global variables for access from all DPI functions
@@ -163,6 +432,112 @@ debug_buffer_t* DB;
 sim_t*  s_isa;
 sim_t*  s_micro;
 
+// Reap one finished --sweep child, and report a failing configuration.
+static int reap_sweep(std::vector<std::string>& configs, std::vector<pid_t>& children)
+{
+  int status;
+  pid_t pid = wait(&status);
+  if (pid < 0)
+    return 0;
+  size_t n = std::find(children.begin(), children.end(), pid) - children.begin();
+  if (!WIFEXITED(status) || WEXITSTATUS(status)) {
+    fprintf(stderr, "Sweep configuration %lu failed: %s\n", n, configs[n].c_str());
+    return 1;
+  }
+  return 0;
+}
+
+// Fan the restored/skipped state out to one forked child per configuration
+// line of <file>.  Each child applies the line's options on top of the
+// command line, rebuilds the timing model, and simulates with its logs
+// named <name>.sweep.<n>, after the parent's log name (see --name).  The
+// binary profile files (--profile, --miss-prof) get the same suffix.
+// Returns the number of configurations that failed.
+static int run_sweep(option_parser_t& parser, const std::string& file)
+{
+  std::ifstream in(file.c_str());
+  if (!in) {
+    fprintf(stderr, "Unable to open sweep file '%s'\n", file.c_str());
+    exit(-1);
+  }
+
+  std::vector<std::string> configs;
+  for (std::string line; std::getline(in, line); ) {
+    size_t first = line.find_first_not_of(" \t\r");
+    if ((first != std::string::npos) && (line[first] != '#'))
+      configs.push_back(line);
+  }
+
+  unsigned int jobs = (fork_jobs ? fork_jobs : configs.size());
+  unsigned int running = 0;
+  std::vector<pid_t> children(configs.size(), 0);
+  int failures = 0;
+
+  for (size_t n = 0; n < configs.size(); n++) {
+    if (running == jobs) {
+      failures += reap_sweep(configs, children);
+      running--;
+    }
+
+    fflush(0);
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      exit(-1);
+    }
+    else if (pid == 0) {
+      std::string name = std::string(log_name) + ".sweep." + std::to_string(n);
+
+      // Split the line into an argument vector for the option parser.
+      std::istringstream tokens(configs[n]);
+      std::vector<std::string> words;
+      for (std::string word; tokens >> word; )
+        words.push_back(word);
+      std::vector<const char*> args(1, "--sweep");
+      for (size_t j = 0; j < words.size(); j++)
+        args.push_back(words[j].c_str());
+      args.push_back(NULL);
+      const char* const* rest = parser.parse(&args[0]);
+      if (*rest) {
+        fprintf(stderr, "Sweep configuration %lu: unexpected argument '%s'\n", n, *rest);
+        _exit(-1);
+      }
+
+      log_name = strdup(name.c_str());
+      if (!freopen((name + ".out").c_str(), "w", stdout))
+        _exit(-1);
+      if (PC_PROFILE_FILE)
+        PC_PROFILE_FILE = strdup((std::string(PC_PROFILE_FILE) + "." + name).c_str());
+      if (MISS_PROF_FILE)
+        MISS_PROF_FILE = strdup((std::string(MISS_PROF_FILE) + "." + name).c_str());
+
+      // Every configuration runs the target from the same state: give its
+      // files offsets of their own, lest the siblings' reads interleave.
+      s_micro->detach_target_files();
+      s_micro->reconfigure();
+      fprintf(stderr, "Starting MICROS (sweep configuration %lu: %s)\n", n, configs[n].c_str());
+      host_prof.Configure(HOST_PROF_PERIOD);
+      int htif_code = (sample_period ? s_micro->run_sampled() : s_micro->run());
+
+      //*** Must delete the simulator instances in order to dump stats ***
+      delete s_isa;
+      delete s_micro;
+      fflush(0);
+      _exit(htif_code);
+    }
+
+    children[n] = pid;
+    running++;
+  }
+
+  while (running) {
+    failures += reap_sweep(configs, children);
+    running--;
+  }
+
+  return failures;
+}
+
 static void endSimulation(int signal)
 {
   //*** Must delete the simulator instances in order to dump stats ***
@@ -171,6 +546,17 @@ static void endSimulation(int signal)
   delete s_micro;
 }  
 
+// SIGUSR1 and SIGUSR2 only raise a flag: the pipeline writes a stats
+// snapshot or resets the phase counters at the next cycle boundary, and
+// keeps running.
+static void requestStats(int signal)
+{
+  if (signal == SIGUSR1)
+    stats_snapshot_requested = 1;
+  else
+    stats_phase_reset_requested = 1;
+}
+
 
 
 int main(int argc, char** argv)
@@ -191,18 +577,31 @@ int main(int argc, char** argv)
   std::function<extension_t*()> extension;
 
   std::string checkpoint_file = "";
+  std::string sweep_file = "";
 
   option_parser_t parser;
   parser.help(&help);
   parser.option('h', 0, 0, [&](const char* s){help();});
   parser.option('d', 0, 0, [&](const char* s){debug = true;});
   parser.option('g', 0, 0, [&](const char* s){histogram = true;});
+  parser.option(0, "profile", 1, [&](const char* s){set_profile(s); histogram = true;});
+  parser.option(0, "miss-prof", 1, [&](const char* s){set_miss_prof(s);});
+  parser.option(0, "critical-path", 1, [&](const char* s){set_critical_path(s);});
+  parser.option(0, "reuse-dist", 1, [&](const char* s){set_reuse_dist(s);});
+  parser.option(0, "host-prof", 1, [&](const char* s){set_host_prof(s);});
+  parser.option(0, "heartbeat", 1, [&](const char* s){set_heartbeat(s);});
+  parser.option(0, "name", 1, [&](const char* s){log_name = strdup(s);});
+  parser.option(0, "stats", 1, [&](const char* s){set_stats(s);});
   parser.option('l', 0, 1, [&](const char* s){logging_on_at = atoll(s);});
   parser.option('p', 0, 1, [&](const char* s){nprocs = atoi(s);});
   parser.option('m', 0, 1, [&](const char* s){mem_mb = atoi(s);});
   parser.option('s', 0, 1, [&](const char* s){skip_amt = atoll(s); skip_enable = true;});
   parser.option('e', 0, 1, [&](const char* s){stop_amt = atoll(s); use_stop_amt = true;});
   parser.option('c', 0, 1, [&](const char* s){checkpoint_file = s;});
+  parser.option(0, "warm", 0, [&](const char* s){functional_warming = true;});
+  parser.option(0, "sample", 1, [&](const char* s){set_sample_params(s);});
+  parser.option(0, "sweep", 1, [&](const char* s){sweep_file = s;});
+  parser.option(0, "fork", 1, [&](const char* s){fork_jobs = atoi(s);});
   parser.option(0, "ic", 1, [&](const char* s){ic.reset(new icache_sim_t(s));});
   parser.option(0, "dc", 1, [&](const char* s){dc.reset(new dcache_sim_t(s));});
   parser.option(0, "l2", 1, [&](const char* s){l2.reset(cache_sim_t::construct(s, "L2$"));});
@@ -220,7 +619,12 @@ int main(int argc, char** argv)
   parser.option(0, "ctiq", 1, [&](const char* s){CTIQ_SIZE = atoi(s); CTIQ_MASK = CTIQ_SIZE-1;});
   parser.option(0, "bp"  , 1, [&](const char* s){BP_TABLE_SIZE = atoi(s); BP_INDEX_MASK = BP_TABLE_SIZE-1;});
   parser.option(0, "ras" , 1, [&](const char* s){RAS_SIZE = atoi(s);});
+  parser.option(0, "bpred", 1, [&](const char* s){set_bpred(s);});
+  parser.option(0, "shadow-bp", 1, [&](const char* s){set_shadow_bp(s);});
   parser.option(0, "fq"  , 1, [&](const char* s){FETCH_QUEUE_SIZE = atoi(s);});
+  parser.option(0, "ftq" , 1, [&](const char* s){set_ftq(s);});
+  parser.option(0, "uc"  , 1, [&](const char* s){set_uop_cache(s);});
+  parser.option(0, "lb"  , 1, [&](const char* s){LOOP_BUFFER_SIZE = atoi(s);});
   parser.option(0, "al"  , 1, [&](const char* s){ACTIVE_LIST_SIZE = atoi(s);});
   parser.option(0, "iq"  , 1, [&](const char* s){ISSUE_QUEUE_SIZE = atoi(s);});
   parser.option(0, "iqnp", 1, [&](const char* s){ISSUE_QUEUE_NUM_PARTS = atoi(s);});
@@ -228,6 +632,8 @@ int main(int argc, char** argv)
   parser.option('b', 0, 0, [&](const char* s){IDEAL_AGE_BASED = true;});
   parser.option(0, "lsq" , 1, [&](const char* s){LQ_SIZE = atoi(s);SQ_SIZE = atoi(s);});
   parser.option(0, "disambig", 1, [&](const char* s){set_disambig_flags(s);});
+  parser.option(0, "mdp", 1, [&](const char* s){set_mdp(s);});
+  parser.option(0, "vp", 1, [&](const char* s){set_vp(s);});
   parser.option(0, "fw"  , 1, [&](const char* s){FETCH_WIDTH = atoi(s);});
   parser.option(0, "dw"  , 1, [&](const char* s){DISPATCH_WIDTH = atoi(s);});
   parser.option(0, "iw"  , 1, [&](const char* s){ISSUE_WIDTH = atoi(s);});
@@ -235,11 +641,15 @@ int main(int argc, char** argv)
   parser.option(0, "phase",1, [&](const char *s){phase_interval = atoll(s);});
   parser.option(0, "lane" ,1, [&](const char *s){set_lane_matrix(s);});
   parser.option(0, "lat"  ,1, [&](const char *s){set_lane_latencies(s);});
+  parser.option(0, "pf", 1, [&](const char* s){set_prefetchers(s);});
+  parser.option(0, "repl", 1, [&](const char* s){set_repl_policies(s);});
   parser.option(0, "nol2", 1, [&](const char* s){L2_PRESENT = false;});
 
   auto argv1 = parser.parse(argv);
   if (!*argv1)
     help();
+  if (!log_name)
+    log_name = default_log_name(argc, argv);
   std::vector<std::string> htif_args(argv1, (const char*const*)argv + argc);
   s_micro = new sim_t(nprocs, mem_mb, htif_args, MICRO_SIM);
 
@@ -297,11 +707,17 @@ int main(int argc, char** argv)
 
   sigaction(SIGINT,   &sigIntHandler, NULL);
 
-  /* catch SIGUSR1 and dump intermediate stats */
-  sigaction(SIGUSR1,  &sigIntHandler, NULL);
+  struct sigaction sigStatsHandler;
+
+  sigStatsHandler.sa_handler = requestStats;
+  sigemptyset(&sigStatsHandler.sa_mask);
+  sigStatsHandler.sa_flags = SA_RESTART;
 
   /* catch SIGUSR1 and dump intermediate stats */
-  sigaction(SIGUSR2,  &sigIntHandler, NULL);
+  sigaction(SIGUSR1,  &sigStatsHandler, NULL);
+
+  /* catch SIGUSR2 and reset the phase counters */
+  sigaction(SIGUSR2,  &sigStatsHandler, NULL);
 
   /* register an error handler */
   //fatal_hook(sim_stats);
@@ -408,8 +824,19 @@ int main(int argc, char** argv)
   if(logging_on_at == 0)
     logging_on = true;
 
+  // Fan out to one child per configuration, sharing the state restored above.
+  if (sweep_file != "") {
+    htif_code = run_sweep(parser, sweep_file);
+    fprintf(stderr, "Sweep finished: %d configuration(s) failed\n", htif_code);
+    return htif_code;
+  }
+
   fprintf(stderr, "Starting MICROS\n");
-  htif_code = s_micro->run();
+  host_prof.Configure(HOST_PROF_PERIOD);
+  if (sample_period)
+    htif_code = s_micro->run_sampled();
+  else
+    htif_code = s_micro->run();
   fprintf(stderr, "Stopping MICROS: HTIF Exit Code %d\n",htif_code);
 
   //*** Must delete the simulator instances in order to dump stats ***
@@ -0,0 +1,142 @@
+/*--------------------------------------------------------------------------*\
+ | miss_prof.cc
+ |
+ | Delinquent-load profiler.  See miss_prof.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#include "miss_prof.h"
+
+static inline uint32_t saturate(uint64_t n)
+{
+	return((n > 0xffffffffULL) ? 0xffffffffU : (uint32_t)n);
+}
+
+std::vector<miss_prof_t*> MissProfClass::Sorted(Table& table)
+{
+	return(table.Select([](const miss_prof_t* p) { return(p->l1_misses || p->mhsr_full); },
+	                    [](const miss_prof_t* a, const miss_prof_t* b) {
+		if (a->l1_misses != b->l1_misses)
+			return(a->l1_misses > b->l1_misses);
+		if (a->mhsr_full != b->mhsr_full)
+			return(a->mhsr_full > b->mhsr_full);
+		return(a->key < b->key);
+	}));
+}
+
+MissProfClass::MissProfClass(unsigned int top, unsigned int regionSize, unsigned int logLineSize, const char* mapFile)
+	: top(top), mapFile(mapFile)
+{
+	assert(regionSize && !(regionSize & (regionSize - 1)));
+	for (regionShift = 0; (1U << regionShift) < regionSize; regionShift++)
+		;
+	lineShift = logLineSize;
+	lines = (mapFile ? new Table() : NULL);
+}
+
+MissProfClass::~MissProfClass()
+{
+	delete lines;
+}
+
+void MissProfClass::Access(uint64_t pc, uint64_t addr, bool mhsrFull, bool l1Miss, bool l2Miss,
+                           uint64_t latency, unsigned int mlp)
+{
+	miss_prof_t* p[3];
+	unsigned int n = 0, i;
+
+	p[n++] = pcs.Get(pc);
+	p[n++] = regions.Get((addr >> regionShift) << regionShift);
+	if (lines)
+		p[n++] = lines->Get((addr >> lineShift) << lineShift);
+
+	for (i = 0; i < n; i++) {
+		if (mhsrFull) {
+			p[i]->mhsr_full++;
+		}
+		else {
+			p[i]->accesses++;
+			if (l1Miss) {
+				p[i]->l1_misses++;
+				p[i]->miss_cycles += latency;
+				p[i]->miss_mlp += mlp;
+				if (l2Miss)
+					p[i]->l2_misses++;
+			}
+		}
+	}
+}
+
+void MissProfClass::PrintTable(FILE* fp, Table& table, const char* title, const char* key)
+{
+	std::vector<miss_prof_t*> v = Sorted(table);
+	uint64_t l1 = 0, l2 = 0, full = 0, shown_l1 = 0;
+	size_t i;
+
+	for (i = 0; i < v.size(); i++) {
+		l1 += v[i]->l1_misses;
+		l2 += v[i]->l2_misses;
+		full += v[i]->mhsr_full;
+	}
+
+	fprintf(fp, "%s (top %u of %lu with misses or MHSR-full retries, of %lu)\n", title, top, v.size(), table.Used());
+	fprintf(fp, "%-18s %12s %10s %10s %10s %9s %7s %7s\n",
+	        key, "accesses", "l1d_miss", "l2_miss", "mhsr_full", "avg_lat", "avg_mlp", "cum%");
+	for (i = 0; (i < v.size()) && (i < top); i++) {
+		shown_l1 += v[i]->l1_misses;
+		fprintf(fp, "%-18lx %12lu %10lu %10lu %10lu %9.1f %7.2f %6.1f%%\n",
+		        v[i]->key, v[i]->accesses, v[i]->l1_misses, v[i]->l2_misses, v[i]->mhsr_full,
+		        (v[i]->l1_misses ? ((double)v[i]->miss_cycles / (double)v[i]->l1_misses) : 0.0),
+		        (v[i]->l1_misses ? ((double)v[i]->miss_mlp / (double)v[i]->l1_misses) : 0.0),
+		        (l1 ? (100.0 * (double)shown_l1 / (double)l1) : 0.0));
+	}
+	fprintf(fp, "%-18s %12s %10lu %10lu %10lu\n", "all", "", l1, l2, full);
+}
+
+void MissProfClass::Print(FILE* fp)
+{
+	fprintf(fp, "\n=== MISS PROFILE ================================================================\n\n");
+	fprintf(fp, "(timed D$ accesses, including wrong-path ones; cum%% is the share of all L1 D$ misses)\n");
+	PrintTable(fp, pcs, "load/store PCs", "pc");
+	fprintf(fp, "\n");
+	PrintTable(fp, regions, "data regions", "region");
+	fprintf(fp, "(regions are %u-byte aligned blocks)\n", (1U << regionShift));
+
+	if (lines && mapFile)
+		WriteMap();
+}
+
+void MissProfClass::WriteMap()
+{
+	std::vector<miss_prof_t*> v;
+	miss_map_record_t r;
+	uint64_t n, lineBytes = (1ULL << lineShift);
+	FILE* fp = fopen(mapFile, "wb");
+
+	if (!fp) {
+		fprintf(stderr, "Unable to write the miss heat map to %s\n", mapFile);
+		return;
+	}
+
+	// Only the lines that missed or were turned away.
+	v = Sorted(*lines);
+	std::sort(v.begin(), v.end(), [](const miss_prof_t* a, const miss_prof_t* b) { return(a->key < b->key); });
+
+	n = v.size();
+	fwrite("MISSMAP1", 1, 8, fp);
+	fwrite(&lineBytes, sizeof(lineBytes), 1, fp);
+	fwrite(&n, sizeof(n), 1, fp);
+	for (size_t i = 0; i < v.size(); i++) {
+		r.line = v[i]->key;
+		r.accesses = saturate(v[i]->accesses);
+		r.l1_misses = saturate(v[i]->l1_misses);
+		r.l2_misses = saturate(v[i]->l2_misses);
+		r.mhsr_full = saturate(v[i]->mhsr_full);
+		fwrite(&r, sizeof(r), 1, fp);
+	}
+	fclose(fp);
+}
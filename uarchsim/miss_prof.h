@@ -0,0 +1,92 @@
+#ifndef MISS_PROF_H
+#define MISS_PROF_H
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#include "keyed_table.h"
+
+/*--------------------------------------------------------------------------*\
+ | miss_prof.h
+ |
+ | Delinquent-load profiler (see --miss-prof): which static loads and
+ |  stores, and which data regions, miss in the L1 D$ and L2$, or are
+ |  turned away because no MHSR is free.  Every timed D$ access by the
+ |  LSU is recorded, including accesses by wrong-path loads and the
+ |  retries of loads that found no free MHSR.
+ |
+ | For each PC and each region (an aligned block of regionSize bytes,
+ |  by default a page), the profile counts accesses, L1 and L2 misses
+ |  and MHSR-full retries, and sums each miss's latency and the memory-
+ |  level parallelism (misses outstanding in the D$, itself included)
+ |  it overlapped with.
+ |
+ | Optionally, the same counts are kept per cache line and written, as a
+ |  heat map, to a binary file: the 8-byte magic "MISSMAP1", a uint64_t
+ |  line size and record count, then a record (miss_map_record_t) for
+ |  each line that missed or was turned away, sorted by line address.
+\*--------------------------------------------------------------------------*/
+
+typedef struct {
+	uint64_t key;		// PC, region base address or line address.
+	uint64_t accesses;
+	uint64_t l1_misses;
+	uint64_t l2_misses;
+	uint64_t mhsr_full;	// Accesses turned away for lack of an MHSR.
+	uint64_t miss_cycles;	// Sum of the misses' latencies...
+	uint64_t miss_mlp;	// ...and of the misses outstanding at each miss.
+} miss_prof_t;
+
+typedef struct {
+	uint64_t line;		// Line address (byte address of the line).
+	uint32_t accesses;	// Counts saturate.
+	uint32_t l1_misses;
+	uint32_t l2_misses;
+	uint32_t mhsr_full;
+} miss_map_record_t;
+
+class MissProfClass
+{
+public:
+	MissProfClass(unsigned int top, unsigned int regionSize, unsigned int logLineSize, const char* mapFile);
+	~MissProfClass();
+
+	void Access(uint64_t pc, uint64_t addr, bool mhsrFull, bool l1Miss, bool l2Miss,
+	            uint64_t latency, unsigned int mlp);
+	/*------------------------------------------------------------------------*\
+	 | Records one D$ access by the instruction at pc to addr.  If mhsrFull,
+	 |  the access was turned away and the other arguments are ignored.
+	 |  For an L1 miss, latency is the cycles until the line arrives and mlp
+	 |  the misses outstanding in the D$.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp);
+	/*------------------------------------------------------------------------*\
+	 | Prints the top PCs and regions by L1 misses, and writes the heat map.
+	\*------------------------------------------------------------------------*/
+
+	void DropMap() { mapFile = NULL; }
+	/*------------------------------------------------------------------------*\
+	 | Writes no heat map, e.g. when the logs are redirected.
+	\*------------------------------------------------------------------------*/
+
+private:
+	// Profiles, keyed by PC or address.
+	typedef KeyedTable<miss_prof_t, &miss_prof_t::key> Table;
+
+	unsigned int top;
+	unsigned int regionShift;
+	unsigned int lineShift;
+	const char* mapFile;
+
+	Table pcs;
+	Table regions;
+	Table* lines;		// NULL without a heat map.
+
+	static std::vector<miss_prof_t*> Sorted(Table& table);	// By L1 misses and MHSR-full retries.
+	void PrintTable(FILE* fp, Table& table, const char* title, const char* key);
+	void WriteMap();
+};
+
+#endif //MISS_PROF_H
@@ -1,5 +1,6 @@
 #include <cinttypes>
 #include "fu.h"
+#include "parameters.h"
 
 // Pipe control
 uint32_t PIPE_QUEUE_SIZE  = 4096;
@@ -15,6 +16,12 @@ bool PERFECT_DCACHE		    = false;
 
 // Core.
 uint32_t FETCH_QUEUE_SIZE	= 32;
+uint32_t FTQ_SIZE		      = 0;	// Fetch target queue (decoupled front-end); 0: coupled fetch
+uint32_t FTQ_PREFETCHES	  = 2;	// FDIP: I$ prefetches issued from the FTQ per cycle
+uint32_t UOP_CACHE_SETS	  = 0;	// Decoded-uop (trace) cache; 0: none
+uint32_t UOP_CACHE_ASSOC	  = 8;
+uint32_t UOP_CACHE_BLOCKS	  = 2;	// Maximum basic blocks per trace
+uint32_t LOOP_BUFFER_SIZE	  = 0;	// Loop buffer capacity in instructions; 0: none
 uint32_t NUM_CHECKPOINTS	= 32;
 uint32_t ACTIVE_LIST_SIZE	= 256;
 uint32_t ISSUE_QUEUE_SIZE	= 32;
@@ -30,6 +37,11 @@ bool IC_SINGLE_BB		      = false;	// not used currently
 bool IN_ORDER_ISSUE		    = false;	// not used currently
 bool SPEC_DISAMBIG = false;
 bool MEM_DEP_PRED = false;
+uint32_t MDP_SSIT_SIZE = 4096;	// Store sets: store set ID table entries (power of 2)
+uint32_t MDP_LFST_SIZE = 128;	// Store sets: last fetched store table entries (max. store sets)
+uint64_t MDP_CLEAR_INTERVAL = 1000000;	// Store sets: SSIT invalidated every this many cycles; 0: never
+const char* VALUE_PRED = "none";	// Value predictor: none, lvp, stride, or vtage (value_pred.h)
+uint32_t VP_TABLE_SIZE = 4096;	// Value predictor: last-value/stride table entries (power of 2)
 
 bool PRESTEER = false;
 bool IDEAL_AGE_BASED = false;
@@ -77,6 +89,8 @@ unsigned int L1_DC_MISS_LATENCY     = 100; // Used only when no L2 cache
 unsigned int L1_DC_NUM_MHSRs        = 64; 
 unsigned int L1_DC_MISS_SRV_PORTS   = 64;
 unsigned int L1_DC_MISS_SRV_LATENCY = 1;
+const char*  L1_DC_REPL             = "lru"; // Replacement policy (replacement.h)
+const char*  L1_DC_PREFETCHER       = "none"; // Prefetcher (prefetch.h)
 
 // L1 Instruction Cache.
 unsigned int L1_IC_SETS             = 128;
@@ -87,6 +101,7 @@ unsigned int L1_IC_MISS_LATENCY     = 100; // Used only when no L2 cache
 unsigned int L1_IC_NUM_MHSRs        = 32;
 unsigned int L1_IC_MISS_SRV_PORTS   = 1;
 unsigned int L1_IC_MISS_SRV_LATENCY = 1;
+const char*  L1_IC_REPL             = "lru"; // Replacement policy (replacement.h)
 
 // L2 Unified Cache.
 bool         L2_PRESENT           = true;
@@ -98,6 +113,11 @@ unsigned int L2_MISS_LATENCY      = 100;  // Used only when no L3
 unsigned int L2_NUM_MHSRs         = 64; 
 unsigned int L2_MISS_SRV_PORTS    = 64;
 unsigned int L2_MISS_SRV_LATENCY  = 1;
+const char*  L2_REPL              = "lru"; // Replacement policy (replacement.h)
+const char*  L2_PREFETCHER        = "none"; // Prefetcher (prefetch.h)
+
+// Lines prefetched per prefetcher trigger.
+unsigned int PREFETCH_DEGREE      = 4;
 
 // Size of Q for remembering outstanding predictions
 unsigned int CTIQ_SIZE	            = 1024;
@@ -110,10 +130,16 @@ unsigned int BTB_MASK	              = BTB_SIZE-1;
 // Predictor configuration
 unsigned int BP_TABLE_SIZE	        = 0x10000;
 unsigned int BP_INDEX_MASK	        = BP_TABLE_SIZE-1;
+const char*  BP_COND	              = "gshare";	// Conditional branch predictor: gshare or tage-sc-l (tage.h)
+const char*  BP_INDIRECT	          = "btb";	// Indirect target predictor: btb or ittage (tage.h)
 
 // RAS configuration
 unsigned int RAS_SIZE = 32; 
 
+// Shadow branch predictors, trained on the retired CTIs (--shadow-bp)
+const char*  SHADOW_BP[MAX_SHADOW_BP];
+unsigned int NUM_SHADOW_BP = 0;
+
 // Branch predictor confidence.
 bool CONF_RESET                     = true;
 unsigned int CONF_THRESHOLD         = 14;
@@ -133,3 +159,148 @@ uint64_t stop_amt                   = 0xffffffffffffffff;
 
 uint64_t phase_interval             = 10000;
 uint64_t verbose_phase_counters     = true;
+
+// Per-PC profile (-g): PCs printed, and optional binary dump of all PCs.
+unsigned int PC_PROFILE_TOP         = 50;
+const char* PC_PROFILE_FILE         = NULL;
+
+// Delinquent-load profiler (--miss-prof): PCs and regions printed (0 disables
+// it), region size in bytes, and optional binary cache-line heat map.
+unsigned int MISS_PROF_TOP          = 0;
+unsigned int MISS_PROF_REGION       = 4096;
+const char* MISS_PROF_FILE          = NULL;
+
+// Critical-path analysis (--critical-path): retired instructions per window; 0 disables it.
+unsigned int CRIT_PATH_WINDOW       = 0;
+
+// Reuse-distance profiler (--reuse-dist): lines sampled at 1/REUSE_DIST_SAMPLING
+// (0 disables it), and the line sizes profiled (2^REUSE_DIST_LINES[i] bytes;
+// none: the I$, D$ and L2$ line sizes).
+unsigned int REUSE_DIST_SAMPLING    = 0;
+unsigned int REUSE_DIST_NUM_LINES   = 0;
+unsigned int REUSE_DIST_LINES[REUSE_DIST_MAX_LINES];
+
+// Host-time profiler (--host-prof): time one in every HOST_PROF_PERIOD cycles; 0 disables it.
+unsigned int HOST_PROF_PERIOD       = 0;
+
+// Heartbeat (--heartbeat): report progress and write partial stats every
+// HEARTBEAT_INTERVAL host seconds; 0 disables it.
+unsigned int HEARTBEAT_INTERVAL     = 0;
+
+// Train caches and branch predictor during fast skip (-s).
+bool functional_warming             = false;
+
+// Periodic sampling (--sample): every sample_period instructions, run
+// sample_warmup unmeasured then sample_window measured instructions in
+// detail, and functionally warm the rest.  Disabled when sample_period is 0.
+uint64_t sample_period              = 0;
+uint64_t sample_warmup              = 2000;
+uint64_t sample_window              = 1000;
+
+// Maximum number of forked children for --sample (0: no forking) and --sweep.
+unsigned int fork_jobs              = 0;
+
+// Name of the stats and phase logs (--name): by default, a hash of the
+// command line, so a run's files are named the same every time and
+// concurrent runs of different configurations do not collide.
+const char* log_name                = NULL;
+
+// Structured stats (--stats=json): the final stats as one JSON document,
+// and the phase counters as a binary time series instead of text.
+bool structured_stats               = false;
+
+// The parameters above, by name, for the structured stats.
+#define PARAM(type, var)		{ #var, (type), (const void*)&(var), 1 }
+#define PARAM_ARRAY(type, var, n)	{ #var, (type), (const void*)(var), (n) }
+
+const param_t PARAMETERS[] = {
+  PARAM(PARAM_UINT, PIPE_QUEUE_SIZE),
+  PARAM(PARAM_BOOL, PERFECT_BRANCH_PRED),
+  PARAM(PARAM_BOOL, PERFECT_FETCH),
+  PARAM(PARAM_BOOL, ORACLE_DISAMBIG),
+  PARAM(PARAM_BOOL, PERFECT_ICACHE),
+  PARAM(PARAM_BOOL, PERFECT_DCACHE),
+  PARAM(PARAM_UINT, FETCH_QUEUE_SIZE),
+  PARAM(PARAM_UINT, FTQ_SIZE),
+  PARAM(PARAM_UINT, FTQ_PREFETCHES),
+  PARAM(PARAM_UINT, UOP_CACHE_SETS),
+  PARAM(PARAM_UINT, UOP_CACHE_ASSOC),
+  PARAM(PARAM_UINT, UOP_CACHE_BLOCKS),
+  PARAM(PARAM_UINT, LOOP_BUFFER_SIZE),
+  PARAM(PARAM_UINT, NUM_CHECKPOINTS),
+  PARAM(PARAM_UINT, ACTIVE_LIST_SIZE),
+  PARAM(PARAM_UINT, ISSUE_QUEUE_SIZE),
+  PARAM(PARAM_UINT, ISSUE_QUEUE_NUM_PARTS),
+  PARAM(PARAM_UINT, LQ_SIZE),
+  PARAM(PARAM_UINT, SQ_SIZE),
+  PARAM(PARAM_UINT, FETCH_WIDTH),
+  PARAM(PARAM_UINT, DISPATCH_WIDTH),
+  PARAM(PARAM_UINT, ISSUE_WIDTH),
+  PARAM(PARAM_UINT, RETIRE_WIDTH),
+  PARAM(PARAM_BOOL, IC_INTERLEAVED),
+  PARAM(PARAM_BOOL, SPEC_DISAMBIG),
+  PARAM(PARAM_BOOL, MEM_DEP_PRED),
+  PARAM(PARAM_UINT, MDP_SSIT_SIZE),
+  PARAM(PARAM_UINT, MDP_LFST_SIZE),
+  PARAM(PARAM_UINT64, MDP_CLEAR_INTERVAL),
+  PARAM(PARAM_STRING, VALUE_PRED),
+  PARAM(PARAM_UINT, VP_TABLE_SIZE),
+  PARAM(PARAM_BOOL, PRESTEER),
+  PARAM(PARAM_BOOL, IDEAL_AGE_BASED),
+  PARAM_ARRAY(PARAM_UINT, FU_LANE_MATRIX, NUMBER_FU_TYPES),
+  PARAM_ARRAY(PARAM_UINT, FU_LAT, NUMBER_FU_TYPES),
+  PARAM(PARAM_UINT, L1_DC_SETS),
+  PARAM(PARAM_UINT, L1_DC_ASSOC),
+  PARAM(PARAM_UINT, L1_DC_LINE_SIZE),
+  PARAM(PARAM_UINT, L1_DC_HIT_LATENCY),
+  PARAM(PARAM_UINT, L1_DC_MISS_LATENCY),
+  PARAM(PARAM_UINT, L1_DC_NUM_MHSRs),
+  PARAM(PARAM_UINT, L1_DC_MISS_SRV_PORTS),
+  PARAM(PARAM_UINT, L1_DC_MISS_SRV_LATENCY),
+  PARAM(PARAM_STRING, L1_DC_REPL),
+  PARAM(PARAM_STRING, L1_DC_PREFETCHER),
+  PARAM(PARAM_UINT, L1_IC_SETS),
+  PARAM(PARAM_UINT, L1_IC_ASSOC),
+  PARAM(PARAM_UINT, L1_IC_LINE_SIZE),
+  PARAM(PARAM_UINT, L1_IC_HIT_LATENCY),
+  PARAM(PARAM_UINT, L1_IC_MISS_LATENCY),
+  PARAM(PARAM_UINT, L1_IC_NUM_MHSRs),
+  PARAM(PARAM_UINT, L1_IC_MISS_SRV_PORTS),
+  PARAM(PARAM_UINT, L1_IC_MISS_SRV_LATENCY),
+  PARAM(PARAM_STRING, L1_IC_REPL),
+  PARAM(PARAM_BOOL, L2_PRESENT),
+  PARAM(PARAM_UINT, L2_SETS),
+  PARAM(PARAM_UINT, L2_ASSOC),
+  PARAM(PARAM_UINT, L2_LINE_SIZE),
+  PARAM(PARAM_UINT, L2_HIT_LATENCY),
+  PARAM(PARAM_UINT, L2_MISS_LATENCY),
+  PARAM(PARAM_UINT, L2_NUM_MHSRs),
+  PARAM(PARAM_UINT, L2_MISS_SRV_PORTS),
+  PARAM(PARAM_UINT, L2_MISS_SRV_LATENCY),
+  PARAM(PARAM_STRING, L2_REPL),
+  PARAM(PARAM_STRING, L2_PREFETCHER),
+  PARAM(PARAM_UINT, PREFETCH_DEGREE),
+  PARAM(PARAM_UINT, CTIQ_SIZE),
+  PARAM(PARAM_UINT, BTB_SIZE),
+  PARAM(PARAM_UINT, BP_TABLE_SIZE),
+  PARAM(PARAM_STRING, BP_COND),
+  PARAM(PARAM_STRING, BP_INDIRECT),
+  PARAM(PARAM_UINT, RAS_SIZE),
+  PARAM_ARRAY(PARAM_STRING, SHADOW_BP, MAX_SHADOW_BP),
+  PARAM(PARAM_BOOL, CONF_RESET),
+  PARAM(PARAM_UINT, CONF_THRESHOLD),
+  PARAM(PARAM_UINT, CONF_MAX),
+  PARAM(PARAM_BOOL, FM_RESET),
+  PARAM(PARAM_UINT, FM_THRESHOLD),
+  PARAM(PARAM_UINT, FM_MAX),
+  PARAM(PARAM_BOOL, use_stop_amt),
+  PARAM(PARAM_UINT64, stop_amt),
+  PARAM(PARAM_UINT64, phase_interval),
+  PARAM(PARAM_BOOL, functional_warming),
+  PARAM(PARAM_UINT64, sample_period),
+  PARAM(PARAM_UINT64, sample_warmup),
+  PARAM(PARAM_UINT64, sample_window),
+  PARAM(PARAM_STRING, log_name),
+};
+
+const unsigned int NUM_PARAMETERS = (sizeof(PARAMETERS) / sizeof(PARAMETERS[0]));
@@ -2,6 +2,12 @@
 #define PARAMETERS_H
 #include <cinttypes>
 
+// These knobs are process globals, as are logging_on, s_isa, s_micro and
+// DB, the signal flags, log_name, fork_jobs and host_prof: a process runs
+// one simulation.  Several configurations run in forked children (see
+// --sweep), each of which rewrites the knobs before it rebuilds its
+// timing model.
+
 // Pipe control
 extern unsigned int PIPE_QUEUE_SIZE;
 
@@ -15,6 +21,12 @@ extern bool PERFECT_DCACHE;
 
 // Core.
 extern unsigned int FETCH_QUEUE_SIZE;
+extern unsigned int FTQ_SIZE;
+extern unsigned int FTQ_PREFETCHES;
+extern unsigned int UOP_CACHE_SETS;
+extern unsigned int UOP_CACHE_ASSOC;
+extern unsigned int UOP_CACHE_BLOCKS;
+extern unsigned int LOOP_BUFFER_SIZE;
 extern unsigned int NUM_CHECKPOINTS;
 extern unsigned int ACTIVE_LIST_SIZE;
 extern unsigned int ISSUE_QUEUE_SIZE;
@@ -30,6 +42,11 @@ extern bool         IC_SINGLE_BB;		// not used currently
 extern bool         IN_ORDER_ISSUE;		// not used currently
 extern bool         SPEC_DISAMBIG;
 extern bool         MEM_DEP_PRED;
+extern unsigned int MDP_SSIT_SIZE;
+extern unsigned int MDP_LFST_SIZE;
+extern uint64_t     MDP_CLEAR_INTERVAL;
+extern const char*  VALUE_PRED;
+extern unsigned int VP_TABLE_SIZE;
 extern bool         PRESTEER;
 extern bool         IDEAL_AGE_BASED;
 extern unsigned int FU_LANE_MATRIX[];
@@ -44,6 +61,8 @@ extern unsigned int L1_DC_MISS_LATENCY;
 extern unsigned int L1_DC_NUM_MHSRs;
 extern unsigned int L1_DC_MISS_SRV_PORTS;
 extern unsigned int L1_DC_MISS_SRV_LATENCY;
+extern const char*  L1_DC_REPL;
+extern const char*  L1_DC_PREFETCHER;
 
 // L1 Instruction Cache.
 extern unsigned int L1_IC_SETS;
@@ -54,6 +73,7 @@ extern unsigned int L1_IC_MISS_LATENCY;
 extern unsigned int L1_IC_NUM_MHSRs;
 extern unsigned int L1_IC_MISS_SRV_PORTS;
 extern unsigned int L1_IC_MISS_SRV_LATENCY;
+extern const char*  L1_IC_REPL;
 
 // L2 Unified Cache.
 extern bool         L2_PRESENT;
@@ -65,16 +85,27 @@ extern unsigned int L2_MISS_LATENCY;
 extern unsigned int L2_NUM_MHSRs; 
 extern unsigned int L2_MISS_SRV_PORTS;
 extern unsigned int L2_MISS_SRV_LATENCY;
+extern const char*  L2_REPL;
+extern const char*  L2_PREFETCHER;
+
+extern unsigned int PREFETCH_DEGREE;
 
 // Branch predictor and BTB
 extern unsigned int BTB_SIZE;
 extern unsigned int BTB_MASK;
 extern unsigned int BP_TABLE_SIZE;
 extern unsigned int BP_INDEX_MASK;
+extern const char* BP_COND;
+extern const char* BP_INDIRECT;
 extern unsigned int CTIQ_SIZE;
 extern unsigned int CTIQ_MASK;
 extern unsigned int RAS_SIZE;
 
+// Shadow branch predictors (shadow_bp.h).
+#define MAX_SHADOW_BP 16
+extern const char* SHADOW_BP[MAX_SHADOW_BP];
+extern unsigned int NUM_SHADOW_BP;
+
 // Branch predictor confidence.
 extern bool CONF_RESET;
 extern unsigned int CONF_THRESHOLD;
@@ -94,4 +125,44 @@ extern uint64_t stop_amt;
 extern uint64_t phase_interval;
 extern uint64_t verbose_phase_counters;
 
+extern unsigned int PC_PROFILE_TOP;
+extern const char* PC_PROFILE_FILE;
+extern unsigned int MISS_PROF_TOP;
+extern unsigned int MISS_PROF_REGION;
+extern const char* MISS_PROF_FILE;
+
+extern unsigned int CRIT_PATH_WINDOW;
+
+#define REUSE_DIST_MAX_LINES	4
+extern unsigned int REUSE_DIST_SAMPLING;
+extern unsigned int REUSE_DIST_NUM_LINES;
+extern unsigned int REUSE_DIST_LINES[REUSE_DIST_MAX_LINES];
+
+extern unsigned int HOST_PROF_PERIOD;
+
+extern unsigned int HEARTBEAT_INTERVAL;
+
+extern bool functional_warming;
+
+extern uint64_t sample_period;
+extern uint64_t sample_warmup;
+extern uint64_t sample_window;
+
+extern unsigned int fork_jobs;
+extern const char* log_name;
+extern bool structured_stats;
+
+// Table of the parameters, by name, for the structured stats.
+typedef enum {PARAM_BOOL, PARAM_UINT, PARAM_UINT64, PARAM_STRING} param_type_t;
+
+typedef struct {
+  const char* name;
+  param_type_t type;
+  const void* addr;		// The variable, or the first element of an array...
+  unsigned int count;		// ...of count elements.
+} param_t;
+
+extern const param_t PARAMETERS[];
+extern const unsigned int NUM_PARAMETERS;
+
 #endif //PARAMETERS_H
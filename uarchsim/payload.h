@@ -5,6 +5,7 @@
 #include "trap.h"
 #include "decode.h"
 #include "fu.h"
+#include "value_pred.h"
 
 #define PAYLOAD_BUFFER_SIZE  8192
 
@@ -149,6 +150,9 @@ typedef struct {
                                 // this is the branch's ID (its bit position
                                 // in the Global Branch Mask).
 
+   // Value prediction (see value_pred.h).
+   vp_info_t vp;
+
    ////////////////////////
    // Set by Dispatch Stage.
    ////////////////////////
@@ -194,6 +198,28 @@ typedef struct {
    // If there was an exception during execution, the trap is stored here.
    trap_t *trap;
 
+   // Load violation: PC of the store that the load should have waited for.
+   // Trains the memory dependence predictor at retirement.
+   reg_t viol_store_pc;
+
+   ////////////////////////
+   // Critical-path analysis (see crit_path.h).
+   ////////////////////////
+
+   // Cycles at which the instruction was fetched, dispatched, issued and
+   // completed.  An instruction that bypasses the IQs issues and completes
+   // at dispatch.
+   cycle_t fetch_cycle;
+   cycle_t dispatch_cycle;
+   cycle_t issue_cycle;
+   cycle_t complete_cycle;
+
+   // Sequence numbers of the producers of source registers A, B and D, and
+   // of the store that forwarded its value to a load (CP_NO_PRODUCER if none).
+   // Only set when the analysis is enabled.
+   uint64_t producer[3];
+   uint64_t mem_producer;
+
 } payload_t;
 
 
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+# Reads a binary phase time series (721sim --stats=json), phase.<name>.bin:
+# the 8-byte magic "721PHS01", a uint32 column count, the NUL-terminated
+# column names, then one row of uint64's per phase (see stats.h).
+#
+#   phases.py phase.<name>.bin                   list the columns
+#   phases.py phase.<name>.bin all               print every column as CSV
+#   phases.py phase.<name>.bin <col>[,<col>...]  print phase_id, the columns,
+#                                                and the phase IPC as CSV
+
+import struct
+import sys
+
+MAGIC = b"721PHS01"
+
+def read_series(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != MAGIC:
+        sys.exit("%s: not a phase time series" % path)
+    (ncols,) = struct.unpack_from("<I", data, 8)
+    pos = 12
+    columns = []
+    for _ in range(ncols):
+        end = data.index(b"\0", pos)
+        columns.append(data[pos:end].decode())
+        pos = end + 1
+    row = struct.Struct("<%dQ" % ncols)
+    rows = [row.unpack_from(data, off)
+            for off in range(pos, len(data) - row.size + 1, row.size)]
+    return columns, rows
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit("usage: phases.py <file> [<col>[,<col>...] | all]")
+    columns, rows = read_series(sys.argv[1])
+    if len(sys.argv) < 3:
+        for name in columns:
+            print(name)
+        print("(%d phases)" % len(rows))
+        return
+
+    if sys.argv[2] == "all":
+        selected = columns[1:]
+    else:
+        selected = sys.argv[2].split(",")
+    for name in selected:
+        if name not in columns:
+            sys.exit("unknown column %s" % name)
+    index = [columns.index(name) for name in selected]
+    ipc = ("commit_count" in columns) and ("cycle_count" in columns)
+    commits = columns.index("commit_count") if ipc else 0
+    cycles = columns.index("cycle_count") if ipc else 0
+
+    print(",".join(["phase_id"] + selected + (["ipc"] if ipc else [])))
+    for r in rows:
+        fields = [str(r[0])] + [str(r[i]) for i in index]
+        if ipc:
+            fields.append("%.4f" % (float(r[commits]) / r[cycles] if r[cycles] else 0.0))
+        print(",".join(fields))
+
+if __name__ == "__main__":
+    main()
@@ -8,7 +8,9 @@
 #include "sim.h"
 #include "htif.h"
 #include "disasm.h"
+#include "json_writer.h"
 #include <cinttypes>
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
@@ -16,6 +18,8 @@
 #include <stdexcept>
 #include <algorithm>
 #include <sys/stat.h>
+#include <sys/resource.h>
+#include <unistd.h>
 #include "parameters.h"
 #include <ctime>
 
@@ -91,7 +95,28 @@ pipeline_t::pipeline_t(
 
   // Initialize number of retired instructions.
   num_insn = 0;
+  grading_plateau = 1000;
+  num_insn_last_beat = 0;
+  heartbeat_started = false;
+  heartbeat_start_time = 0.0;
+  heartbeat_last_time = 0.0;
+  heartbeat_last_insn = 0;
+  num_snapshots = 0;
   num_insn_split = 0;
+  head_stall_cycles = 0;
+  head_stall_cycle = 0;
+
+  // Initialize the top-down CPI stack.
+  dispatch_slots = TD_FE_FQ_EMPTY;
+  recovering = false;
+
+  // Initialize periodic sampling.
+  sample_start_cycle = 0;
+  sample_start_insn = 0;
+  sample_start_br_miss = 0;
+  sample_start_ld_miss = 0;
+  sample_total_cycles = 0;
+  sample_total_insn = 0;
 
 
   /////////////////////////////////////////////////////////////
@@ -121,21 +146,27 @@ pipeline_t::pipeline_t(
   /////////////////////////////////////////////////////////////
   // Statistics unit
   /////////////////////////////////////////////////////////////
-  time_t now = time(0);
-  tm *ltm = localtime(&now);
-  char tempstr[1024];
+  // Log names are deterministic: <x>.<log_name>.log (see --name).
+  std::string name = (log_name ? log_name : "run");
 
   // stats must be constructed first as other classes use them
   this->stats = &statsModule;
-  #define OPEN_LOG_FILE(x) (sprintf(tempstr, "%s.%d-%02d-%02d.%02d:%02d:%02d.log", (x),               \
-                                             (ltm->tm_year - 100), (1 + ltm->tm_mon), (ltm->tm_mday), \
-                                             (ltm->tm_hour), (ltm->tm_min), (ltm->tm_sec)),           \
-                                             fopen(tempstr, "w"))
-  this->stats_log = OPEN_LOG_FILE("stats");
-  this->phase_log = OPEN_LOG_FILE("phase");
-  #undef OPEN_LOG_FILE
+  this->stats_log_name = "stats." + name + ".log";
+  this->stats_log = fopen(stats_log_name.c_str(), "w");
+  this->phase_log = fopen(("phase." + name + ".log").c_str(), "w");
   stats->set_log_files(stats_log, phase_log);
   stats->set_phase_interval("commit_count", phase_interval);
+  stats->set_topdown_width(dispatch_width);
+  stats->set_pc_profile_file(PC_PROFILE_FILE);
+
+  // Structured stats (--stats=json): the phases go to a binary time series
+  // and the final stats to a JSON document, written by the destructor.
+  this->phase_series = NULL;
+  if (structured_stats) {
+    this->json_stats_name = "stats." + name + ".json";
+    this->phase_series = fopen(("phase." + name + ".bin").c_str(), "wb");
+    stats->set_phase_series(phase_series);
+  }
 
   /////////////////////////////////////////////////////////////
   // Fetch unit.
@@ -158,7 +189,9 @@ pipeline_t::pipeline_t(
                         L2_MISS_SRV_LATENCY,
                         this,
                         "l2_c",
-                        NULL);
+                        NULL,
+                        L2_REPL,
+                        L2_PREFETCHER);
   } else {
     L2C = NULL;
   }
@@ -173,10 +206,81 @@ pipeline_t::pipeline_t(
                         L1_IC_MISS_SRV_LATENCY,
                         this,
                         "l1_ic",
-                        L2C);
+                        L2C,
+                        L1_IC_REPL);
 
   LSU.set_l2_cache(L2C);
 
+  /////////////////////////////////////////////////////////////
+  // Fetch Target Queue of the decoupled front-end.
+  // With perfect branch prediction, the Fetch Stage consults
+  // the functional simulator, so the front-end stays coupled.
+  /////////////////////////////////////////////////////////////
+  ftq_size = (PERFECT_BRANCH_PRED ? 0 : FTQ_SIZE);
+  FTQ = NULL;
+  if (ftq_size) {
+     FTQ = new ftq_block_t[ftq_size];
+     for (i = 0; i < ftq_size; i++)
+        FTQ[i].insn = new ftq_insn_t[fetch_width];
+  }
+  ftq_head = 0;
+  ftq_tail = 0;
+  ftq_length = 0;
+  bpu_pc = pc;
+  bpu_stalled = false;
+
+  /////////////////////////////////////////////////////////////
+  // Uop cache and loop buffer.
+  /////////////////////////////////////////////////////////////
+  UC = (UOP_CACHE_SETS ? new UopCacheClass(UOP_CACHE_SETS, UOP_CACHE_ASSOC, fetch_width, UOP_CACHE_BLOCKS) : NULL);
+  LB = (LOOP_BUFFER_SIZE ? new LoopBufferClass(LOOP_BUFFER_SIZE) : NULL);
+
+  /////////////////////////////////////////////////////////////
+  // Shadow branch predictors.
+  /////////////////////////////////////////////////////////////
+  SB = (NUM_SHADOW_BP ? new ShadowBpredClass(NUM_SHADOW_BP, SHADOW_BP) : NULL);
+
+  /////////////////////////////////////////////////////////////
+  // Memory dependence predictor.
+  /////////////////////////////////////////////////////////////
+  MDP = (MEM_DEP_PRED ? new StoreSetsClass(MDP_SSIT_SIZE, MDP_LFST_SIZE, MDP_CLEAR_INTERVAL) : NULL);
+
+  /////////////////////////////////////////////////////////////
+  // Value predictor.
+  /////////////////////////////////////////////////////////////
+  VP = (strcmp(VALUE_PRED, "none") ? new ValuePredClass(VALUE_PRED, VP_TABLE_SIZE) : NULL);
+
+  /////////////////////////////////////////////////////////////
+  // Delinquent-load profiler.
+  /////////////////////////////////////////////////////////////
+  MP = (MISS_PROF_TOP ? new MissProfClass(MISS_PROF_TOP, MISS_PROF_REGION, L1_DC_LINE_SIZE, MISS_PROF_FILE) : NULL);
+
+  /////////////////////////////////////////////////////////////
+  // Critical-path analysis.
+  /////////////////////////////////////////////////////////////
+  CP = (CRIT_PATH_WINDOW ? new CritPathClass(CRIT_PATH_WINDOW, rob_size, (NXPR + NFPR + rob_size)) : NULL);
+
+  /////////////////////////////////////////////////////////////
+  // Reuse-distance profiler: by default, of each distinct cache line size.
+  /////////////////////////////////////////////////////////////
+  RD = NULL;
+  if (REUSE_DIST_SAMPLING) {
+    std::vector<unsigned int> lines(REUSE_DIST_LINES, (REUSE_DIST_LINES + REUSE_DIST_NUM_LINES));
+    if (lines.empty()) {
+      unsigned int cache_lines[] = {L1_IC_LINE_SIZE, L1_DC_LINE_SIZE, L2_LINE_SIZE};
+      for (unsigned int k = 0; k < 3; k++)
+        if (std::find(lines.begin(), lines.end(), cache_lines[k]) == lines.end())
+          lines.push_back(cache_lines[k]);
+    }
+    RD = new ReuseDistClass(REUSE_DIST_SAMPLING, lines);
+    mrc_name = "mrc." + name + ".csv";
+  }
+
+  for (i = 0; i < FETCH_SOURCES; i++) {
+     fetch_bundles[i] = 0;
+     fetch_insns[i] = 0;
+  }
+
   /////////////////////////////////////////////////////////////
   // Pipeline register between the Fetch and Decode Stages.
   /////////////////////////////////////////////////////////////
@@ -250,7 +354,23 @@ pipeline_t::pipeline_t(
   fprintf(stats_log, "ORACLE_DISAMBIG     = %d\n", (ORACLE_DISAMBIG ? 1 : 0));
 
   fprintf(stats_log, "\n=== STRUCTURES AND POLICIES =====================================================\n\n");
+  fprintf(stats_log, "FUNCTIONAL WARMING = %d\n", (functional_warming ? 1 : 0));
+  if (sample_period) {
+    fprintf(stats_log, "SAMPLING:\n");
+    fprintf(stats_log, "   PERIOD = %lu\n", sample_period);
+    fprintf(stats_log, "   DETAILED WARM-UP = %lu\n", sample_warmup);
+    fprintf(stats_log, "   MEASURED WINDOW = %lu\n", sample_window);
+    fprintf(stats_log, "   PARALLEL JOBS = %u\n", fork_jobs);
+  }
   fprintf(stats_log, "FETCH QUEUE = %d\n", fq_size);
+  if (ftq_size) {
+    fprintf(stats_log, "FETCH TARGET QUEUE = %d\n", ftq_size);
+    fprintf(stats_log, "   FDIP PREFETCHES/CYCLE = %d\n", FTQ_PREFETCHES);
+  }
+  if (UC)
+    fprintf(stats_log, "UOP CACHE = %d sets x %d traces, %d blocks/trace\n", UOP_CACHE_SETS, UOP_CACHE_ASSOC, UOP_CACHE_BLOCKS);
+  if (LB)
+    fprintf(stats_log, "LOOP BUFFER = %d\n", LOOP_BUFFER_SIZE);
   fprintf(stats_log, "RENAMER:\n");
   fprintf(stats_log, "   ACTIVE LIST = %d\n", rob_size);
   fprintf(stats_log, "   PHYSICAL REGISTER FILE = %d\n", (NXPR + NFPR + rob_size));
@@ -264,7 +384,12 @@ pipeline_t::pipeline_t(
   fprintf(stats_log, "   LOAD QUEUE = %d\n", lq_size);
   fprintf(stats_log, "   STORE QUEUE = %d\n", sq_size);
   fprintf(stats_log, "   SPECULATIVE DISAMBIGUATION = %d\n", SPEC_DISAMBIG);
-  fprintf(stats_log, "   USE STICKY-BIT MEMORY DEPENDENCE PREDICTOR = %d\n", MEM_DEP_PRED);
+  fprintf(stats_log, "   USE STORE-SET MEMORY DEPENDENCE PREDICTOR = %d\n", MEM_DEP_PRED);
+  if (MEM_DEP_PRED)
+    fprintf(stats_log, "      SSIT = %d, LFST = %d, CLEAR INTERVAL = %lu\n", MDP_SSIT_SIZE, MDP_LFST_SIZE, MDP_CLEAR_INTERVAL);
+  fprintf(stats_log, "VALUE PREDICTOR = %s\n", VALUE_PRED);
+  if (VP)
+    fprintf(stats_log, "   TABLE SIZE = %d\n", VP_TABLE_SIZE);
 
   fprintf(stats_log, "\n=== PIPELINE STAGE WIDTHS =======================================================\n\n");
   fprintf(stats_log, "FETCH WIDTH = %d\n", fetch_width);
@@ -290,20 +415,30 @@ pipeline_t::pipeline_t(
 
   fprintf(stats_log, "L1 I$:\n");
   print_cache_config(stats_log, L1_IC_SETS, L1_IC_ASSOC, (1<<L1_IC_LINE_SIZE), L1_IC_HIT_LATENCY, L1_IC_NUM_MHSRs);
+  fprintf(stats_log, "   replacement = %s\n", L1_IC_REPL);
   if (!L2_PRESENT) fprintf(stats_log, "   miss latency = %d cycles\n", L1_IC_MISS_LATENCY);
 
   fprintf(stats_log, "L1 D$:\n");
   print_cache_config(stats_log, L1_DC_SETS, L1_DC_ASSOC, (1<<L1_DC_LINE_SIZE), L1_DC_HIT_LATENCY, L1_DC_NUM_MHSRs);
+  fprintf(stats_log, "   replacement = %s\n", L1_DC_REPL);
+  fprintf(stats_log, "   prefetcher = %s\n", L1_DC_PREFETCHER);
   if (!L2_PRESENT) fprintf(stats_log, "   miss latency = %d cycles\n", L1_DC_MISS_LATENCY);
 
+  if (strcmp(L1_DC_PREFETCHER, "none") || (L2_PRESENT && strcmp(L2_PREFETCHER, "none")))
+     fprintf(stats_log, "Prefetch degree = %u\n", PREFETCH_DEGREE);
+
   if (L2_PRESENT) {
      fprintf(stats_log, "L2$:\n");
      print_cache_config(stats_log, L2_SETS, L2_ASSOC, (1<<L2_LINE_SIZE), L2_HIT_LATENCY, L2_NUM_MHSRs);
+     fprintf(stats_log, "   replacement = %s\n", L2_REPL);
+     fprintf(stats_log, "   prefetcher = %s\n", L2_PREFETCHER);
      fprintf(stats_log, "   miss latency = %d cycles\n", L2_MISS_LATENCY);
   }
 
   fprintf(stats_log, "\n=== BRANCH PREDICTOR ============================================================\n\n");
   BP.dump_config(stats_log);
+  for (i = 0; i < NUM_SHADOW_BP; i++)
+    fprintf(stats_log, "SHADOW PREDICTOR %u = %s\n", i, SHADOW_BP[i]);
 
   fprintf(stats_log, "\n=== END CONFIGURATION ===========================================================\n\n");
 
@@ -318,6 +453,18 @@ pipeline_t::pipeline_t(
   //REN_INT->set_stats(get_stats());
   BP.set_stats(get_stats());
 
+  // Occupancy histograms, in sample_occupancy()'s order.
+  add_occupancy("active list", rob_size);
+  add_occupancy("issue queue", iq_size);
+  if (iq_num_parts > 1) {
+    for (i = 0; i < iq_num_parts; i++)
+      add_occupancy("iq partition " + std::to_string(i), (iq_size / iq_num_parts));
+  }
+  add_occupancy("load queue", lq_size);
+  add_occupancy("store queue", sq_size);
+  add_occupancy("fetch queue", fq_size);
+  add_occupancy("payload buffer", PAYLOAD_BUFFER_SIZE);
+
   ///////////////////////////////////////////////////
   // Set up the memory system.
   ///////////////////////////////////////////////////
@@ -335,6 +482,7 @@ pipeline_t::~pipeline_t()
   stats->dump_rates();
   stats->dump_pc_histogram();
   stats->dump_br_histogram();
+  stats->dump_topdown();
 #ifdef RISCV_ENABLE_HISTOGRAM
   if (histogram_enabled)
   {
@@ -346,6 +494,43 @@ pipeline_t::~pipeline_t()
 #endif
 
   BP.dump_stats(stats_log);
+  if (SB)
+    SB->Print(stats_log, num_insn);
+  dump_fetch_stats(stats_log);
+  dump_occupancy(stats_log);
+
+  if (!PERFECT_ICACHE)
+    IC->dump_stats(stats_log);
+  if (!PERFECT_DCACHE)
+    LSU.dump_cache_stats(stats_log);
+  if (MDP)
+    MDP->Print(stats_log);
+  if (VP)
+    VP->Print(stats_log);
+  if (MP)
+    MP->Print(stats_log);
+  if (CP)
+    CP->Print(stats_log);
+  if (RD)
+    RD->Print(stats_log, num_insn, (mrc_name.empty() ? NULL : mrc_name.c_str()));
+  if (L2C)
+    L2C->dump_stats(stats_log);
+
+  if (sample_period)
+    dump_samples(stats_log);
+
+  host_prof.Print(stats_log, num_insn);
+
+  if (!json_stats_name.empty())
+    write_json_stats();
+  if (phase_series)
+    fclose(phase_series);
+  for (size_t k = 0; k < occupancy.size(); k++)
+    delete occupancy[k].hist;
+
+  // The complete stats supersede the partial stats.
+  if (HEARTBEAT_INTERVAL && !stats_log_name.empty())
+    unlink((stats_log_name + ".partial").c_str());
 
   #ifdef RISCV_MICRO_DEBUG
     fclose(this->fetch_log    );
@@ -469,9 +654,12 @@ bool pipeline_t::step_micro(size_t n,size_t& instret)
 
         size_t lane_number;
 
+        host_prof.Cycle();
+
         unsigned int prev_commit_count = counter(commit_count);
+        uint64_t prev_num_insn = num_insn;
         for (lane_number = 0; lane_number < RETIRE_WIDTH; lane_number++) {
-          retire(instret);            // Retire Stage
+          HOST_PROF_CALL(HP_RETIRE, retire(instret));            // Retire Stage
           update_timer(&state, instret-prev_instret);
           prev_instret = instret;
           // Halt retirement if its time for an HTIF tick as this will change state
@@ -491,27 +679,33 @@ bool pipeline_t::step_micro(size_t n,size_t& instret)
 
         //REN_INT->dump_al(this,PAY,2,regread_log);
         for (lane_number = 0; lane_number < ISSUE_WIDTH; lane_number++) {
-          writeback(lane_number);    // Writeback Stage
+          HOST_PROF_CALL(HP_WRITEBACK, writeback(lane_number));    // Writeback Stage
         }
-        load_replay();
+        HOST_PROF_CALL(HP_LOAD_REPLAY, load_replay());
         for (lane_number = 0; lane_number < ISSUE_WIDTH; lane_number++) {
-          execute(lane_number);    // Execute Stage
+          HOST_PROF_CALL(HP_EXECUTE, execute(lane_number));    // Execute Stage
         }
         for (lane_number = 0; lane_number < ISSUE_WIDTH; lane_number++) {
-          register_read(lane_number);    // Register Read Stage
+          HOST_PROF_CALL(HP_REGISTER_READ, register_read(lane_number));    // Register Read Stage
         }
-        schedule();           // Schedule Stage
-        dispatch();           // Dispatch Stage
-        rename2();            // Rename Stage
-        rename1();            // Rename Stage
-        decode();             // Decode Stage
+        HOST_PROF_CALL(HP_SCHEDULE, schedule());           // Schedule Stage
+        HOST_PROF_CALL(HP_DISPATCH, dispatch());           // Dispatch Stage
+        HOST_PROF_CALL(HP_RENAME2, rename2());            // Rename Stage
+        HOST_PROF_CALL(HP_RENAME1, rename1());            // Rename Stage
+        HOST_PROF_CALL(HP_DECODE, decode());             // Decode Stage
         //// FETCH will insert NOPs instead of fetching real instructions
         //// from cache if a fetch_exception is pending. This is to make
         //// dispatch never gets stalled due to the absense of a full bundle
         //// in the FETCH QUEUS.his is sort of like a stall.
         //if(!fetch_exception){
-          fetch();            // Fetch Stage
+          HOST_PROF_CALL(HP_FETCH, fetch());            // Fetch Stage
         //}
+        if (ftq_size)
+          HOST_PROF_CALL(HP_PREDICT, predict());          // Branch Prediction Stage
+
+        // Classify this cycle's dispatch slots.
+        topdown_account(num_insn - prev_num_insn);
+        sample_occupancy();
 
         /////////////////////////////////////////////////////////////
         // Miscellaneous stuff that must be processed every cycle.
@@ -521,11 +715,12 @@ bool pipeline_t::step_micro(size_t n,size_t& instret)
         //next_cycle();
         cycle++;
         inc_counter(cycle_count);
+        if (MDP)
+          MDP->Tick(cycle);
 
         if(cycle > (uint64_t)logging_on_at)
           logging_on = true;
 
-	static uint64_t grading_plateau = 1000;
 	if (num_insn >= grading_plateau) {
 	   INFO("GRADING PLATEAU: %lu", grading_plateau);
 	   grading_plateau *= 10;
@@ -540,7 +735,6 @@ bool pipeline_t::step_micro(size_t n,size_t& instret)
           //stats->dump_counters();
           //stats->dump_rates();
 
-	  static uint64_t num_insn_last_beat = 0;
 	  if (num_insn == num_insn_last_beat) {
 	     INFO("DEADLOCK.");
 	     assert(0);
@@ -548,6 +742,14 @@ bool pipeline_t::step_micro(size_t n,size_t& instret)
 	  num_insn_last_beat = num_insn;
         }
 
+        // Heartbeat: host throughput, ETA, and partial stats.
+        if (HEARTBEAT_INTERVAL && (MOD(cycle, 0x10000) == 0))
+          heartbeat();
+
+        // Stats requested by a signal.
+        if (unlikely(stats_snapshot_requested || stats_phase_reset_requested))
+          service_stats_signals();
+
         // If this was an idle cycle break so that HTIF may have a chance to tick
         if(!instret)
           break;
@@ -580,6 +782,186 @@ bool pipeline_t::step_micro(size_t n,size_t& instret)
   return false;
 }
 
+// Occupancy histograms of the window structures, sampled every cycle
+// after topdown_account(), and printed in the OCCUPANCY section.
+void pipeline_t::add_occupancy(const std::string& name, unsigned int capacity) {
+   occupancy_t o;
+   o.name = name;
+   o.capacity = capacity;
+   o.hist = new HistogramClass(capacity + 1);
+   occupancy.push_back(o);
+}
+
+void pipeline_t::sample_occupancy() {
+   unsigned int k = 0;
+
+   occupancy[k++].hist->Increment(REN->active_list_length());
+   occupancy[k++].hist->Increment(IQ.occupancy());
+   if (IQ.partitions() > 1) {
+      for (unsigned int p = 0; p < IQ.partitions(); p++)
+         occupancy[k++].hist->Increment(IQ.part_occupancy(p));
+   }
+   occupancy[k++].hist->Increment(LSU.lq_occupancy());
+   occupancy[k++].hist->Increment(LSU.sq_occupancy());
+   occupancy[k++].hist->Increment(FQ.occupancy());
+   occupancy[k++].hist->Increment(PAY.length);
+   assert(k == occupancy.size());
+
+   if (!PERFECT_ICACHE)
+      IC->SampleMHSRs(cycle);
+   if (!PERFECT_DCACHE)
+      LSU.get_dcache()->SampleMHSRs(cycle);
+   if (L2C)
+      L2C->SampleMHSRs(cycle);
+}
+
+void pipeline_t::dump_occupancy(FILE* fp) {
+   fprintf(fp, "\n=== OCCUPANCY ===================================================================\n\n");
+   fprintf(fp, "structure          capacity      avg    p10    p50    p90    p99     full\n");
+   for (size_t k = 0; k < occupancy.size(); k++) {
+      HistogramClass* h = occupancy[k].hist;
+      if (!h->Samples())
+         continue;
+      fprintf(fp, "%-18s %8u %8.2f %6d %6d %6d %6d %7.2f%%\n", occupancy[k].name.c_str(), occupancy[k].capacity,
+              h->Average(), h->Percentile(0.1), h->Percentile(0.5), h->Percentile(0.9), h->Percentile(0.99),
+              (100.0 * (double)h->Bin(occupancy[k].capacity) / (double)h->Samples()));
+   }
+   fprintf(fp, "(MHSR occupancy is reported with each cache.)\n");
+   fprintf(fp, "\n");
+   LSU.load_to_use_latency().Print(fp, "load-to-use latency", true);
+   fprintf(fp, "(cycles from a load's address to its value, beyond the load pipeline's hit latency)\n");
+}
+
+// Top-down CPI stack: charges this cycle's dispatch slots to the Dispatch
+// Stage's outcome.  An empty Dispatch Stage is bad speculation while the
+// front-end refills after a squash, and otherwise frontend-bound.  A stalled
+// Dispatch Stage is backend-bound: charged to the memory hierarchy if the
+// oldest load is waiting for a miss, to functional-unit contention if ready
+// instructions could not issue, and otherwise to the full structure.
+void pipeline_t::topdown_account(unsigned int retired)
+{
+  topdown_t c = dispatch_slots;
+  bool l2_missed;
+
+  stats->update_topdown(TD_RETIRING, retired);
+  switch (c) {
+    case TD_DISPATCHED:
+      recovering = false;
+      break;
+
+    case TD_FE_FQ_EMPTY:
+      if (recovering)
+        c = TD_RECOVERY;
+      else if (cycle < next_fetch_cycle)
+        c = TD_FE_ICACHE;
+      break;
+
+    default:
+      if (LSU.head_load_missed(l2_missed))
+        c = (l2_missed ? TD_BE_L2 : TD_BE_DCACHE);
+      else if (IQ.lane_blocked())
+        c = TD_BE_FU;
+      break;
+  }
+  stats->update_topdown(c, dispatch_width);
+}
+
+// Functional simulation with functional warming, used by sim_t::run_fast().
+// Same as processor_t::step(), except that each committed instruction
+// also warms the microarchitectural state: fetches warm the I$, loads and
+// stores warm the D$ (and the L2 behind both), and control instructions
+// train the branch predictor.  With lockstep set, each instruction is also
+// matched against and popped from the debug buffer, so the functional
+// simulator feeding the checker advances in step.
+void pipeline_t::step_warm(size_t n, size_t& instret, bool lockstep)
+{
+  instret = 0;
+  pc = state.pc;
+
+  if (unlikely(!run || !n))
+    return;
+  n = std::min(n, next_timer(&state) | 1U);
+
+  insn_fetch_t fetch;
+  insn_t insn;
+  reg_t next_pc;
+  reg_t line = (reg_t)-1;
+
+  try
+  {
+    take_interrupt();
+
+    while (instret < n)
+    {
+      // Count excepting instructions too, as processor_t::step() does.
+      instret++;
+
+      if (!PERFECT_ICACHE && ((pc >> L1_IC_LINE_SIZE) != line)) {
+        line = (pc >> L1_IC_LINE_SIZE);
+        IC->Warm(Tid, (line << L1_IC_LINE_SIZE), false, pc);
+      }
+
+      #ifdef RISCV_MICRO_CHECKER
+        if (lockstep) {
+          pipe->pop(pipe->first(pc));
+        }
+      #endif
+
+      fetch = mmu->load_insn(pc);
+      insn = fetch.insn;
+
+      // Warm the D$ before executing, while the base register still holds its source value.
+      switch (insn.opcode()) {
+        case OP_LOAD:
+        case OP_LOAD_FP:
+          LSU.warm(state.XPR[insn.rs1()] + insn.i_imm(), false, pc);
+          break;
+        case OP_STORE:
+        case OP_STORE_FP:
+          LSU.warm(state.XPR[insn.rs1()] + insn.s_imm(), true, pc);
+          break;
+        case OP_AMO:
+          LSU.warm(state.XPR[insn.rs1()], true, pc);
+          break;
+        default:
+          break;
+      }
+
+      next_pc = execute_insn(this, pc, fetch);
+
+      if (SB)
+        SB->Train(pc, insn, next_pc, false);
+
+      if (!PERFECT_BRANCH_PRED) {
+        switch (insn.opcode()) {
+          case OP_JAL:
+            BP.warm(pc, insn, JUMP_TARGET, next_pc);
+            break;
+          case OP_JALR:
+            BP.warm(pc, insn, 0, next_pc);
+            break;
+          case OP_BRANCH:
+            BP.warm(pc, insn, BRANCH_TARGET, next_pc);
+            break;
+          default:
+            break;
+        }
+      }
+
+      pc = next_pc;
+    }
+  }
+  catch(trap_t& t)
+  {
+    pc = take_trap(t, pc);
+  }
+  catch(serialize_t& s) {
+  }
+
+  state.pc = pc;
+  update_timer(&state, instret);
+}
+
 reg_t pipeline_t::take_trap(trap_t& t, reg_t epc)
 {
   #ifdef RISCV_MICRO_DEBUG
@@ -656,6 +1038,345 @@ void pipeline_t::copy_state_to_micro() {
    }
 
    pc = get_state()->pc;
+   bpu_pc = pc;
+}
+
+void pipeline_t::drain() {
+   // The oldest instruction in the payload buffer, if any, is the next to retire.
+   reg_t next_pc = ((PAY.length > 0) ? PAY.buf[PAY.head].pc : pc);
+
+   // Squash all in-flight instructions. They will be re-executed functionally.
+   squash_complete(next_pc);
+   PAY.clear();
+
+   for (unsigned int i = 0; i < NXPR; i++){
+      get_state()->XPR.write(i, get_arch_reg_value(i));
+      get_state()->FPR.write(i, get_arch_reg_value(i+NXPR));
+   }
+
+   get_state()->pc = next_pc;
+}
+
+void pipeline_t::sample_begin() {
+   sample_start_cycle = cycle;
+   sample_start_insn = num_insn;
+   sample_start_br_miss = BP.stat_num_miss;
+   sample_start_ld_miss = LSU.get_load_miss_count();
+}
+
+void pipeline_t::sample_end() {
+   sample_add((cycle - sample_start_cycle),
+              (num_insn - sample_start_insn),
+              (BP.stat_num_miss - sample_start_br_miss),
+              (LSU.get_load_miss_count() - sample_start_ld_miss));
+}
+
+void pipeline_t::sample_add(cycle_t cycles, uint64_t insn, uint64_t br_miss, uint64_t ld_miss) {
+   assert(insn > 0);
+   sample_cpi.Add((double)cycles/(double)insn);
+   sample_br_mpki.Add(1000.0*(double)br_miss/(double)insn);
+   sample_ld_mpki.Add(1000.0*(double)ld_miss/(double)insn);
+
+   sample_total_cycles += cycles;
+   sample_total_insn += insn;
+}
+
+// Called by a forked child after sample_end(): the last window is the only one.
+void pipeline_t::sample_write(const char* file) {
+   FILE* fp = fopen(file, "w");
+   if (fp == NULL) {
+      perror(file);
+      return;
+   }
+   fprintf(fp, "%lu %lu %lu %lu\n",
+           (uint64_t)(cycle - sample_start_cycle),
+           (num_insn - sample_start_insn),
+           (uint64_t)(BP.stat_num_miss - sample_start_br_miss),
+           (uint64_t)(LSU.get_load_miss_count() - sample_start_ld_miss));
+   fclose(fp);
+}
+
+bool pipeline_t::sample_read(const char* file) {
+   uint64_t cycles, insn, br_miss, ld_miss;
+   FILE* fp = fopen(file, "r");
+   if (fp == NULL)
+      return false;
+   bool ok = (fscanf(fp, "%lu %lu %lu %lu", &cycles, &insn, &br_miss, &ld_miss) == 4) && (insn > 0);
+   fclose(fp);
+   if (ok)
+      sample_add(cycles, insn, br_miss, ld_miss);
+   return ok;
+}
+
+// Set by the SIGUSR1/SIGUSR2 handlers in main.cc.
+volatile sig_atomic_t stats_snapshot_requested = 0;
+volatile sig_atomic_t stats_phase_reset_requested = 0;
+
+static double host_seconds() {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec);
+}
+
+// Reports progress every HEARTBEAT_INTERVAL host seconds: simulated KIPS
+// (since the last heartbeat and overall), host time, ETA to the -e limit,
+// and peak memory use; then writes the partial stats, unless the logs
+// are redirected (see redirect_logs()).
+void pipeline_t::heartbeat() {
+   double now = host_seconds();
+   struct rusage usage;
+
+   if (!heartbeat_started) {
+      heartbeat_started = true;
+      heartbeat_start_time = now;
+      heartbeat_last_time = now;
+      heartbeat_last_insn = num_insn;
+      return;
+   }
+   if ((now - heartbeat_last_time) < (double)HEARTBEAT_INTERVAL)
+      return;
+
+   double elapsed = (now - heartbeat_start_time);
+   double kips = ((double)(num_insn - heartbeat_last_insn) / (now - heartbeat_last_time) / 1000.0);
+   double avg_kips = ((elapsed > 0.0) ? ((double)num_insn / elapsed / 1000.0) : 0.0);
+   getrusage(RUSAGE_SELF, &usage);
+
+   if (use_stop_amt && (avg_kips > 0.0)) {
+      uint64_t done = counter(commit_count);
+      double eta = ((done < stop_amt) ? ((double)(stop_amt - done) / (avg_kips * 1000.0)) : 0.0);
+      INFO("HEARTBEAT: cycle %" PRIcycle " num_insn %lu  %.1f KIPS (%.1f overall)  host %.0f s  ETA %.0f s (%.1f%% of %lu)  max RSS %ld MB",
+           cycle, num_insn, kips, avg_kips, elapsed, eta, (100.0 * (double)done / (double)stop_amt), stop_amt,
+           (usage.ru_maxrss >> 10));
+   }
+   else {
+      INFO("HEARTBEAT: cycle %" PRIcycle " num_insn %lu  %.1f KIPS (%.1f overall)  host %.0f s  max RSS %ld MB",
+           cycle, num_insn, kips, avg_kips, elapsed, (usage.ru_maxrss >> 10));
+   }
+
+   heartbeat_last_time = now;
+   heartbeat_last_insn = num_insn;
+   if (!stats_log_name.empty())
+      write_snapshot(stats_log_name + ".partial", false);
+}
+
+// Helpers for write_json_stats().
+static void json_param(JsonWriter& json, const param_t& p, unsigned int i) {
+   const char* key = ((p.count > 1) ? NULL : p.name);
+   switch (p.type) {
+      case PARAM_BOOL:   json.Bool(key, ((const bool*)p.addr)[i]); break;
+      case PARAM_UINT:   json.Uint(key, ((const unsigned int*)p.addr)[i]); break;
+      case PARAM_UINT64: json.Uint(key, ((const uint64_t*)p.addr)[i]); break;
+      case PARAM_STRING: json.String(key, ((const char* const*)p.addr)[i]); break;
+   }
+}
+
+static void json_cache(JsonWriter& json, const char* key, unsigned int sets, unsigned int assoc, unsigned int line_size) {
+   json.BeginObject(key);
+   json.Uint("sets", sets);
+   json.Uint("assoc", assoc);
+   json.Uint("line_bytes", (1 << line_size));
+   json.Uint("bytes", ((uint64_t)sets * assoc << line_size));
+   json.EndObject();
+}
+
+static void json_latency(JsonWriter& json, const char* key, LogHistogramClass& h) {
+   json.BeginObject(key);
+   json.Uint("samples", h.Samples());
+   json.Double("avg", h.Average());
+   json.Uint("p50", h.Percentile(0.5));
+   json.Uint("p90", h.Percentile(0.9));
+   json.Uint("p99", h.Percentile(0.99));
+   json.Uint("max", h.Max());
+   json.EndObject();
+}
+
+static void json_cache_stats(JsonWriter& json, const char* key, CacheClass* c) {
+   json.BeginObject(key);
+   json.Uint("hits", c->Hits());
+   json.Uint("misses", c->Misses());
+   json.Double("miss_rate", ((c->Hits() + c->Misses()) ? ((double)c->Misses() / (double)(c->Hits() + c->Misses())) : 0.0));
+   json.Double("busy_mhsrs_avg", (c->mhsrOccupancy->Samples() ? c->mhsrOccupancy->Average() : 0.0));
+   json_latency(json, "miss_latency", c->demandMissLatency);
+   json.EndObject();
+}
+
+// Structured stats (--stats=json): the configuration and the final stats as
+// one JSON document.  Like write_snapshot(), written to a temporary file and
+// renamed into place, so readers never see a partial document.
+void pipeline_t::write_json_stats() {
+   std::string tmp = json_stats_name + ".tmp";
+   FILE* fp = fopen(tmp.c_str(), "w");
+   if (!fp) {
+      INFO("Cannot write the JSON stats %s", json_stats_name.c_str());
+      return;
+   }
+
+   JsonWriter json(fp);
+   json.BeginObject();
+   json.String("name", log_name);
+
+   json.BeginObject("config");
+   json.BeginObject("parameters");
+   for (unsigned int i = 0; i < NUM_PARAMETERS; i++) {
+      const param_t& p = PARAMETERS[i];
+      if (p.count > 1) {
+         json.BeginArray(p.name);
+         for (unsigned int j = 0; j < p.count; j++) {
+            // Unused entries of string arrays (e.g., SHADOW_BP) are NULL.
+            if ((p.type != PARAM_STRING) || ((const char* const*)p.addr)[j])
+               json_param(json, p, j);
+         }
+         json.EndArray();
+      }
+      else {
+         json_param(json, p, 0);
+      }
+   }
+   json.EndObject();
+   json.BeginObject("caches");
+   if (!PERFECT_ICACHE)
+      json_cache(json, "L1I", L1_IC_SETS, L1_IC_ASSOC, L1_IC_LINE_SIZE);
+   if (!PERFECT_DCACHE)
+      json_cache(json, "L1D", L1_DC_SETS, L1_DC_ASSOC, L1_DC_LINE_SIZE);
+   if (L2C)
+      json_cache(json, "L2", L2_SETS, L2_ASSOC, L2_LINE_SIZE);
+   json.EndObject();
+   json.EndObject();
+
+   json.BeginObject("stats");
+   json.Uint("cycles", cycle);
+   json.Uint("num_insn", num_insn);
+   json.Double("ipc", (cycle ? ((double)num_insn / (double)cycle) : 0.0));
+   json.BeginObject("bpred");
+   json.Uint("predictions", BP.stat_num_pred);
+   json.Uint("mispredictions", BP.stat_num_miss);
+   json.Uint("cond_predictions", BP.stat_num_cond_pred);
+   json.Uint("cond_mispredictions", BP.stat_num_cond_miss);
+   json.Double("mpki", (num_insn ? (1000.0 * (double)BP.stat_num_miss / (double)num_insn) : 0.0));
+   json.EndObject();
+   json.BeginObject("caches");
+   if (!PERFECT_ICACHE)
+      json_cache_stats(json, "L1I", IC);
+   if (!PERFECT_DCACHE)
+      json_cache_stats(json, "L1D", LSU.get_dcache());
+   if (L2C)
+      json_cache_stats(json, "L2", L2C);
+   json.EndObject();
+   json.BeginObject("occupancy");
+   for (size_t k = 0; k < occupancy.size(); k++) {
+      HistogramClass* h = occupancy[k].hist;
+      json.BeginObject(occupancy[k].name.c_str());
+      json.Uint("capacity", occupancy[k].capacity);
+      json.Double("avg", (h->Samples() ? h->Average() : 0.0));
+      json.Uint("p50", h->Percentile(0.5));
+      json.Uint("p90", h->Percentile(0.9));
+      json.Uint("p99", h->Percentile(0.99));
+      json.Double("full", (h->Samples() ? ((double)h->Bin(occupancy[k].capacity) / (double)h->Samples()) : 0.0));
+      json.EndObject();
+   }
+   json.EndObject();
+   json_latency(json, "load_to_use_latency", LSU.load_to_use_latency());
+   if (CP) {
+      json.BeginObject("critical_path");
+      for (unsigned int e = 0; e < CP_EDGES; e++)
+         json.Uint(CP->Name((cp_edge_t)e), CP->Cycles((cp_edge_t)e));
+      json.EndObject();
+   }
+   stats->dump_json(json);
+   json.EndObject();
+
+   json.EndObject();
+
+   fflush(fp);
+   fsync(fileno(fp));
+   fclose(fp);
+   rename(tmp.c_str(), json_stats_name.c_str());
+}
+
+// Writes a snapshot of the counters (and, if bpred, the branch predictor's
+// stats) to file.  The snapshot is written to a temporary file and renamed,
+// so a job killed at any point leaves either the previous snapshot or the
+// new one.
+void pipeline_t::write_snapshot(const std::string& file, bool bpred) {
+   std::string tmp = file + ".tmp";
+   FILE* fp = fopen(tmp.c_str(), "w");
+   if (fp == NULL) {
+      perror(tmp.c_str());
+      return;
+   }
+   fprintf(fp, "[snapshot]\n");
+   fprintf(fp, "cycle : %" PRIcycle "\n", cycle);
+   fprintf(fp, "num_insn : %lu\n", num_insn);
+   if (heartbeat_started)
+      fprintf(fp, "host_seconds : %.0f\n", (host_seconds() - heartbeat_start_time));
+   stats->dump_snapshot(fp);
+   if (bpred)
+      BP.dump_stats(fp);
+   fflush(fp);
+   fsync(fileno(fp));
+   fclose(fp);
+   if (rename(tmp.c_str(), file.c_str()))
+      perror(file.c_str());
+}
+
+// Serves SIGUSR1 and SIGUSR2 (see main.cc) at a cycle boundary.  SIGUSR1
+// writes <stats file>.snapshot.<n>; SIGUSR2 starts a new phase.  Simulation
+// continues either way.
+void pipeline_t::service_stats_signals() {
+   if (stats_snapshot_requested) {
+      stats_snapshot_requested = 0;
+      if (!stats_log_name.empty()) {	// No snapshots if the logs are redirected.
+         std::string file = stats_log_name + ".snapshot." + std::to_string(num_snapshots++);
+         INFO("SIGUSR1: cycle %" PRIcycle " num_insn %lu: writing %s", cycle, num_insn, file.c_str());
+         write_snapshot(file, true);
+      }
+   }
+   if (stats_phase_reset_requested) {
+      stats_phase_reset_requested = 0;
+      INFO("SIGUSR2: cycle %" PRIcycle " num_insn %lu: resetting phase counters", cycle, num_insn);
+      stats->reset_phase_counters();
+   }
+}
+
+void pipeline_t::redirect_logs(const char* file) {
+   // No partial stats or snapshots either: their paths are derived from
+   // the stats log's, and must not be derived from the redirect target.
+   stats_log_name.clear();
+   stats_log = freopen(file, "w", stats_log);
+   phase_log = freopen(file, "w", phase_log);
+   stats->set_log_files(stats_log, phase_log);
+
+   // The structured stats and the binary profiles are redirected by not
+   // writing them.
+   json_stats_name.clear();
+   mrc_name.clear();
+   stats->set_pc_profile_file(NULL);
+   if (MP)
+      MP->DropMap();
+   if (phase_series) {
+      stats->set_phase_series(NULL);
+      fclose(phase_series);
+      phase_series = NULL;
+   }
+}
+
+void pipeline_t::dump_samples(FILE* fp) {
+   double cpi = sample_cpi.Average();
+   double ci = sample_cpi.Confidence(3.0);
+
+   fprintf(fp, "\n=== SAMPLING ====================================================================\n\n");
+   fprintf(fp, "samples:             %llu\n", sample_cpi.Samples());
+   fprintf(fp, "measured insn:       %lu\n", sample_total_insn);
+   fprintf(fp, "measured cycles:     %lu\n", (uint64_t)sample_total_cycles);
+   sample_cpi.Print(fp, "CPI");
+   sample_br_mpki.Print(fp, "BR_MPKI");
+   sample_ld_mpki.Print(fp, "LD_MPKI");
+   if (cpi > 0.0) {
+      fprintf(fp, "IPC estimate:        %.4f", 1.0/cpi);
+      if (cpi > ci)
+         fprintf(fp, "  (99.7%% CI: %.4f .. %.4f)", 1.0/(cpi + ci), 1.0/(cpi - ci));
+      fprintf(fp, "\n");
+   }
 }
 
 uint64_t pipeline_t::get_arch_reg_value(int reg_id) { 
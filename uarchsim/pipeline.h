@@ -8,7 +8,9 @@
 #include <cstring>
 #include <vector>
 #include <map>
+#include <string>
 #include <cassert>
+#include <csignal>
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -26,6 +28,15 @@
 
 #include "fetch_queue.h"	// FETCH QUEUE
 
+#include "ftq.h"		// FETCH TARGET QUEUE
+
+#include "uop_cache.h"		// UOP CACHE, LOOP BUFFER
+#include "shadow_bp.h"		// SHADOW BRANCH PREDICTORS
+#include "store_sets.h"		// MEMORY DEPENDENCE PREDICTOR
+#include "miss_prof.h"		// DELINQUENT-LOAD PROFILER
+#include "crit_path.h"		// CRITICAL-PATH ANALYSIS
+#include "reuse_dist.h"		// REUSE-DISTANCE PROFILER
+
 #include "renamer.h"		// REGISTER RENAMER + REGISTER FILE
 
 #include "lane.h"		// EXECUTION LANES
@@ -38,6 +49,10 @@
 
 #include "stats.h"
 
+#include "sample.h"
+
+#include "host_prof.h"		// HOST-TIME PROFILER
+
 //////////////////////////////////////////////////////////////////////////////
 
 /* instruction flags */
@@ -142,6 +157,11 @@
 //#endif
 //};
 
+// Set asynchronously by the SIGUSR1 (snapshot) and SIGUSR2 (reset phase
+// counters) handlers; polled by step_micro() at cycle boundaries.
+extern volatile sig_atomic_t stats_snapshot_requested;
+extern volatile sig_atomic_t stats_phase_reset_requested;
+
 
 // this class represents one processor in a RISC-V machine.
 class pipeline_t: public processor_t
@@ -173,6 +193,7 @@ public:
 	bool get_histogram(){return histogram_enabled;}
 //	void reset(bool value);
 	bool step_micro(size_t n, size_t& instret); // run for n cycles
+	void step_warm(size_t n, size_t& instret, bool lockstep=false);  // fast skip n instructions, warming caches and predictor
 //	void deliver_ipi(); // register an interprocessor interrupt
 //	bool running() {
 //		return run;
@@ -206,6 +227,19 @@ public:
   // Copy registers from fast skip state to pipeline register file.
   // Also reset the AMT.
   void copy_state_to_micro();
+
+  // Drain the pipeline and copy the architectural state back to the
+  // functional state, to switch from detailed to functional simulation.
+  void drain();
+
+  // Delimit a measured window of periodic sampling.
+  void sample_begin();
+  void sample_end();
+
+  // Hand a measured window over from a forked child to the parent.
+  void sample_write(const char* file);
+  bool sample_read(const char* file);
+  void redirect_logs(const char* file);
   uint64_t get_arch_reg_value(int reg_id); 
   uint64_t get_pc(){return get_state()->pc;}
   uint32_t get_instruction(uint64_t inst_pc);
@@ -272,6 +306,10 @@ private:
   FILE* stats_log;
   FILE* phase_log;
   FILE* cache_log;
+  std::string stats_log_name;	// Path of stats_log, for partial stats (--heartbeat); empty if redirected.
+  std::string json_stats_name;	// Path of the JSON stats (--stats=json), or empty.
+  FILE* phase_series;		// Binary phase time series (--stats=json), or NULL.
+  std::string mrc_name;		// Path of the miss-ratio curves (--reuse-dist), or empty.
 
   uint64_t sequence;
 
@@ -327,6 +365,37 @@ private:
 
 	CacheClass* IC;			// Instruction cache.
 
+	/////////////////////////////////////////////////////////////
+	// Decoupled front-end: the Branch Prediction Stage runs ahead
+	// of the Fetch Stage, filling the Fetch Target Queue (FTQ) with
+	// predicted fetch blocks, and prefetching their I$ lines (FDIP).
+	// Disabled (coupled fetch) if ftq_size is 0.
+	/////////////////////////////////////////////////////////////
+	unsigned int ftq_size;		// Number of fetch blocks in the FTQ.
+	ftq_block_t* FTQ;
+	unsigned int ftq_head;
+	unsigned int ftq_tail;
+	unsigned int ftq_length;
+	reg_t bpu_pc;			// Next PC to predict.
+	bool bpu_stalled;		// Predicted a trap, AMO, or SYSTEM instruction: wait for the redirect.
+
+	/////////////////////////////////////////////////////////////
+	// Fetch sources other than the I$ (NULL if disabled).
+	/////////////////////////////////////////////////////////////
+	UopCacheClass* UC;		// Decoded-uop (trace) cache.
+	LoopBufferClass* LB;		// Predecoded loop buffer.
+
+	/////////////////////////////////////////////////////////////
+	// Shadow branch predictors (NULL if none).
+	/////////////////////////////////////////////////////////////
+	ShadowBpredClass* SB;
+
+	// Fetch bandwidth: bundles and instructions fetched, by source.
+	enum {FETCH_IC, FETCH_UC, FETCH_LB, FETCH_SOURCES};
+	uint64_t fetch_bundles[FETCH_SOURCES];
+	uint64_t fetch_insns[FETCH_SOURCES];
+	void dump_fetch_stats(FILE* fp);
+
 	/////////////////////////////////////////////////////////////
 	// Pipeline register between the Fetch and Decode Stages.
 	/////////////////////////////////////////////////////////////
@@ -371,9 +440,29 @@ private:
 	lsu LSU;
 
 	/////////////////////////////////////////////////////////////
-	// Sticky-bit memory dependence predictor (MDP)
+	// Store-set memory dependence predictor (NULL if disabled).
+	/////////////////////////////////////////////////////////////
+	StoreSetsClass* MDP;
+
+	/////////////////////////////////////////////////////////////
+	// Value predictor (NULL if disabled).
+	/////////////////////////////////////////////////////////////
+	ValuePredClass* VP;
+
+	/////////////////////////////////////////////////////////////
+	// Delinquent-load profiler (NULL if disabled).
+	/////////////////////////////////////////////////////////////
+	MissProfClass* MP;
+
 	/////////////////////////////////////////////////////////////
-	std::map<uint64_t, bool> MDP;
+	// Critical-path analysis (NULL if disabled).
+	/////////////////////////////////////////////////////////////
+	CritPathClass* CP;
+
+	/////////////////////////////////////////////////////////////
+	// Reuse-distance profiler (NULL if disabled).
+	/////////////////////////////////////////////////////////////
+	ReuseDistClass* RD;
 	
 	//////////////////////
 	// PRIVATE FUNCTIONS
@@ -384,6 +473,9 @@ private:
 	void alu(unsigned int index);
 	void squash_complete(reg_t jump_PC);
 	void resolve(unsigned int branch_ID, bool correct);
+	void vp_validate(unsigned int index);
+	void vp_squash(unsigned int index);
+	void cp_retire(unsigned int index, bool mispredicted);
 	void checker();
 	void check_single(reg_t micro, reg_t isa, db_t* actual, const char *desc);
 	void check_double(reg_t micro0, reg_t micro1, reg_t isa0, reg_t isa1, const char *desc);
@@ -418,6 +510,21 @@ private:
 
   void phase_stats();
 
+  /////////////////////////////////////////////////////////////
+  // Periodic sampling.
+  /////////////////////////////////////////////////////////////
+  SampleClass sample_cpi;       // CPI of each measured window.
+  SampleClass sample_br_mpki;   // Branch mispredictions per 1000 instructions.
+  SampleClass sample_ld_mpki;   // Load misses per 1000 instructions.
+  cycle_t  sample_start_cycle;
+  uint64_t sample_start_insn;
+  uint64_t sample_start_br_miss;
+  uint64_t sample_start_ld_miss;
+  cycle_t  sample_total_cycles;
+  uint64_t sample_total_insn;
+  void sample_add(cycle_t cycles, uint64_t insn, uint64_t br_miss, uint64_t ld_miss);
+  void dump_samples(FILE* fp);
+
   bool execute_amo();
   bool execute_csr();
 
@@ -433,9 +540,57 @@ public:
 	uint64_t num_insn;
 	uint64_t num_insn_split;
 
+	// Progress monitoring in step_micro(): next grading plateau to report,
+	// and num_insn at the last deadlock check.
+	uint64_t grading_plateau;
+	uint64_t num_insn_last_beat;
+
+	// Heartbeat (--heartbeat): host time and progress at the start of
+	// detailed simulation and at the last heartbeat.
+	bool heartbeat_started;
+	double heartbeat_start_time;
+	double heartbeat_last_time;
+	uint64_t heartbeat_last_insn;
+	void heartbeat();
+	void write_snapshot(const std::string& file, bool bpred);
+	void write_json_stats();
+
+	// Stats requested by signals, served at a cycle boundary.
+	unsigned int num_snapshots;
+	void service_stats_signals();
+
+	// Per-PC profile (-g): cycles the current Active List head has stalled
+	// retirement, and the last cycle counted.
+	uint64_t head_stall_cycles;
+	cycle_t head_stall_cycle;
+
+	// Top-down CPI stack: the Dispatch Stage's outcome this cycle
+	// (TD_DISPATCHED or the reason it stalled), and whether the front-end
+	// is refilling after a squash.
+	topdown_t dispatch_slots;
+	bool recovering;
+	void topdown_account(unsigned int retired);
+
+	// Occupancy histograms of the window structures, sampled every cycle
+	// in the order they are added: Active List, IQ (and its partitions),
+	// LQ, SQ, fetch queue, payload buffer.  The caches sample their MHSRs.
+	struct occupancy_t {
+	  std::string name;
+	  unsigned int capacity;
+	  HistogramClass* hist;
+	};
+	std::vector<occupancy_t> occupancy;
+	void add_occupancy(const std::string& name, unsigned int capacity);
+	void sample_occupancy();
+	void dump_occupancy(FILE* fp);
+
 
 	// Functions for pipeline stages.
+	void predict();			// Branch Prediction Stage (decoupled front-end only).
 	void fetch();
+	void fetch_ftq();		// Fetch Stage of the decoupled front-end.
+	void ftq_prefetch();
+	void ftq_flush();
 	void decode();
 	void rename1();
 	void rename2();
@@ -0,0 +1,233 @@
+/*--------------------------------------------------------------------------*\
+ | prefetch.cc
+ |
+ | Hardware prefetchers attached to a CacheClass.  See prefetch.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
+#include "prefetch.h"
+
+PrefetcherClass::PrefetcherClass(int lineSize, unsigned int degree)
+	: lineSize(lineSize), degree(degree)
+{
+	assert((degree > 0) && (degree <= PREFETCH_MAX_DEGREE));
+}
+
+PrefetcherClass::~PrefetcherClass()
+{
+}
+
+/*--------------------------------------------------------------------------*\
+ | Next-line prefetcher.
+\*--------------------------------------------------------------------------*/
+
+class NextLinePFClass : public PrefetcherClass
+{
+public:
+	NextLinePFClass(int lineSize, unsigned int degree)
+		: PrefetcherClass(lineSize, degree)
+	{
+	}
+
+	const char* Name() { return("nextline"); }
+
+	unsigned int Train(reg_t pc, reg_t addr, bool trigger, reg_t* prefetch)
+	{
+		if (!trigger)
+			return(0);
+
+		reg_t line = (addr >> lineSize);
+		for (unsigned int i = 0; i < degree; i++)
+			prefetch[i] = ((line + i + 1) << lineSize);
+		return(degree);
+	}
+};
+
+/*--------------------------------------------------------------------------*\
+ | Stride prefetcher: a direct-mapped, PC-tagged reference prediction
+ |  table.  Each entry holds the last address and stride of its load, and
+ |  a 2-bit confidence counter that is incremented when the stride repeats
+ |  and decremented otherwise; the stride is replaced when confidence
+ |  reaches zero.  Prefetches are issued at confidence 2 or more.
+\*--------------------------------------------------------------------------*/
+
+#define RPT_SIZE	256
+#define RPT_CONF_MAX	3
+#define RPT_CONF_PF	2
+
+class StridePFClass : public PrefetcherClass
+{
+public:
+	StridePFClass(int lineSize, unsigned int degree)
+		: PrefetcherClass(lineSize, degree)
+	{
+		memset(rpt, 0, sizeof(rpt));
+	}
+
+	const char* Name() { return("stride"); }
+
+	unsigned int Train(reg_t pc, reg_t addr, bool trigger, reg_t* prefetch)
+	{
+		rpt_entry* e = &rpt[(pc >> 2) & (RPT_SIZE - 1)];
+		int64_t stride;
+		unsigned int n = 0;
+
+		if (pc == 0)
+			return(0);
+
+		if (e->pc != pc) {
+			e->pc = pc;
+			e->last = addr;
+			e->stride = 0;
+			e->conf = 0;
+			return(0);
+		}
+
+		stride = (int64_t)(addr - e->last);
+		// Same address: a replayed or repeated access.
+		if (stride == 0)
+			return(0);
+
+		if (stride == e->stride) {
+			if (e->conf < RPT_CONF_MAX)
+				e->conf++;
+		}
+		else {
+			if (e->conf > 0)
+				e->conf--;
+			if (e->conf == 0)
+				e->stride = stride;
+		}
+		e->last = addr;
+
+		if (e->conf >= RPT_CONF_PF) {
+			reg_t prev = (addr >> lineSize);
+			for (unsigned int i = 1; i <= degree; i++) {
+				reg_t line = ((addr + i * e->stride) >> lineSize);
+				if (line != prev)
+					prefetch[n++] = (line << lineSize);
+				prev = line;
+			}
+		}
+		return(n);
+	}
+
+private:
+	typedef struct {
+		reg_t pc;
+		reg_t last;
+		int64_t stride;
+		unsigned int conf;
+	} rpt_entry;
+
+	rpt_entry rpt[RPT_SIZE];
+};
+
+/*--------------------------------------------------------------------------*\
+ | Stream prefetcher.  Each of STREAMS trackers follows the misses within
+ |  STREAM_WINDOW lines of its last one.  A tracker is confirmed once two
+ |  consecutive misses move in the same direction; from then on each miss
+ |  in its window prefetches the next <degree> lines in that direction.
+ |  A miss outside all windows allocates the least-recently-used tracker.
+\*--------------------------------------------------------------------------*/
+
+#define STREAMS		16
+#define STREAM_WINDOW	16
+
+class StreamPFClass : public PrefetcherClass
+{
+public:
+	StreamPFClass(int lineSize, unsigned int degree)
+		: PrefetcherClass(lineSize, degree)
+	{
+		memset(stream, 0, sizeof(stream));
+		now = 0;
+	}
+
+	const char* Name() { return("stream"); }
+
+	unsigned int Train(reg_t pc, reg_t addr, bool trigger, reg_t* prefetch)
+	{
+		reg_t line = (addr >> lineSize);
+		stream_entry* s = NULL;
+		unsigned int i;
+		unsigned int n = 0;
+
+		if (!trigger)
+			return(0);
+
+		now++;
+		for (i = 0; (i < STREAMS) && !s; i++) {
+			int64_t delta = (int64_t)(line - stream[i].last);
+			if (stream[i].valid && (delta != 0) && (delta >= -STREAM_WINDOW) && (delta <= STREAM_WINDOW))
+				s = &stream[i];
+		}
+
+		if (!s) {
+			// Allocate the least-recently-used tracker.
+			s = &stream[0];
+			for (i = 0; i < STREAMS; i++) {
+				if (!stream[i].valid) {
+					s = &stream[i];
+					break;
+				}
+				if (stream[i].used < s->used)
+					s = &stream[i];
+			}
+			s->valid = true;
+			s->last = line;
+			s->dir = 0;
+			s->confirmed = false;
+			s->used = now;
+			return(0);
+		}
+
+		int dir = (((int64_t)(line - s->last) > 0) ? 1 : -1);
+		s->confirmed = (dir == s->dir);
+		s->dir = dir;
+		s->last = line;
+		s->used = now;
+
+		if (s->confirmed) {
+			for (i = 1; i <= degree; i++)
+				prefetch[n++] = ((line + (int64_t)dir * i) << lineSize);
+		}
+		return(n);
+	}
+
+private:
+	typedef struct {
+		bool valid;
+		bool confirmed;    /* Last two misses moved in direction dir.    */
+		int dir;           /* +1 ascending, -1 descending, 0 unknown.    */
+		reg_t last;        /* Line of the last miss.                     */
+		uint64_t used;     /* For LRU allocation.                        */
+	} stream_entry;
+
+	stream_entry stream[STREAMS];
+	uint64_t now;
+};
+
+static const char* const prefetcher_names[] = { "none", "nextline", "stride", "stream" };
+
+bool PrefetcherClass::Exists(const char* name)
+{
+	for (unsigned int i = 0; i < (sizeof(prefetcher_names) / sizeof(prefetcher_names[0])); i++)
+		if (!strcmp(name, prefetcher_names[i]))
+			return(true);
+	return(false);
+}
+
+PrefetcherClass* PrefetcherClass::Create(const char* name, int lineSize, unsigned int degree)
+{
+	if (!strcmp(name, "nextline"))
+		return(new NextLinePFClass(lineSize, degree));
+	else if (!strcmp(name, "stride"))
+		return(new StridePFClass(lineSize, degree));
+	else if (!strcmp(name, "stream"))
+		return(new StreamPFClass(lineSize, degree));
+	return(NULL);
+}
@@ -0,0 +1,68 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <cstdio>
+#include <cstdint>
+#include "decode.h"
+
+/*--------------------------------------------------------------------------*\
+ | prefetch.h
+ |
+ | Hardware prefetchers attached to a CacheClass.  The cache trains its
+ |  prefetcher on each demand access, and issues the line addresses it
+ |  returns as prefetches.
+ |
+ | Prefetchers (by name):
+ |  none      No prefetching.
+ |  nextline  On a miss (or first hit to a prefetched line), prefetch the
+ |             next <degree> lines.
+ |  stride    PC-indexed reference prediction table: once a load PC has
+ |             repeated the same address stride, prefetch <degree> strides
+ |             ahead of it.
+ |  stream    Tracks ascending or descending streams of misses; once a
+ |             stream's direction is confirmed, prefetch the next
+ |             <degree> lines along it.
+\*--------------------------------------------------------------------------*/
+
+#define PREFETCH_MAX_DEGREE	16
+
+class PrefetcherClass
+{
+public:
+	static PrefetcherClass* Create(const char* name, int lineSize, unsigned int degree);
+	/*------------------------------------------------------------------------*\
+	 | Creates the named prefetcher for a cache with (1<<lineSize)-byte
+	 |  lines.  Returns NULL for "none" or if there is no prefetcher by
+	 |  that name.
+	\*------------------------------------------------------------------------*/
+
+	static bool Exists(const char* name);
+	/*------------------------------------------------------------------------*\
+	 | Returns whether there is a prefetcher (or "none") by that name.
+	\*------------------------------------------------------------------------*/
+
+	PrefetcherClass(int lineSize, unsigned int degree);
+	virtual ~PrefetcherClass();
+
+	virtual const char* Name() = 0;
+
+	virtual unsigned int Train(reg_t pc, reg_t addr, bool trigger, reg_t* prefetch) = 0;
+	/*------------------------------------------------------------------------*\
+	 | Trains on a demand access.
+	 |
+	 |  pc                The instruction making the access (0 if unknown).
+	 |  addr              The address accessed.
+	 |  trigger           The access missed, or was the first to hit a
+	 |                     prefetched line.
+	 |  prefetch          Filled with the addresses to prefetch, at most
+	 |                     PREFETCH_MAX_DEGREE of them.
+	 |
+	 | Returns the number of addresses to prefetch.
+	\*------------------------------------------------------------------------*/
+
+protected:
+	int lineSize;          /* log2 of the cache's line size.               */
+	unsigned int degree;   /* Number of lines prefetched per trigger.      */
+};
+
+#endif //PREFETCH_H
@@ -138,6 +138,29 @@ void pipeline_t::rename2() {
 		PAY.buf[index].C_phys_reg=REN->rename_rdst(PAY.buf[index].C_log_reg);
 		//PAY.buf[index].C_phys_reg=temp;
 	}
+
+      // Record the instructions this one depends on, for critical-path analysis.
+      if (CP) {
+         PAY.buf[index].producer[0] = (PAY.buf[index].A_valid ? CP->Producer(PAY.buf[index].A_phys_reg) : CP_NO_PRODUCER);
+         PAY.buf[index].producer[1] = (PAY.buf[index].B_valid ? CP->Producer(PAY.buf[index].B_phys_reg) : CP_NO_PRODUCER);
+         PAY.buf[index].producer[2] = (PAY.buf[index].D_valid ? CP->Producer(PAY.buf[index].D_phys_reg) : CP_NO_PRODUCER);
+         PAY.buf[index].mem_producer = CP_NO_PRODUCER;
+         if (PAY.buf[index].C_valid)
+            CP->Produce(PAY.buf[index].C_phys_reg, PAY.buf[index].sequence);
+      }
+
+      // Consult the value predictor: loads and integer ALU instructions with a destination register are eligible.
+      // Conditional branches update its speculative global history with their predicted direction.
+      if (VP) {
+         bool load = IS_LOAD(PAY.buf[index].flags);
+         bool eligible = (PAY.buf[index].C_valid && !PAY.buf[index].split &&
+                          !IS_AMO(PAY.buf[index].flags) && !IS_CSR(PAY.buf[index].flags) &&
+                          ((PAY.buf[index].fu == FU_ALU_S) || (PAY.buf[index].fu == FU_ALU_C) ||
+                           ((PAY.buf[index].fu == FU_LS) && load)));
+         VP->Predict(PAY.buf[index].pc, eligible, load, &PAY.buf[index].vp);
+         if (PAY.buf[index].inst.opcode() == OP_BRANCH)
+            VP->Branch(PAY.buf[index].next_pc != INCREMENT_PC(PAY.buf[index].pc));
+      }
       // FIX_ME #4
       // Get the instruction's branch mask.
       //
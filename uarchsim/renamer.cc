@@ -152,6 +152,13 @@ uint64_t renamer::checkpoint()
 	return ID;	
 }
 
+uint64_t renamer::active_list_length()
+{
+	if(active_head==-1)
+		return 0;
+	return ((active_tail-active_head+size_list)%size_list)+1;
+}
+
 bool renamer::stall_dispatch(uint64_t bundle_inst)
 {
 	int size=0;
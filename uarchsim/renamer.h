@@ -308,6 +308,9 @@ public:
 	/////////////////////////////////////////////////////////////////////
 	bool stall_dispatch(uint64_t bundle_inst);
 
+	// Number of instructions in the Active List (occupancy histograms).
+	uint64_t active_list_length();
+
 	/////////////////////////////////////////////////////////////////////
 	// This function dispatches a single instruction into the Active
 	// List.
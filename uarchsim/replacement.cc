@@ -0,0 +1,414 @@
+/*--------------------------------------------------------------------------*\
+ | replacement.cc
+ |
+ | Replacement policies for the cache<T> array.  See replacement.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
+#include "replacement.h"
+
+ReplacementClass::ReplacementClass(unsigned int sets, unsigned int assoc)
+	: sets(sets), assoc(assoc)
+{
+}
+
+ReplacementClass::~ReplacementClass()
+{
+}
+
+void ReplacementClass::Print(FILE* fp)
+{
+}
+
+/*--------------------------------------------------------------------------*\
+ | True LRU.  Bit j of row[set*assoc+i] is set if way i was used more
+ |  recently than way j.  The LRU way is the one whose row is all zeros.
+\*--------------------------------------------------------------------------*/
+
+class LRUReplClass : public ReplacementClass
+{
+public:
+	LRUReplClass(unsigned int sets, unsigned int assoc)
+		: ReplacementClass(sets, assoc)
+	{
+		assert((assoc > 0) && (assoc <= 64));
+		allWays = ((assoc == 64) ? ~(uint64_t)0 : (((uint64_t)1 << assoc) - 1));
+		row = new uint64_t[sets * assoc];
+		Reset();
+	}
+
+	~LRUReplClass()
+	{
+		delete [] row;
+	}
+
+	const char* Name() { return("lru"); }
+
+	void Reset()
+	{
+		memset(row, 0, sizeof(uint64_t) * sets * assoc);
+	}
+
+	void Hit(unsigned int set, unsigned int way, reg_t pc)
+	{
+		Touch(set, way);
+	}
+
+	unsigned int Victim(unsigned int set)
+	{
+		uint64_t* r = &row[set * assoc];
+		for (unsigned int i = 0; i < assoc; i++)
+			if (r[i] == 0)
+				return(i);
+		assert(0);
+		return(0);
+	}
+
+	void Fill(unsigned int set, unsigned int way, reg_t pc)
+	{
+		Touch(set, way);
+	}
+
+private:
+	// Make 'way' the most-recently-used way of the set.
+	void Touch(unsigned int set, unsigned int way)
+	{
+		uint64_t* r = &row[set * assoc];
+		uint64_t bit = ((uint64_t)1 << way);
+		for (unsigned int i = 0; i < assoc; i++)
+			r[i] &= ~bit;
+		r[way] = (allWays & ~bit);
+	}
+
+	uint64_t* row;
+	uint64_t allWays;      /* One bit per way.                             */
+};
+
+/*--------------------------------------------------------------------------*\
+ | Tree pseudo-LRU.  The assoc-1 nodes of each set's binary tree are bits
+ |  1..assoc-1 of one word, heap-ordered (the children of node n are 2n and
+ |  2n+1).  A node's bit points to the half of its subtree to replace next.
+\*--------------------------------------------------------------------------*/
+
+class PLRUReplClass : public ReplacementClass
+{
+public:
+	PLRUReplClass(unsigned int sets, unsigned int assoc)
+		: ReplacementClass(sets, assoc)
+	{
+		assert((assoc > 0) && (assoc <= 64) && ((assoc & (assoc - 1)) == 0));
+		for (levels = 0; (1U << levels) < assoc; levels++)
+			;
+		tree = new uint64_t[sets];
+		Reset();
+	}
+
+	~PLRUReplClass()
+	{
+		delete [] tree;
+	}
+
+	const char* Name() { return("plru"); }
+
+	void Reset()
+	{
+		memset(tree, 0, sizeof(uint64_t) * sets);
+	}
+
+	void Hit(unsigned int set, unsigned int way, reg_t pc)
+	{
+		Touch(set, way);
+	}
+
+	unsigned int Victim(unsigned int set)
+	{
+		unsigned int node = 1;
+		unsigned int way = 0;
+		for (unsigned int l = 0; l < levels; l++) {
+			unsigned int dir = ((tree[set] >> node) & 1);
+			way = ((way << 1) | dir);
+			node = ((node << 1) | dir);
+		}
+		return(way);
+	}
+
+	void Fill(unsigned int set, unsigned int way, reg_t pc)
+	{
+		Touch(set, way);
+	}
+
+private:
+	// Point every node on the way's path away from it.
+	void Touch(unsigned int set, unsigned int way)
+	{
+		unsigned int node = 1;
+		for (unsigned int l = levels; l > 0; l--) {
+			unsigned int dir = ((way >> (l - 1)) & 1);
+			if (dir)
+				tree[set] &= ~((uint64_t)1 << node);
+			else
+				tree[set] |= ((uint64_t)1 << node);
+			node = ((node << 1) | dir);
+		}
+	}
+
+	uint64_t* tree;
+	unsigned int levels;   /* log2(assoc).                                 */
+};
+
+/*--------------------------------------------------------------------------*\
+ | Re-reference interval prediction (Jaleel et al., ISCA 2010), with 2-bit
+ |  re-reference prediction values (RRPVs) and hit-priority promotion.
+ |  The victim is the first way predicted to be re-referenced in the
+ |  distant future (RRPV_MAX), aging the whole set until there is one.
+ |
+ | SRRIP inserts at RRPV_MAX-1; BRRIP at RRPV_MAX, except every
+ |  BRRIP_PERIOD'th fill.  DRRIP dedicates leader sets to each, counts
+ |  their misses in a saturating PSEL counter, and follows the leader with
+ |  fewer misses in the remaining sets.
+\*--------------------------------------------------------------------------*/
+
+#define RRPV_MAX        3
+#define BRRIP_PERIOD    32
+#define PSEL_MAX        1023
+#define DUEL_LEADERS    32
+
+class RRIPReplClass : public ReplacementClass
+{
+public:
+	enum rrip_mode_t { SRRIP, BRRIP, DRRIP };
+
+	RRIPReplClass(unsigned int sets, unsigned int assoc, rrip_mode_t mode)
+		: ReplacementClass(sets, assoc), mode(mode)
+	{
+		rrpv = new unsigned char[sets * assoc];
+		// Leader sets: one of each kind per constituency of sets.
+		constituency = ((sets >= (2 * DUEL_LEADERS)) ? (sets / DUEL_LEADERS) : 2);
+		srripLeaderMisses = 0;
+		brripLeaderMisses = 0;
+		Reset();
+	}
+
+	~RRIPReplClass()
+	{
+		delete [] rrpv;
+	}
+
+	const char* Name()
+	{
+		return((mode == SRRIP) ? "srrip" : ((mode == BRRIP) ? "brrip" : "drrip"));
+	}
+
+	void Reset()
+	{
+		memset(rrpv, RRPV_MAX, sets * assoc);
+		brripFills = 0;
+		psel = (PSEL_MAX + 1) / 2;
+	}
+
+	void Hit(unsigned int set, unsigned int way, reg_t pc)
+	{
+		rrpv[set * assoc + way] = 0;
+	}
+
+	unsigned int Victim(unsigned int set)
+	{
+		unsigned char* r = &rrpv[set * assoc];
+		while (true) {
+			for (unsigned int i = 0; i < assoc; i++)
+				if (r[i] == RRPV_MAX)
+					return(i);
+			for (unsigned int i = 0; i < assoc; i++)
+				r[i]++;
+		}
+	}
+
+	void Fill(unsigned int set, unsigned int way, reg_t pc)
+	{
+		rrpv[set * assoc + way] = Insert(set);
+	}
+
+	void Print(FILE* fp)
+	{
+		if (mode == DRRIP) {
+			fprintf(fp, "   SRRIP leader misses = %lu\n", srripLeaderMisses);
+			fprintf(fp, "   BRRIP leader misses = %lu\n", brripLeaderMisses);
+			fprintf(fp, "   PSEL = %u (followers use %s)\n", psel, (BRRIPWins() ? "BRRIP" : "SRRIP"));
+		}
+	}
+
+protected:
+	// RRPV of a line filled into the set.
+	unsigned char Insert(unsigned int set)
+	{
+		bool bimodal;
+
+		switch (mode) {
+		case SRRIP:
+			bimodal = false;
+			break;
+		case BRRIP:
+			bimodal = true;
+			break;
+		default:
+			// Each fill is a miss: train PSEL on the leader sets.
+			if ((set % constituency) == 0) {
+				srripLeaderMisses++;
+				if (psel < PSEL_MAX)
+					psel++;
+				bimodal = false;
+			}
+			else if ((set % constituency) == 1) {
+				brripLeaderMisses++;
+				if (psel > 0)
+					psel--;
+				bimodal = true;
+			}
+			else {
+				bimodal = BRRIPWins();
+			}
+			break;
+		}
+
+		if (bimodal && ((brripFills++ % BRRIP_PERIOD) != 0))
+			return(RRPV_MAX);
+		return(RRPV_MAX - 1);
+	}
+
+	bool BRRIPWins()
+	{
+		return(psel > ((PSEL_MAX + 1) / 2));
+	}
+
+	unsigned char* rrpv;
+	rrip_mode_t mode;
+	unsigned int constituency;  /* Sets per pair of DRRIP leader sets.    */
+	unsigned int psel;          /* DRRIP policy selector.                  */
+	uint64_t brripFills;        /* For the BRRIP insertion throttle.       */
+	uint64_t srripLeaderMisses;
+	uint64_t brripLeaderMisses;
+};
+
+/*--------------------------------------------------------------------------*\
+ | Signature-based hit prediction (Wu et al., MICRO 2011), on SRRIP.  Each
+ |  line remembers a signature of the PC that filled it, and whether it
+ |  has been hit since.  The signature history counter table (SHCT) is
+ |  incremented on hits and decremented when a line is evicted without
+ |  having been hit; fills whose signature counter is zero are predicted
+ |  dead and inserted at RRPV_MAX.
+\*--------------------------------------------------------------------------*/
+
+#define SHCT_BITS       14
+#define SHCT_MAX        7
+
+class SHiPReplClass : public RRIPReplClass
+{
+public:
+	SHiPReplClass(unsigned int sets, unsigned int assoc)
+		: RRIPReplClass(sets, assoc, SRRIP)
+	{
+		shct = new unsigned char[1 << SHCT_BITS];
+		signature = new uint16_t[sets * assoc];
+		state = new unsigned char[sets * assoc];
+		deadFills = 0;
+		fills = 0;
+		Reset();
+	}
+
+	~SHiPReplClass()
+	{
+		delete [] shct;
+		delete [] signature;
+		delete [] state;
+	}
+
+	const char* Name() { return("ship"); }
+
+	void Reset()
+	{
+		RRIPReplClass::Reset();
+		memset(shct, 1, (1 << SHCT_BITS));
+		memset(state, 0, sets * assoc);
+	}
+
+	void Hit(unsigned int set, unsigned int way, reg_t pc)
+	{
+		unsigned int i = (set * assoc + way);
+		rrpv[i] = 0;
+		state[i] |= LINE_REUSED;
+		if (shct[signature[i]] < SHCT_MAX)
+			shct[signature[i]]++;
+	}
+
+	void Fill(unsigned int set, unsigned int way, reg_t pc)
+	{
+		unsigned int i = (set * assoc + way);
+
+		// Train on the evicted line.
+		if ((state[i] & LINE_VALID) && !(state[i] & LINE_REUSED) && (shct[signature[i]] > 0))
+			shct[signature[i]]--;
+
+		signature[i] = Signature(pc);
+		state[i] = LINE_VALID;
+		fills++;
+		if (shct[signature[i]] == 0) {
+			deadFills++;
+			rrpv[i] = RRPV_MAX;
+		}
+		else {
+			rrpv[i] = Insert(set);
+		}
+	}
+
+	void Print(FILE* fp)
+	{
+		fprintf(fp, "   fills predicted dead = %lu of %lu (%.2f%%)\n", deadFills, fills,
+		        (fills ? (100.0 * (double)deadFills / (double)fills) : 0.0));
+	}
+
+private:
+	static const unsigned char LINE_VALID  = 1;
+	static const unsigned char LINE_REUSED = 2;
+
+	uint16_t Signature(reg_t pc)
+	{
+		pc >>= 2;
+		return((uint16_t)((pc ^ (pc >> SHCT_BITS) ^ (pc >> (2 * SHCT_BITS))) & ((1 << SHCT_BITS) - 1)));
+	}
+
+	unsigned char* shct;
+	uint16_t* signature;
+	unsigned char* state;
+	uint64_t deadFills;
+	uint64_t fills;
+};
+
+static const char* const policy_names[] = { "lru", "plru", "srrip", "brrip", "drrip", "ship" };
+
+bool ReplacementClass::Exists(const char* name)
+{
+	for (unsigned int i = 0; i < (sizeof(policy_names) / sizeof(policy_names[0])); i++)
+		if (!strcmp(name, policy_names[i]))
+			return(true);
+	return(false);
+}
+
+ReplacementClass* ReplacementClass::Create(const char* name, unsigned int sets, unsigned int assoc)
+{
+	if (!strcmp(name, "lru"))
+		return(new LRUReplClass(sets, assoc));
+	else if (!strcmp(name, "plru"))
+		return(new PLRUReplClass(sets, assoc));
+	else if (!strcmp(name, "srrip"))
+		return(new RRIPReplClass(sets, assoc, RRIPReplClass::SRRIP));
+	else if (!strcmp(name, "brrip"))
+		return(new RRIPReplClass(sets, assoc, RRIPReplClass::BRRIP));
+	else if (!strcmp(name, "drrip"))
+		return(new RRIPReplClass(sets, assoc, RRIPReplClass::DRRIP));
+	else if (!strcmp(name, "ship"))
+		return(new SHiPReplClass(sets, assoc));
+	return(NULL);
+}
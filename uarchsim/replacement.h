@@ -0,0 +1,81 @@
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include <cstdio>
+#include <cstdint>
+#include "decode.h"
+
+/*--------------------------------------------------------------------------*\
+ | replacement.h
+ |
+ | Replacement policies for the cache<T> array.  The array tells the
+ |  policy about hits and fills, and asks it for a victim way on a miss.
+ |
+ | Policies (by name):
+ |  lru     True LRU (bit matrix).  At most 64 ways.
+ |  plru    Tree pseudo-LRU.  Ways must be a power of 2, at most 64.
+ |  srrip   Static re-reference interval prediction (2-bit RRPV,
+ |           hit-priority).
+ |  brrip   Bimodal RRIP: inserts at distant re-reference, except once
+ |           every 32 fills.
+ |  drrip   Set dueling between SRRIP and BRRIP.
+ |  ship    SRRIP with signature-based hit prediction (SHiP-PC): fills by
+ |           PCs whose lines are seldom reused insert at distant
+ |           re-reference.
+\*--------------------------------------------------------------------------*/
+
+class ReplacementClass
+{
+public:
+	static ReplacementClass* Create(const char* name, unsigned int sets, unsigned int assoc);
+	/*------------------------------------------------------------------------*\
+	 | Creates the named policy for a cache with the given number of sets
+	 |  and ways.  Returns NULL if there is no policy by that name.
+	\*------------------------------------------------------------------------*/
+
+	static bool Exists(const char* name);
+	/*------------------------------------------------------------------------*\
+	 | Returns whether there is a policy by that name.
+	\*------------------------------------------------------------------------*/
+
+	ReplacementClass(unsigned int sets, unsigned int assoc);
+	virtual ~ReplacementClass();
+
+	virtual const char* Name() = 0;
+	/*------------------------------------------------------------------------*\
+	 | Returns the policy's name, as given to Create().
+	\*------------------------------------------------------------------------*/
+
+	virtual void Reset() = 0;
+	/*------------------------------------------------------------------------*\
+	 | Returns the replacement state to that of an empty cache.
+	\*------------------------------------------------------------------------*/
+
+	virtual void Hit(unsigned int set, unsigned int way, reg_t pc) = 0;
+	/*------------------------------------------------------------------------*\
+	 | Updates the replacement state for a hit to a way.  pc is the
+	 |  instruction making the access (0 if unknown).
+	\*------------------------------------------------------------------------*/
+
+	virtual unsigned int Victim(unsigned int set) = 0;
+	/*------------------------------------------------------------------------*\
+	 | Selects the way to replace on a miss.  It is always filled next.
+	\*------------------------------------------------------------------------*/
+
+	virtual void Fill(unsigned int set, unsigned int way, reg_t pc) = 0;
+	/*------------------------------------------------------------------------*\
+	 | Updates the replacement state for a new line filled into a way,
+	 |  evicting the line that was there.
+	\*------------------------------------------------------------------------*/
+
+	virtual void Print(FILE* fp);
+	/*------------------------------------------------------------------------*\
+	 | Prints policy-specific statistics.
+	\*------------------------------------------------------------------------*/
+
+protected:
+	unsigned int sets;     /* Number of sets in the cache.                 */
+	unsigned int assoc;    /* Number of ways per set.                      */
+};
+
+#endif //REPLACEMENT_H
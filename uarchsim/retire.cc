@@ -49,6 +49,22 @@ void pipeline_t::retire(size_t& instret) {
 
 	head_valid=REN->precommit(completed, exception, load_viol, br_misp, val_misp, load, store, branch,amo, csr, offending_PC);
 
+   // Per-PC profile: charge each cycle that an incomplete head instruction
+   // blocks retirement to that instruction (once per cycle, since retire()
+   // is called RETIRE_WIDTH times per cycle).
+   if (histogram_enabled && head_valid) {
+      if (!completed) {
+         if (head_stall_cycle != cycle) {
+            head_stall_cycles++;
+            head_stall_cycle = cycle;
+         }
+      }
+      else if (head_stall_cycles) {
+         stats->get_pc_profile(PAY.buf[PAY.head].pc)->head_stall_cycles += head_stall_cycles;
+         head_stall_cycles = 0;
+      }
+   }
+
 
    if (head_valid && completed) {    // AL head exists and completed
 
@@ -94,6 +110,24 @@ void pipeline_t::retire(size_t& instret) {
             BP.verify_pred(PAY.buf[PAY.head].pred_tag, PAY.buf[PAY.head].c_next_pc, false);
          }
 
+         // Train the value predictor with the committed value, and its retired branch history.
+         if (VP) {
+            VP->Update(PAY.buf[PAY.head].pc, &PAY.buf[PAY.head].vp, PAY.buf[PAY.head].C_value.dw);
+            if (PAY.buf[PAY.head].inst.opcode() == OP_BRANCH)
+               VP->RetireBranch(PAY.buf[PAY.head].c_next_pc != INCREMENT_PC(PAY.buf[PAY.head].pc));
+         }
+
+         // Per-PC profile.
+         if (histogram_enabled) {
+            stats->update_pc_histogram(PAY.buf[PAY.head].pc);
+            if (branch)
+               stats->update_br_histogram(PAY.buf[PAY.head].pc, (PAY.buf[PAY.head].next_pc != PAY.buf[PAY.head].c_next_pc));
+         }
+
+         // Train the shadow branch predictors with the committed branch.
+         if (branch && SB)
+            SB->Train(PAY.buf[PAY.head].pc, PAY.buf[PAY.head].inst, PAY.buf[PAY.head].c_next_pc, true);
+
          // If FP op, cheat and copy the fflags from the functional simulator.
          // TODO: fflags should be (and can be) generated by the ALU. This was done to expedite porting of 721sim to RISCV from PISA.
          if (IS_FP_OP(PAY.buf[PAY.head].flags)) {
@@ -111,6 +145,11 @@ void pipeline_t::retire(size_t& instret) {
 	 if (PAY.buf[PAY.head].split && PAY.buf[PAY.head].upper)
             num_insn_split++;
 
+         if (CP)
+            cp_retire(PAY.head, (branch && (PAY.buf[PAY.head].next_pc != PAY.buf[PAY.head].c_next_pc)));
+         if (RD)
+            RD->Retire(PAY.buf[PAY.head].pc, (load || store), PAY.buf[PAY.head].addr);
+
 	 // Cases of complete pipeline squash after the head instruction.
 	 // 1. Atomic memory operation.
 	 // 2. System instruction.
@@ -130,6 +169,8 @@ void pipeline_t::retire(size_t& instret) {
 	    // Squash all instructions after it.
             squash_complete(next_inst_pc);
             inc_counter(recovery_count);
+            if (CP)
+               CP->Squash((br_misp || val_misp) ? CP_BRANCH : CP_SERIALIZE);
 
 	    // Pop the instruction from PAY.
 	    if (!PAY.buf[PAY.head].split) PAY.pop();
@@ -149,16 +190,16 @@ void pipeline_t::retire(size_t& instret) {
 	 // Therefore the load is incorrect and not committed.
          assert(load);
 
-         // If the simple sticky-bit memory dependence predictor is enabled,
-         // add the offending load to the predictor.
-	 if (MEM_DEP_PRED) {
-	    //assert(MDP.find(PAY.buf[PAY.head].pc) == MDP.end());
-	    MDP[PAY.buf[PAY.head].pc] = true;
-	 }
+         // If the store-set memory dependence predictor is enabled,
+         // put the offending load and store in one store set.
+	 if (MDP)
+	    MDP->Violation(PAY.buf[PAY.head].pc, PAY.buf[PAY.head].viol_store_pc);
 
          // Full squash, including the mispredicted load, and restart fetching from the load.
          squash_complete(offending_PC);
          inc_counter(recovery_count);
+         if (CP)
+            CP->Squash(CP_MEMORY);
 
          // Flush PAY.
          PAY.clear();
@@ -189,6 +230,10 @@ void pipeline_t::retire(size_t& instret) {
          checker();
 
          // Squash the pipeline.
+         if (CP) {
+            cp_retire(PAY.head, false);
+            CP->Squash(CP_SERIALIZE);
+         }
          squash_complete(jump_PC);
          inc_counter(recovery_count);
 
@@ -199,6 +244,25 @@ void pipeline_t::retire(size_t& instret) {
 }
 
 
+// Adds the retiring instruction to the critical-path analysis.
+void pipeline_t::cp_retire(unsigned int index, bool mispredicted) {
+   cp_insn_t insn;
+
+   insn.sequence = PAY.buf[index].sequence;
+   insn.fetch = PAY.buf[index].fetch_cycle;
+   insn.dispatch = PAY.buf[index].dispatch_cycle;
+   insn.issue = PAY.buf[index].issue_cycle;
+   insn.complete = PAY.buf[index].complete_cycle;
+   insn.retire = cycle;
+   for (unsigned int i = 0; i < 3; i++)
+      insn.producer[i] = PAY.buf[index].producer[i];
+   insn.mem_producer = PAY.buf[index].mem_producer;
+   insn.load = IS_LOAD(PAY.buf[index].flags);
+   insn.mispredicted = mispredicted;
+   CP->Retire(insn);
+}
+
+
 bool pipeline_t::execute_amo() {
    unsigned int index = PAY.head;
    insn_t inst = PAY.buf[index].inst;
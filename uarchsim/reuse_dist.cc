@@ -0,0 +1,292 @@
+/*--------------------------------------------------------------------------*\
+ | reuse_dist.cc
+ |
+ | Reuse-distance profiler.  See reuse_dist.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include "reuse_dist.h"
+
+#define RD_HASH_BITS	24
+
+// Cache sizes in the miss-ratio curves, and the set-associative organizations.
+#define RD_MIN_SIZE	1024ULL
+#define RD_MAX_SIZE	(1ULL << 30)
+static const unsigned int rd_assoc[] = {1, 2, 4, 8, 16};
+#define RD_ASSOCS	(sizeof(rd_assoc) / sizeof(rd_assoc[0]))
+
+static const char* rd_stream_names[RD_STREAMS] = {"inst", "data", "unified"};
+
+static inline uint64_t rd_hash(uint64_t line)
+{
+	return((line * 0x9e3779b97f4a7c15ULL) >> (64 - RD_HASH_BITS));
+}
+
+ReuseDistClass::Stack::Stack()
+{
+	size = (1ULL << 16);
+	now = 0;
+	tree = new int32_t[size + 1];
+	memset(tree, 0, ((size + 1) * sizeof(int32_t)));
+}
+
+ReuseDistClass::Stack::~Stack()
+{
+	delete [] tree;
+}
+
+void ReuseDistClass::Stack::Add(uint64_t t, int32_t n)
+{
+	for (uint64_t i = (t + 1); i <= size; i += (i & -i))
+		tree[i] += n;
+}
+
+uint64_t ReuseDistClass::Stack::Count(uint64_t t)
+{
+	int64_t n = 0;
+
+	for (uint64_t i = (t + 1); i > 0; i -= (i & -i))
+		n += tree[i];
+	return((uint64_t)n);
+}
+
+// Out of times: renumber the lines' latest references 0, 1, ..., in order,
+// and keep the tree at least twice the number of lines.
+void ReuseDistClass::Stack::Compact()
+{
+	std::vector<rd_line_t*> order = last.Select([](const rd_line_t* l) { return(true); },
+	                                            [](const rd_line_t* a, const rd_line_t* b) { return(a->time < b->time); });
+	uint64_t i, j;
+
+	while (size < (2 * order.size())) {
+		delete [] tree;
+		size *= 2;
+		tree = new int32_t[size + 1];
+	}
+	memset(tree, 0, ((size + 1) * sizeof(int32_t)));
+
+	for (i = 0; i < order.size(); i++) {
+		order[i]->time = i;
+		tree[i + 1] = 1;
+	}
+	// Linear-time build.
+	for (i = 1; i <= size; i++) {
+		j = (i + (i & -i));
+		if (j <= size)
+			tree[j] += tree[i];
+	}
+	now = order.size();
+}
+
+uint64_t ReuseDistClass::Stack::Reference(uint64_t line)
+{
+	uint64_t distance;
+	rd_line_t* l;
+	bool inserted;
+
+	if (now == size)
+		Compact();
+
+	l = last.Get(line, &inserted);
+	if (!inserted) {
+		// Lines referenced since, i.e., whose latest reference is more recent.
+		distance = (last.Used() - Count(l->time));
+		Add(l->time, -1);
+	}
+	else {
+		distance = RD_COLD;
+	}
+	l->time = now;
+	Add(now, 1);
+	now++;
+	return(distance);
+}
+
+ReuseDistClass::ReuseDistClass(unsigned int sampling, const std::vector<unsigned int>& logLineSizes)
+	: sampling(sampling)
+{
+	assert(sampling > 0);
+	threshold = ((1ULL << RD_HASH_BITS) / sampling);
+	for (size_t i = 0; i < logLineSizes.size(); i++) {
+		for (unsigned int s = 0; s < RD_STREAMS; s++) {
+			profile_t* p = new profile_t;
+			p->stream = (rd_stream_t)s;
+			p->lineShift = logLineSizes[i];
+			p->refs = 0;
+			p->sampled = 0;
+			p->cold = 0;
+			profiles.push_back(p);
+		}
+	}
+}
+
+ReuseDistClass::~ReuseDistClass()
+{
+	for (size_t i = 0; i < profiles.size(); i++)
+		delete profiles[i];
+}
+
+void ReuseDistClass::Reference(profile_t* p, uint64_t addr)
+{
+	uint64_t line = (addr >> p->lineShift);
+	uint64_t distance;
+
+	p->refs++;
+	if (rd_hash(line) >= threshold)
+		return;
+	p->sampled++;
+	distance = p->stack.Reference(line);
+	if (distance == RD_COLD)
+		p->cold++;
+	else
+		p->dist.Increment(distance * sampling);
+}
+
+void ReuseDistClass::Retire(uint64_t pc, bool mem, uint64_t addr)
+{
+	for (size_t i = 0; i < profiles.size(); i++) {
+		switch (profiles[i]->stream) {
+			case RD_INST:
+				Reference(profiles[i], pc);
+				break;
+			case RD_DATA:
+				if (mem)
+					Reference(profiles[i], addr);
+				break;
+			default:
+				Reference(profiles[i], pc);
+				if (mem)
+					Reference(profiles[i], addr);
+				break;
+		}
+	}
+}
+
+// Probability that fewer than assoc of d lines map to one set of sets.
+static double rd_set_hit(uint64_t d, uint64_t sets, unsigned int assoc)
+{
+	double p = (1.0 / (double)sets), term, sum;
+	unsigned int k;
+
+	if (d < assoc)
+		return(1.0);
+	term = exp((double)d * log1p(-p));	// k = 0
+	sum = term;
+	for (k = 0; (k + 1) < assoc; k++) {
+		term *= ((double)(d - k) / (double)(k + 1)) * (p / (1.0 - p));
+		sum += term;
+	}
+	return(std::min(sum, 1.0));
+}
+
+double ReuseDistClass::MissRatio(unsigned int i, uint64_t lines, unsigned int assoc)
+{
+	profile_t* p = profiles[i];
+	LogHistogramClass& h = p->dist;
+	uint64_t lo, hi, sets;
+	double hits = 0.0;
+
+	if (!p->sampled)
+		return(0.0);
+
+	sets = (assoc ? (lines / assoc) : 1);
+	for (unsigned int b = 0; b < LOG_HIST_BINS; b++) {
+		if (!h.Bin(b))
+			continue;
+		lo = LogHistogramClass::LowerBound(b);
+		hi = ((b == (LOG_HIST_BINS - 1)) ? h.Max() : (LogHistogramClass::LowerBound(b + 1) - 1));
+		if (!assoc || (sets == 1)) {
+			// Exact: the sizes are powers of two, hence bin boundaries.
+			if (hi < (assoc ? assoc : lines))
+				hits += (double)h.Bin(b);
+		}
+		else {
+			hits += ((double)h.Bin(b) * rd_set_hit(((lo + hi) / 2), sets, assoc));
+		}
+	}
+	return(1.0 - (hits / (double)p->sampled));
+}
+
+static void rd_print_size(FILE* fp, uint64_t bytes)
+{
+	if (bytes >= (1ULL << 20))
+		fprintf(fp, "%6luM", (bytes >> 20));
+	else
+		fprintf(fp, "%6luK", (bytes >> 10));
+}
+
+void ReuseDistClass::Print(FILE* fp, uint64_t insns, const char* mrcFile)
+{
+	FILE* csv = NULL;
+	uint64_t size, lines, footprint;
+	double ratio;
+	unsigned int i, a;
+
+	if (mrcFile) {
+		csv = fopen(mrcFile, "w");
+		if (csv)
+			fprintf(csv, "stream,line_bytes,size_bytes,assoc,miss_ratio,mpki\n");
+		else
+			fprintf(stderr, "Unable to write the miss-ratio curves to %s\n", mrcFile);
+	}
+
+	fprintf(fp, "\n=== REUSE DISTANCE ==============================================================\n\n");
+	fprintf(fp, "(LRU miss ratios of committed fetches, loads and stores; ");
+	if (sampling > 1)
+		fprintf(fp, "lines sampled at 1/%u; set-associative ratios are estimates)\n", sampling);
+	else
+		fprintf(fp, "set-associative ratios are estimates)\n");
+
+	for (i = 0; i < profiles.size(); i++) {
+		profile_t* p = profiles[i];
+
+		footprint = (p->stack.Lines() * sampling);
+		fprintf(fp, "\n%s, %u-byte lines: references %lu (sampled %lu), cold %lu, footprint %lu lines%s\n",
+		        rd_stream_names[p->stream], (1U << p->lineShift), p->refs, p->sampled, p->cold, footprint,
+		        ((sampling > 1) ? " (est.)" : ""));
+		p->dist.Print(fp, "stack distance");
+		fprintf(fp, "%7s %8s %8s", "size", "fully", "mpki");
+		for (a = 0; a < RD_ASSOCS; a++)
+			fprintf(fp, "  %2u-way", rd_assoc[a]);
+		fprintf(fp, "\n");
+
+		for (size = RD_MIN_SIZE; size <= RD_MAX_SIZE; size *= 2) {
+			lines = (size >> p->lineShift);
+			if (lines == 0)
+				continue;
+
+			ratio = MissRatio(i, lines, 0);
+			rd_print_size(fp, size);
+			fprintf(fp, " %7.3f%% %8.3f", (100.0 * ratio),
+			        (insns ? (1000.0 * ratio * (double)p->refs / (double)insns) : 0.0));
+			if (csv)
+				fprintf(csv, "%s,%u,%lu,0,%.6f,%.4f\n", rd_stream_names[p->stream], (1U << p->lineShift), size, ratio,
+				        (insns ? (1000.0 * ratio * (double)p->refs / (double)insns) : 0.0));
+
+			for (a = 0; a < RD_ASSOCS; a++) {
+				if (lines < rd_assoc[a]) {
+					fprintf(fp, " %7s", "-");
+					continue;
+				}
+				ratio = MissRatio(i, lines, rd_assoc[a]);
+				fprintf(fp, " %6.2f%%", (100.0 * ratio));
+				if (csv)
+					fprintf(csv, "%s,%u,%lu,%u,%.6f,%.4f\n", rd_stream_names[p->stream], (1U << p->lineShift), size,
+					        rd_assoc[a], ratio, (insns ? (1000.0 * ratio * (double)p->refs / (double)insns) : 0.0));
+			}
+			fprintf(fp, "\n");
+
+			// Larger caches only miss cold.
+			if (lines >= footprint)
+				break;
+		}
+	}
+
+	if (csv)
+		fclose(csv);
+}
@@ -0,0 +1,113 @@
+#ifndef REUSE_DIST_H
+#define REUSE_DIST_H
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#include "histogram.h"
+#include "keyed_table.h"
+
+/*--------------------------------------------------------------------------*\
+ | reuse_dist.h
+ |
+ | Reuse-distance profiler (see --reuse-dist): LRU stack distances of the
+ |  committed instruction fetches (one per retired instruction), loads and
+ |  stores, from which one run yields the miss ratio of every cache size.
+ |
+ | For each line size, three streams are profiled: instruction (the PCs),
+ |  data (the load and store addresses) and unified (both, as seen by a
+ |  unified cache with no L1 in front of it).  A reference's stack distance
+ |  is the number of distinct other lines referenced since the previous
+ |  reference to its line (Mattson et al.); it is found in O(log n) by
+ |  counting, in a Fenwick tree indexed by time, the lines whose latest
+ |  reference is more recent (Olken; Bennett and Kruskal).
+ |
+ | A fully-associative LRU cache of C lines hits exactly the references at
+ |  distances below C.  For a set-associative cache of S sets and A ways,
+ |  the miss ratio is estimated assuming the d intervening lines map to
+ |  sets uniformly at random: a reference hits if fewer than A of them
+ |  map to its set (Smith).
+ |
+ | With a sampling rate of 1/n (n > 1), only the lines whose address hashes
+ |  below 1/n of the hash space are profiled, and their distances are
+ |  scaled by n (SHARDS, fixed-rate; Waldspurger et al.).  Every reference
+ |  to a sampled line is profiled, so the estimate is unbiased.
+\*--------------------------------------------------------------------------*/
+
+#define RD_COLD		(~0ULL)
+
+typedef enum {
+	RD_INST,
+	RD_DATA,
+	RD_UNIFIED,
+	RD_STREAMS
+} rd_stream_t;
+
+class ReuseDistClass
+{
+public:
+	ReuseDistClass(unsigned int sampling, const std::vector<unsigned int>& logLineSizes);
+	~ReuseDistClass();
+
+	void Retire(uint64_t pc, bool mem, uint64_t addr);
+	/*------------------------------------------------------------------------*\
+	 | Records a retired instruction's fetch and, if mem, its load or store.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp, uint64_t insns, const char* mrcFile);
+	/*------------------------------------------------------------------------*\
+	 | Prints each stream's miss-ratio curve, up to the stream's footprint,
+	 |  and writes every curve to mrcFile (if not NULL) as CSV.
+	\*------------------------------------------------------------------------*/
+
+	double MissRatio(unsigned int i, uint64_t lines, unsigned int assoc);
+	/*------------------------------------------------------------------------*\
+	 | Miss ratio of profile i in an LRU cache of the given number of lines:
+	 |  fully-associative if assoc is 0, else set-associative.
+	\*------------------------------------------------------------------------*/
+
+private:
+	// LRU stack of lines, ordered by their latest reference.
+	class Stack
+	{
+	public:
+		Stack();
+		~Stack();
+		uint64_t Reference(uint64_t line);	// Returns the stack distance, or RD_COLD.
+		uint64_t Lines() { return(last.Used()); }
+
+	private:
+		typedef struct {
+			uint64_t line;
+			uint64_t time;		// Of the line's latest reference.
+		} rd_line_t;
+
+		KeyedTable<rd_line_t, &rd_line_t::line> last;
+		int32_t* tree;		// Fenwick tree over times: 1 at each line's latest reference.
+		uint64_t size;
+		uint64_t now;
+
+		void Add(uint64_t t, int32_t n);
+		uint64_t Count(uint64_t t);		// References at times <= t.
+		void Compact();
+	};
+
+	typedef struct {
+		rd_stream_t stream;
+		unsigned int lineShift;
+		Stack stack;
+		LogHistogramClass dist;		// Distances of re-references (scaled).
+		uint64_t refs;			// All references...
+		uint64_t sampled;		// ...and the sampled ones, of which
+		uint64_t cold;			// these were first references.
+	} profile_t;
+
+	unsigned int sampling;
+	uint64_t threshold;		// Lines hashing below it are sampled.
+	std::vector<profile_t*> profiles;
+
+	void Reference(profile_t* p, uint64_t addr);
+};
+
+#endif //REUSE_DIST_H
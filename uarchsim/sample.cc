@@ -0,0 +1,68 @@
+/*--------------------------------------------------------------------------*\
+ | sample.cc
+ |
+ | Accumulates one metric measured over many sampled detailed simulation
+ | windows, and estimates the mean with a confidence interval.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cmath>
+
+#include "sample.h"
+
+SampleClass::SampleClass()
+{
+	Clear();
+}
+
+void SampleClass::Add(double value)
+{
+	n++;
+	sum += value;
+	sumSq += (value * value);
+}
+
+void SampleClass::Clear()
+{
+	n = 0;
+	sum = 0.0;
+	sumSq = 0.0;
+}
+
+unsigned long long SampleClass::Samples()
+{
+	return(n);
+}
+
+double SampleClass::Average()
+{
+	return(n ? (sum / (double)n) : 0.0);
+}
+
+double SampleClass::StdDev()
+{
+	double var;
+
+	if (n < 2)
+		return(0.0);
+
+	var = (sumSq - (sum * sum) / (double)n) / (double)(n - 1);
+	return((var > 0.0) ? sqrt(var) : 0.0);
+}
+
+double SampleClass::Confidence(double z)
+{
+	if (n < 2)
+		return(0.0);
+
+	return(z * StdDev() / sqrt((double)n));
+}
+
+void SampleClass::Print(FILE* fp, const char* name)
+{
+	double mean = Average();
+
+	fprintf(fp, "%-12s mean = %.4f  stddev = %.4f", name, mean, StdDev());
+	fprintf(fp, "  95%% CI = +/-%.4f (%.2f%%)", Confidence(1.96), (mean ? 100.0*Confidence(1.96)/mean : 0.0));
+	fprintf(fp, "  99.7%% CI = +/-%.4f (%.2f%%)\n", Confidence(3.0), (mean ? 100.0*Confidence(3.0)/mean : 0.0));
+}
@@ -0,0 +1,66 @@
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <cstdio>
+
+/*--------------------------------------------------------------------------*\
+ | sample.h
+ |
+ | Accumulates one metric (e.g. CPI) measured over many sampled detailed
+ | simulation windows, and estimates the population mean with a
+ | confidence interval, as in SMARTS periodic sampling.
+\*--------------------------------------------------------------------------*/
+
+class SampleClass
+{
+public:
+	SampleClass();
+	/*------------------------------------------------------------------------*\
+	 | Constructor.  Creates an empty sample.
+	\*------------------------------------------------------------------------*/
+
+	void Add(double value);
+	/*------------------------------------------------------------------------*\
+	 | Adds the value measured in one sampling window.
+	\*------------------------------------------------------------------------*/
+
+	void Clear();
+	/*------------------------------------------------------------------------*\
+	 | Clears out the sample for reuse.
+	\*------------------------------------------------------------------------*/
+
+	unsigned long long Samples();
+	/*------------------------------------------------------------------------*\
+	 | Returns the number of values added.
+	\*------------------------------------------------------------------------*/
+
+	double Average();
+	/*------------------------------------------------------------------------*\
+	 | Returns the sample mean.
+	\*------------------------------------------------------------------------*/
+
+	double StdDev();
+	/*------------------------------------------------------------------------*\
+	 | Returns the (unbiased) sample standard deviation.
+	\*------------------------------------------------------------------------*/
+
+	double Confidence(double z);
+	/*------------------------------------------------------------------------*\
+	 | Returns the half-width of the confidence interval of the mean for
+	 |  the standard normal quantile z (1.96 for 95%, 3.0 for 99.7%).
+	 |  The true mean lies in Average() +/- Confidence(z).
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp, const char* name);
+	/*------------------------------------------------------------------------*\
+	 | Prints the mean, standard deviation and the 95% and 99.7%
+	 |  confidence intervals.
+	\*------------------------------------------------------------------------*/
+
+private:
+	unsigned long long n;  /* Number of values added.                      */
+	double sum;            /* Running sum of the values.                   */
+	double sumSq;          /* Running sum of the squares of the values.    */
+};
+
+#endif //SAMPLE_H
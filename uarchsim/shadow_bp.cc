@@ -0,0 +1,118 @@
+/*--------------------------------------------------------------------------*\
+ | shadow_bp.cc
+ |
+ | Shadow branch predictors.  See shadow_bp.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+#include "shadow_bp.h"
+
+ShadowBpredClass::ShadowBpredClass(unsigned int n, const char* const* specs)
+	: n(n)
+{
+	bpred_config_t config;
+	unsigned int i;
+
+	assert(n <= MAX_SHADOW_BP);
+	for (i = 0; i < n; i++) {
+		if (!bpred_interface::parse_config(specs[i], &config)) {
+			fprintf(stderr, "Invalid shadow branch predictor configuration: %s\n", specs[i]);
+			exit(-1);
+		}
+		spec[i] = specs[i];
+		bp[i] = new bpred_interface(config);
+		misses[i] = 0;
+	}
+	ctis = 0;
+}
+
+ShadowBpredClass::~ShadowBpredClass()
+{
+	for (unsigned int i = 0; i < n; i++)
+		delete bp[i];
+}
+
+void ShadowBpredClass::Train(reg_t pc, insn_t inst, reg_t next_pc, bool count)
+{
+	unsigned int comp_target;
+	pc_stats_t* s;
+	unsigned int i;
+
+	switch (inst.opcode()) {
+		case OP_JAL:
+			comp_target = (pc + inst.uj_imm());
+			break;
+		case OP_BRANCH:
+			comp_target = (pc + inst.sb_imm());
+			break;
+		case OP_JALR:
+			comp_target = 0;
+			break;
+		default:
+			return;
+	}
+
+	if (!count) {
+		for (i = 0; i < n; i++)
+			bp[i]->warm(pc, inst, comp_target, next_pc);
+		return;
+	}
+
+	ctis++;
+	s = &pc_stats[pc];
+	if (s->count == 0)
+		memset(s, 0, sizeof(pc_stats_t));
+	s->count++;
+
+	for (i = 0; i < n; i++) {
+		if (bp[i]->warm(pc, inst, comp_target, next_pc)) {
+			misses[i]++;
+			s->misses[i]++;
+		}
+	}
+}
+
+void ShadowBpredClass::Print(FILE* fp, uint64_t insns)
+{
+	std::vector<std::pair<uint64_t, reg_t> > top;
+	uint64_t total;
+	unsigned int i, j;
+
+	fprintf(fp, "shadow branch predictors (%lu retired CTIs, %lu instructions)\n", ctis, insns);
+	fprintf(fp, "   %-2s %-40s %12s %10s %8s\n", "#", "<bp>,<btb>,<ras>[,<cond>[,<ind>]]", "mispredicts", "ratio", "MPKI");
+	for (i = 0; i < n; i++)
+		fprintf(fp, "   %-2u %-40s %12lu %10f %8.3f\n", i, spec[i], misses[i],
+		        (ctis ? ((double)misses[i] / (double)ctis) : 0.0),
+		        (insns ? (1000.0 * (double)misses[i] / (double)insns) : 0.0));
+
+	// CTIs ranked by mispredictions summed over the shadows.
+	for (auto it = pc_stats.begin(); it != pc_stats.end(); ++it) {
+		total = 0;
+		for (i = 0; i < n; i++)
+			total += it->second.misses[i];
+		if (total)
+			top.push_back(std::make_pair(total, it->first));
+	}
+	std::sort(top.begin(), top.end(), [](const std::pair<uint64_t, reg_t>& a, const std::pair<uint64_t, reg_t>& b) {
+		return ((a.first != b.first) ? (a.first > b.first) : (a.second < b.second));
+	});
+
+	fprintf(fp, "   most mispredicted CTIs (mispredicts per shadow #)\n");
+	fprintf(fp, "   %-18s %12s", "pc", "executions");
+	for (i = 0; i < n; i++)
+		fprintf(fp, " %10u", i);
+	fprintf(fp, "\n");
+	for (j = 0; (j < top.size()) && (j < SHADOW_BP_TOP_PCS); j++) {
+		const pc_stats_t& s = pc_stats[top[j].second];
+		fprintf(fp, "   0x%016lx %12lu", top[j].second, s.count);
+		for (i = 0; i < n; i++)
+			fprintf(fp, " %10lu", s.misses[i]);
+		fprintf(fp, "\n");
+	}
+}
@@ -0,0 +1,64 @@
+#ifndef SHADOW_BP_H
+#define SHADOW_BP_H
+
+#include <cstdio>
+#include <cstdint>
+#include <unordered_map>
+#include "decode.h"
+#include "parameters.h"
+#include "bpred_interface.h"
+
+/*--------------------------------------------------------------------------*\
+ | shadow_bp.h
+ |
+ | Shadow branch predictors: any number of predictor configurations,
+ |  side by side, trained on the retired CTI stream.  The pipeline's own
+ |  predictor (BP) is unaffected: shadows only see committed CTIs, in
+ |  order, so one detailed run evaluates a whole predictor sweep.  Each
+ |  shadow is a bpred_interface trained via warm().
+ |
+ | Reports each configuration's mispredictions and MPKI, and the
+ |  mispredictions of each configuration at the CTIs most mispredicted
+ |  overall.
+\*--------------------------------------------------------------------------*/
+
+#define SHADOW_BP_TOP_PCS	50
+
+class ShadowBpredClass
+{
+public:
+	ShadowBpredClass(unsigned int n, const char* const* specs);
+	/*------------------------------------------------------------------------*\
+	 | Creates n shadow predictors, configured by the specs (see
+	 |  bpred_interface::parse_config()).
+	\*------------------------------------------------------------------------*/
+
+	~ShadowBpredClass();
+
+	void Train(reg_t pc, insn_t inst, reg_t next_pc, bool count);
+	/*------------------------------------------------------------------------*\
+	 | Predicts and trains all shadows with a retired CTI.  Counts the
+	 |  mispredictions unless count is false (functional warming).
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp, uint64_t insns);
+	/*------------------------------------------------------------------------*\
+	 | Prints the statistics; MPKI is per insns retired instructions.
+	\*------------------------------------------------------------------------*/
+
+private:
+	typedef struct {
+		uint64_t count;
+		uint64_t misses[MAX_SHADOW_BP];
+	} pc_stats_t;
+
+	unsigned int n;
+	const char* spec[MAX_SHADOW_BP];
+	bpred_interface* bp[MAX_SHADOW_BP];
+
+	uint64_t ctis;
+	uint64_t misses[MAX_SHADOW_BP];
+	std::unordered_map<reg_t, pc_stats_t> pc_stats;
+};
+
+#endif //SHADOW_BP_H
@@ -8,6 +8,9 @@
 #include <cstdlib>
 #include <cassert>
 #include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 #include <iostream>
 #include <fstream>
 #include <gzstream.h>
@@ -58,33 +61,83 @@ sim_t::sim_t(size_t nprocs, size_t mem_mb, const std::vector<std::string>& args,
 		  procs[i]->set_proc_type("ISA_SIM");
     }
     else{
-		  procs[i] = new pipeline_t(
-		      this,
-          // Set this as MICRO_MMU so that mem operations
-          // do not push to debug buffer. This is necessary
-          // as we use the same class as ISA sim to instantiate
-          // the mmu.
-		      new mmu_t(mem, memsz, MICRO_MMU),  
-		      i,
-		      FETCH_QUEUE_SIZE,
-		      NUM_CHECKPOINTS,
-		      ACTIVE_LIST_SIZE,
-		      ISSUE_QUEUE_SIZE,
-		      ISSUE_QUEUE_NUM_PARTS,
-		      LQ_SIZE,
-		      SQ_SIZE,
-		      FETCH_WIDTH,
-		      DISPATCH_WIDTH,
-		      ISSUE_WIDTH,
-		      RETIRE_WIDTH,
-		      FU_LANE_MATRIX,
-		      FU_LAT);
+      // Set this as MICRO_MMU so that mem operations
+      // do not push to debug buffer. This is necessary
+      // as we use the same class as ISA sim to instantiate
+      // the mmu.
+		  procs[i] = new_pipeline(new mmu_t(mem, memsz, MICRO_MMU), i);
 		  procs[i]->set_proc_type("MICRO_SIM");
     }
 	}
 
 }
 
+// Construct a timing core from the current parameters.h configuration.
+pipeline_t* sim_t::new_pipeline(mmu_t* mmu, size_t i)
+{
+  return new pipeline_t(
+      this,
+      mmu,
+      i,
+      FETCH_QUEUE_SIZE,
+      NUM_CHECKPOINTS,
+      ACTIVE_LIST_SIZE,
+      ISSUE_QUEUE_SIZE,
+      ISSUE_QUEUE_NUM_PARTS,
+      LQ_SIZE,
+      SQ_SIZE,
+      FETCH_WIDTH,
+      DISPATCH_WIDTH,
+      ISSUE_WIDTH,
+      RETIRE_WIDTH,
+      FU_LANE_MATRIX,
+      FU_LAT);
+}
+
+// Rebuild the timing cores from the current parameters.h configuration,
+// keeping memory and the architectural state, e.g. to simulate a restored
+// checkpoint under a different configuration. The old cores' logs are
+// discarded.
+void sim_t::reconfigure()
+{
+  assert(proc_type == MICRO_SIM);
+
+  for (size_t i = 0; i < procs.size(); i++) {
+    pipeline_t* old_proc = (pipeline_t*)procs[i];
+    mmu_t* pmmu = old_proc->get_mmu();
+    state_t old_state = old_proc->state;
+    bool old_run = old_proc->run;
+    debug_buffer_t* old_pipe = old_proc->get_pipe();
+
+    old_proc->redirect_logs("/dev/null");
+    delete old_proc;
+
+    pipeline_t* proc = new_pipeline(pmmu, i);
+    proc->set_proc_type("MICRO_SIM");
+    proc->set_pipe(old_pipe);
+    proc->set_debug(debug);
+    proc->set_histogram(histogram_enabled);
+    proc->state = old_state;
+    proc->run = old_run;
+    proc->copy_state_to_micro();
+    procs[i] = proc;
+  }
+}
+
+// Give the target's open files descriptors of their own, in a forked child,
+// so that it neither moves the parent's file offsets nor writes its files.
+// For the timing simulator, this includes the checker's ISA simulator, which
+// the debug buffer steps during run-ahead.
+void sim_t::detach_target_files()
+{
+  htif->detach_target_files();
+  if (proc_type == MICRO_SIM) {
+    debug_buffer_t* pipe = procs[0]->get_pipe();
+    if (pipe && pipe->get_isa_sim())
+      pipe->get_isa_sim()->get_htif()->detach_target_files();
+  }
+}
+
 sim_t::~sim_t()
 {
 	for (size_t i = 0; i < procs.size(); i++)
@@ -186,7 +239,7 @@ bool sim_t::step(size_t n)
 			}
 
       // If HTIF is done, this will return false
-			htif_return = htif->tick();
+			HOST_PROF_CALL(HP_HTIF, htif_return = htif->tick());
 		}
 	}
 
@@ -201,6 +254,28 @@ bool sim_t::run_fast(size_t n)
   //set_procs_debug(true);
   set_procs_checker(false);
 
+  bool htif_return = skip(n, false);
+
+  // Copy registers from fast skip state to pipeline register file.
+  // Also reset the AMT.
+  if(proc_type == MICRO_SIM){
+    ifprintf(logging_on,stderr,"Copying state after skipping %lu instructions\n",n);
+    ((pipeline_t*)procs[current_proc])->copy_state_to_micro();
+  }
+
+  //fprintf(stderr,"State for %s:\n",proc_type == MICRO_SIM ? "micro_sim" : "isa_sim");
+  //procs[current_proc]->get_state()->dump(stderr);
+
+  set_procs_debug(old_debug);
+  set_procs_checker(old_checker);
+  return htif_return;
+}
+
+// Functionally simulate n instructions. With lockstep set, the MICRO_SIM
+// stays in step with the ISA_SIM through the debug buffer, so that detailed
+// simulation can resume afterwards with the checker enabled.
+bool sim_t::skip(size_t n, bool lockstep)
+{
   bool htif_return = true;
   size_t total_retired = 0;
   size_t steps = 0;
@@ -211,7 +286,10 @@ bool sim_t::run_fast(size_t n)
 
     // This function continues until it has retired "steps" instructions
     // or it encounters a cycle with 0 retired instructions.
-  	procs[current_proc]->step(steps,instret);
+    if((proc_type == MICRO_SIM) && (functional_warming || lockstep))
+      ((pipeline_t*)procs[current_proc])->step_warm(steps,instret,lockstep);
+    else
+  	  procs[current_proc]->step(steps,instret);
 
     if(instret){
       idle_cycles = 0;
@@ -229,31 +307,150 @@ bool sim_t::run_fast(size_t n)
 		{
 			current_step = 0;//current_step % INTERLEAVE;
       idle_cycles  = 0;
-			procs[current_proc]->yield_load_reservation();
+      // The ISA_SIM does not yield in step(), so neither may a lockstep MICRO_SIM.
+      if(!lockstep)
+			  procs[current_proc]->yield_load_reservation();
 			if (++current_proc == procs.size()) {
 				current_proc = 0;
 			}
 
       // If HTIF is done, this will return false
-			htif_return = htif->tick();
+			HOST_PROF_CALL(HP_HTIF, htif_return = htif->tick());
 		}
 	}
 
-  // Copy registers from fast skip state to pipeline register file.
-  // Also reset the AMT.
-  if(proc_type == MICRO_SIM){
-    ifprintf(logging_on,stderr,"Copying state after skipping %lu instructions\n",total_retired);
-    ((pipeline_t*)procs[current_proc])->copy_state_to_micro();
+  return htif_return;
+}
+
+// SMARTS-style periodic sampling. Each period of sample_period instructions
+// is functionally warmed up to the last sample_warmup + sample_window
+// instructions, which are simulated in detail; only the last sample_window
+// instructions are measured. The pipeline is drained after each window.
+//
+// With fork_jobs set, each detailed window instead runs in a forked
+// child, which inherits memory copy-on-write along with the warmed caches
+// and predictor, while the parent functionally simulates through the
+// window and on to the next sample point. Children report through
+// per-sample files that the parent merges.
+int sim_t::run_sampled()
+{
+  pipeline_t* proc = (pipeline_t*)procs[current_proc];
+  bool htif_return = true;
+  uint64_t num_samples = 0;
+  std::map<pid_t, uint64_t> children;
+
+  assert(proc_type == MICRO_SIM);
+
+  while (htif_return)
+  {
+    // Honor -e as a budget of detailed instructions.
+    if (use_stop_amt && (num_samples * (sample_warmup + sample_window) >= stop_amt))
+      break;
+
+    // Functional warming.
+    htif_return = skip(sample_period - sample_warmup - sample_window, true);
+    if (!htif_return)
+      break;
+
+    if (fork_jobs) {
+      // Throttle to fork_jobs outstanding children.
+      if (children.size() == fork_jobs)
+        reap_sample(children, true);
+
+      fflush(0);
+      pid_t pid = fork();
+      if (pid == 0) {
+        // Child: detailed window only. Silence the simulator's output and the
+        // parent's logs, and detach the target's files (the parent replays
+        // the same writes functionally), then report and exit without running
+        // destructors (which would dump the parent's stats).
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        detach_target_files();
+        proc->redirect_logs("/dev/null");
+        if (sample_detailed(proc))
+          proc->sample_write(sample_file(getppid(), num_samples).c_str());
+        _exit(0);
+      }
+      else if (pid < 0) {
+        perror("fork");
+        exit(-1);
+      }
+      children[pid] = num_samples++;
+
+      // Parent: functionally simulate through the window.
+      htif_return = skip(sample_warmup + sample_window, true);
+      reap_sample(children, false);
+    }
+    else {
+      htif_return = sample_detailed(proc);
+      num_samples++;
+
+      // Back to functional simulation.
+      proc->drain();
+    }
   }
 
-  //fprintf(stderr,"State for %s:\n",proc_type == MICRO_SIM ? "micro_sim" : "isa_sim");
-  //procs[current_proc]->get_state()->dump(stderr);
+  while (!children.empty())
+    reap_sample(children, true);
+
+  return htif->exit_code();
+}
+
+// Detailed warm-up, then the measured window of one sample.
+// Returns false if the simulation ended before the window completed.
+bool sim_t::sample_detailed(pipeline_t* proc)
+{
+  bool htif_return = true;
+
+  proc->copy_state_to_micro();
+
+  uint64_t target = proc->num_insn + sample_warmup;
+  while (htif_return && (proc->num_insn < target))
+    htif_return = step(1);
+  if (!htif_return)
+    return false;
+
+  proc->sample_begin();
+  target = proc->num_insn + sample_window;
+  while (htif_return && (proc->num_insn < target))
+    htif_return = step(1);
+  if (proc->num_insn < target)
+    return false;
+  proc->sample_end();
 
-  set_procs_debug(old_debug);
-  set_procs_checker(old_checker);
   return htif_return;
 }
 
+std::string sim_t::sample_file(pid_t parent, uint64_t sample)
+{
+  char name[64];
+  sprintf(name, "sample.%d.%lu.log", (int)parent, sample);
+  return std::string(name);
+}
+
+// Collect finished sample children and merge their results. If block is
+// set, wait for at least one.
+void sim_t::reap_sample(std::map<pid_t, uint64_t>& children, bool block)
+{
+  pipeline_t* proc = (pipeline_t*)procs[current_proc];
+  int status;
+  pid_t pid;
+
+  while ((pid = waitpid(-1, &status, (block ? 0 : WNOHANG))) > 0) {
+    auto child = children.find(pid);
+    if (child == children.end())
+      continue;
+
+    std::string name = sample_file(getpid(), child->second);
+    if (!proc->sample_read(name.c_str()))
+      fprintf(stderr, "warning: sample %lu produced no results\n", child->second);
+    unlink(name.c_str());
+    children.erase(child);
+    block = false;
+  }
+}
+
 void sim_t::step_till_pc(reg_t break_pc,unsigned int proc_n)
 {
   procs[proc_n]->set_debug(true);
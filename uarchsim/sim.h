@@ -5,6 +5,8 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <sys/types.h>
 #include <memory>
 #include <fstream>
 #include <gzstream.h>
@@ -18,6 +20,7 @@ enum proc_type_t {ISA_SIM,MICRO_SIM};
 
 class htif_isasim_t;
 class debug_buffer_t;
+class pipeline_t;
 
 // this class encapsulates the processors and memory in a RISC-V machine.
 class sim_t
@@ -29,6 +32,7 @@ public:
 	// run the simulation to completion
 	void boot();
 	int run();
+	int run_sampled(); // periodic sampling, see sample_period
 	bool running();
 	void stop();
 	void set_debug(bool value);
@@ -70,6 +74,9 @@ public:
 
   bool run_fast(size_t n);
 
+  void reconfigure();
+  void detach_target_files();
+
   proc_type_t get_proc_type(){return proc_type;}
 
 private:
@@ -80,7 +87,14 @@ private:
 	mmu_t* debug_mmu;  // debug port into main memory
 	std::vector<processor_t*> procs;
 
+	pipeline_t* new_pipeline(mmu_t* mmu, size_t i);
 	bool step(size_t n); // step through simulation
+	bool skip(size_t n, bool lockstep); // functionally simulate n instructions
+
+	// periodic sampling helpers
+	bool sample_detailed(pipeline_t* proc);
+	std::string sample_file(pid_t parent, uint64_t sample);
+	void reap_sample(std::map<pid_t, uint64_t>& children, bool block);
 	static const size_t INTERLEAVE = 64;
 	size_t current_step;
 	size_t idle_cycles;
@@ -11,11 +11,14 @@ void pipeline_t::squash_complete(reg_t jump_PC) {
 	//pc = offending_PC + SS_INST_SIZE;
 	//pc = INCREMENT_PC(offending_PC);
 	pc = jump_PC;  //Jump to the exception vector or next instruction
+	recovering = true;
   LOG(fetch_log,cycle,PAY.buf[PAY.head].sequence,PAY.buf[PAY.head].pc,"Exception, Redirect to 0x%016" PRIx64 "",pc);
 
 
 	next_fetch_cycle = (cycle_t)0;
 	BP.flush();
+	if (ftq_size)
+		ftq_flush();
 
   // Clear the fetch_exception flag so that instructions
   // can be fetched again. FETCH might have been stalled if 
@@ -81,6 +84,19 @@ void pipeline_t::squash_complete(reg_t jump_PC) {
 	}
 
 	LSU.flush();
+
+	// Value predictor: everything in PAY is being squashed (a committed head already trained it).
+	if (VP) {
+		vp_squash(PAY.head);
+		VP->Flush();
+	}
+}
+
+// Tell the value predictor that the instructions in PAY from 'index' to the tail are squashed.
+void pipeline_t::vp_squash(unsigned int index) {
+	for (unsigned int i = index; i != PAY.tail; i = MOD((i + 2), PAYLOAD_BUFFER_SIZE))
+		if (PAY.buf[i].vp.lookup)
+			VP->Squash(PAY.buf[i].pc, &PAY.buf[i].vp);
 }
 
 
@@ -115,8 +131,15 @@ void pipeline_t::resolve(unsigned int branch_ID, bool correct) {
 		}
 	}
 	else {
+		recovering = true;
+
 		// Squash all instructions in the Decode through Dispatch Stages.
 
+		// Branch Prediction Stage: discard the predicted fetch blocks.
+		// The caller already redirected the PC and rolled back the branch predictor.
+		if (ftq_size)
+			ftq_flush();
+
 		// Decode Stage:
 		for (i = 0; i < fetch_width; i++) {
 			DECODE[i].valid = false;
@@ -1,10 +1,14 @@
 #include "stats.h"
 #include "pipeline.h"
 #include "parameters.h"
+#include "json_writer.h"
+#include <vector>
+#include <algorithm>
 
-stats_t::stats_t(pipeline_t* _proc){
+stats_t::stats_t(pipeline_t* _proc) : pc_profile(4096) {
 
   this->proc = _proc;
+  this->pc_profile_file = NULL;
 
   DECLARE_COUNTER(this, cycle_count               ,proc);
   DECLARE_COUNTER(this, commit_count              ,proc);
@@ -69,6 +73,14 @@ stats_t::stats_t(pipeline_t* _proc){
   DECLARE_COUNTER(this, freelist_write_count      ,proc);
 #endif
 
+  // Decoupled front-end.
+  if (FTQ_SIZE && !PERFECT_BRANCH_PRED) {
+    DECLARE_COUNTER(this, ftq_block_count           ,proc);
+    DECLARE_COUNTER(this, ftq_full_count            ,proc);
+    DECLARE_COUNTER(this, ftq_empty_count           ,proc);
+    DECLARE_COUNTER(this, ftq_flush_count           ,proc);
+  }
+
   DECLARE_RATE(this, ipc_rate, proc, commit_count, cycle_count, 1.0);
 #if 0
   DECLARE_RATE(this, mispredict_rate, proc, mispredict_count, cond_branch_count, 100);
@@ -141,11 +153,13 @@ stats_t::stats_t(pipeline_t* _proc){
   DECLARE_PHASE_RATE(this, mpki_rate, proc, mispredict_count, commit_count, 1000.0);
 #endif
 
+  topdown_width = 1;
+  phase_series = NULL;
+
   reset_counters();
   reset_phase_counters();
   set_phase_interval("commit_count",10000);
   phase_id = 0;
-
 }
 
 void stats_t::set_log_files(FILE* _stats_log,FILE* _phase_log){
@@ -165,6 +179,8 @@ void stats_t::reset_counters(){
   for(ctr_iter = counter_map.begin();ctr_iter != counter_map.end(); ctr_iter++){
     ctr_iter->second->count = 0;
   }
+  for (unsigned int i = 0; i < TD_CATEGORIES; i++)
+    topdown[i] = 0;
 }
 
 void stats_t::reset_phase_counters(){
@@ -172,6 +188,8 @@ void stats_t::reset_phase_counters(){
   for(ctr_iter = counter_map.begin();ctr_iter != counter_map.end(); ctr_iter++){
     ctr_iter->second->phase_count = 0;
   }
+  for (unsigned int i = 0; i < TD_CATEGORIES; i++)
+    phase_topdown[i] = 0;
 }
 
 void stats_t::register_counter(const char* name, const char* hierarchy){
@@ -280,8 +298,15 @@ void stats_t::phase_tick(){
   if(counter_map[phase_counter_name]->phase_count >= phase_interval){
     phase_id++;
     update_rates();
-    dump_phase_counters();
-    dump_phase_rates();
+    if (phase_series) {
+      write_phase_row();
+    }
+    else {
+      dump_phase_counters();
+      dump_phase_rates();
+      fprintf(phase_log,"-------- Phase Top-down Phase ID %" PRIu64 "--------\n",phase_id);
+      print_topdown(phase_log, phase_topdown);
+    }
     //dump_counters();
     //dump_rates();
     reset_phase_counters();
@@ -310,22 +335,33 @@ void stats_t::update_rates(){
   }
 }
 
-void stats_t::dump_counters(){
-  fprintf(stats_log,"[stats]\n");
+// The dump_*() functions print to stats_log unless given another file.
+void stats_t::dump_counters(FILE* fp){
+  if (!fp) fp = stats_log;
+  fprintf(fp,"[stats]\n");
   std::map<std::string, counter_t*, ltstr>::iterator ctr_iter;
   for(ctr_iter = counter_map.begin();ctr_iter != counter_map.end(); ctr_iter++){
-    fprintf(stats_log,"%s : %" PRIu64 "\n",ctr_iter->second->name, ctr_iter->second->count);
+    fprintf(fp,"%s : %" PRIu64 "\n",ctr_iter->second->name, ctr_iter->second->count);
   }
 }
 
-void stats_t::dump_rates(){
-  fprintf(stats_log,"[rates]\n");
+void stats_t::dump_rates(FILE* fp){
+  if (!fp) fp = stats_log;
+  fprintf(fp,"[rates]\n");
   std::map<std::string, rate_t*, ltstr>::iterator rate_iter;
   for(rate_iter = rate_map.begin();rate_iter != rate_map.end(); rate_iter++){
-    fprintf(stats_log,"%s : %2.2f\n",rate_iter->second->name, rate_iter->second->rate);
+    fprintf(fp,"%s : %2.2f\n",rate_iter->second->name, rate_iter->second->rate);
   }
 }
 
+// Counters, up-to-date rates and the CPI stack, for a snapshot of a run in progress.
+void stats_t::dump_snapshot(FILE* fp){
+  update_rates();
+  dump_counters(fp);
+  dump_rates(fp);
+  dump_topdown(fp);
+}
+
 void stats_t::dump_phase_counters(){
   fprintf(phase_log,"-------- Phase Counters Phase ID %" PRIu64 "--------\n",phase_id);
   std::map<std::string, counter_t*, ltstr>::iterator ctr_iter;
@@ -344,6 +380,139 @@ void stats_t::dump_phase_rates(){
   }
 }
 
+void stats_t::dump_topdown(FILE* fp){
+  if (!fp) fp = stats_log;
+  fprintf(fp,"[topdown]\n");
+  print_topdown(fp, topdown);
+}
+
+// Prints the CPI stack: each category's share of the dispatch slots, and
+// its share of the CPI.
+void stats_t::print_topdown(FILE* fp, const uint64_t* slots){
+  static const struct {
+    const char* name;
+    int category;       // -1: sum of the following indented categories.
+    bool sub;
+  } rows[] = {
+    {"retiring",        TD_RETIRING,    false},
+    {"bad speculation", -1,             false},
+    {"wrong path",      -2,             true},
+    {"recovery",        TD_RECOVERY,    true},
+    {"frontend bound",  -1,             false},
+    {"I$ miss",         TD_FE_ICACHE,   true},
+    {"FQ empty",        TD_FE_FQ_EMPTY, true},
+    {"backend bound",   -1,             false},
+    {"D$ miss",         TD_BE_DCACHE,   true},
+    {"L2 miss",         TD_BE_L2,       true},
+    {"LSQ full",        TD_BE_LSQ,      true},
+    {"IQ full",         TD_BE_IQ,       true},
+    {"ROB full",        TD_BE_ROB,      true},
+    {"FU contention",   TD_BE_FU,       true},
+  };
+  const unsigned int n_rows = sizeof(rows) / sizeof(rows[0]);
+  uint64_t total = 0;
+  uint64_t retiring = std::min(slots[TD_RETIRING], slots[TD_DISPATCHED]);
+  uint64_t wrong_path = slots[TD_DISPATCHED] - retiring;
+  uint64_t value[n_rows];
+  double cpi;
+
+  for (unsigned int i = 0; i < TD_CATEGORIES; i++)
+    if (i != TD_RETIRING)
+      total += slots[i];
+  cpi = (slots[TD_RETIRING] ? ((double)total / (double)topdown_width / (double)slots[TD_RETIRING]) : 0.0);
+
+  for (unsigned int i = n_rows; i-- > 0;) {
+    if (rows[i].category == TD_RETIRING)
+      value[i] = retiring;
+    else if (rows[i].category == -2)
+      value[i] = wrong_path;
+    else if (rows[i].category >= 0)
+      value[i] = slots[rows[i].category];
+    else {
+      value[i] = 0;
+      for (unsigned int j = i + 1; (j < n_rows) && rows[j].sub; j++)
+        value[i] += value[j];
+    }
+  }
+
+  fprintf(fp,"slots : %" PRIu64 " (width %u)\n",total,topdown_width);
+  fprintf(fp,"CPI : %2.4f\n",cpi);
+  for (unsigned int i = 0; i < n_rows; i++)
+    fprintf(fp,"%s%-*s : %12" PRIu64 " %6.2f%% CPI %2.4f\n",(rows[i].sub ? "  " : ""),(rows[i].sub ? 16 : 18),rows[i].name,value[i],
+            (total ? (100.0 * value[i] / total) : 0.0),
+            (total ? (cpi * value[i] / total) : 0.0));
+}
+
+static const char* const topdown_names[TD_CATEGORIES] = {
+  "dispatched", "retiring", "recovery", "icache_miss", "fq_empty",
+  "dcache_miss", "l2_miss", "lsq_full", "iq_full", "rob_full", "fu_contention"
+};
+
+// Starts the binary phase time series in fp (see stats.h), replacing the
+// text phases in phase_log.  NULL switches back to text.
+void stats_t::set_phase_series(FILE* fp){
+  phase_series = fp;
+  if (!fp)
+    return;
+
+  std::vector<const char*> columns(1, "phase_id");
+  std::map<std::string, counter_t*, ltstr>::iterator ctr_iter;
+  for(ctr_iter = counter_map.begin();ctr_iter != counter_map.end(); ctr_iter++){
+    if(ctr_iter->second->valid_phase_counter)
+      columns.push_back(ctr_iter->second->name);
+  }
+  uint32_t n = (uint32_t)(columns.size() + TD_CATEGORIES);
+  fwrite(PHASE_SERIES_MAGIC, 1, 8, fp);
+  fwrite(&n, sizeof(n), 1, fp);
+  for (size_t i = 0; i < columns.size(); i++)
+    fwrite(columns[i], 1, strlen(columns[i]) + 1, fp);
+  for (unsigned int i = 0; i < TD_CATEGORIES; i++)
+    fprintf(fp, "topdown.%s%c", topdown_names[i], '\0');
+}
+
+void stats_t::write_phase_row(){
+  std::vector<uint64_t> row(1, phase_id);
+  std::map<std::string, counter_t*, ltstr>::iterator ctr_iter;
+  for(ctr_iter = counter_map.begin();ctr_iter != counter_map.end(); ctr_iter++){
+    if(ctr_iter->second->valid_phase_counter)
+      row.push_back(ctr_iter->second->phase_count);
+  }
+  row.insert(row.end(), phase_topdown, phase_topdown + TD_CATEGORIES);
+  fwrite(&row[0], sizeof(uint64_t), row.size(), phase_series);
+}
+
+// The counters, rates and CPI stack, as members of the current JSON object.
+void stats_t::dump_json(JsonWriter& json){
+  update_rates();
+
+  json.BeginObject("counters");
+  std::map<std::string, counter_t*, ltstr>::iterator ctr_iter;
+  for(ctr_iter = counter_map.begin();ctr_iter != counter_map.end(); ctr_iter++){
+    json.Uint(ctr_iter->second->name, ctr_iter->second->count);
+  }
+  json.EndObject();
+
+  json.BeginObject("rates");
+  std::map<std::string, rate_t*, ltstr>::iterator rate_iter;
+  for(rate_iter = rate_map.begin();rate_iter != rate_map.end(); rate_iter++){
+    json.Double(rate_iter->second->name, rate_iter->second->rate);
+  }
+  json.EndObject();
+
+  json.BeginObject("knobs");
+  std::map<std::string, knob_t*, ltstr>::iterator knb_iter;
+  for(knb_iter = knob_map.begin();knb_iter != knob_map.end(); knb_iter++){
+    json.Uint(knb_iter->second->name, knb_iter->second->value);
+  }
+  json.EndObject();
+
+  json.BeginObject("topdown");
+  json.Uint("width", topdown_width);
+  for (unsigned int i = 0; i < TD_CATEGORIES; i++)
+    json.Uint(topdown_names[i], topdown[i]);
+  json.EndObject();
+}
+
 void stats_t::dump_knobs(){
   fprintf(stats_log,"[knobs]\n");
   std::map<std::string, knob_t*, ltstr>::iterator knb_iter;
@@ -353,25 +522,56 @@ void stats_t::dump_knobs(){
 }
 
 
+pc_profile_t* stats_t::get_pc_profile(size_t pc){
+  return pc_profile.Get(pc);
+}
+
 void stats_t::update_pc_histogram(size_t pc){
-  // If the counter has been declared and initialized
-  pc_histogram[pc >> 2]++;
+  get_pc_profile(pc)->commits++;
 }
 
 void stats_t::update_br_histogram(size_t pc,bool misp){
-  // If the counter has been declared and initialized
-  br_histogram[pc >> 2].executed++;
   if(misp)
-    br_histogram[pc >> 2].mispredicted ++;
+    get_pc_profile(pc)->mispredicted++;
+}
+
+// Sorts the profiled PCs by the given field, largest first.
+static std::vector<pc_profile_t*> pc_profile_sort(KeyedTable<pc_profile_t, &pc_profile_t::pc>& table, uint64_t pc_profile_t::*field){
+  return table.Select([field](const pc_profile_t* p) { return (p->*field != 0); },
+                      [field](const pc_profile_t* a, const pc_profile_t* b) {
+    return (a->*field != b->*field) ? (a->*field > b->*field) : (a->pc < b->pc);
+  });
 }
 
 void stats_t::dump_pc_histogram(){
   if (proc->get_histogram())
   {
-    fprintf(stderr, "PC Histogram size:%lu\n", pc_histogram.size());
-    fprintf(stats_log, "-------PC Histogram-------\n");
-    for(auto iterator = pc_histogram.begin(); iterator != pc_histogram.end(); ++iterator) {
-      fprintf(stats_log, "%0lx %lu\n", (iterator->first << 2), iterator->second);
+    std::vector<pc_profile_t*> v = pc_profile_sort(pc_profile, &pc_profile_t::commits);
+
+    fprintf(stderr, "PC Histogram size:%lu\n", pc_profile.Used());
+    fprintf(stats_log, "-------PC Histogram (top %u of %lu by commits)-------\n", PC_PROFILE_TOP, pc_profile.Used());
+    fprintf(stats_log, "%-18s %12s %10s %10s %10s %10s %10s %12s\n",
+            "pc", "commits", "br_misp", "l1d_miss", "l2_miss", "forward", "disambig", "head_stall");
+    for (size_t i = 0; (i < v.size()) && (i < PC_PROFILE_TOP); i++) {
+      fprintf(stats_log, "%-18lx %12lu %10lu %10lu %10lu %10lu %10lu %12lu\n",
+              v[i]->pc, v[i]->commits, v[i]->mispredicted, v[i]->l1d_misses, v[i]->l2_misses,
+              v[i]->forwards, v[i]->disambig_stalls, v[i]->head_stall_cycles);
+    }
+
+    if (pc_profile_file) {
+      FILE* fp = fopen(pc_profile_file, "wb");
+      if (fp) {
+        uint64_t n = pc_profile.Used();
+        fwrite("PCPROF01", 1, 8, fp);
+        fwrite(&n, sizeof(n), 1, fp);
+        for (size_t i = 0; i < pc_profile.Size(); i++)
+          if (pc_profile.Slot(i))
+            fwrite(pc_profile.Slot(i), sizeof(pc_profile_t), 1, fp);
+        fclose(fp);
+      }
+      else {
+        fprintf(stderr, "Unable to write the PC profile to %s\n", pc_profile_file);
+      }
     }
   }
 }
@@ -379,10 +579,12 @@ void stats_t::dump_pc_histogram(){
 void stats_t::dump_br_histogram(){
   if (proc->get_histogram())
   {
-    fprintf(stderr, "BR Histogram size:%lu\n", br_histogram.size());
-    fprintf(stats_log, "-------BR Histogram-------\n");
-    for(auto iterator = br_histogram.begin(); iterator != br_histogram.end(); ++iterator) {
-      fprintf(stats_log, "%0lx %lu %lu\n", (iterator->first << 2), iterator->second.executed, iterator->second.mispredicted);
+    std::vector<pc_profile_t*> v = pc_profile_sort(pc_profile, &pc_profile_t::mispredicted);
+
+    fprintf(stderr, "BR Histogram size:%lu\n", v.size());
+    fprintf(stats_log, "-------BR Histogram (top %u of %lu by mispredictions)-------\n", PC_PROFILE_TOP, v.size());
+    for (size_t i = 0; (i < v.size()) && (i < PC_PROFILE_TOP); i++) {
+      fprintf(stats_log, "%0lx %lu %lu\n", v[i]->pc, v[i]->commits, v[i]->mispredicted);
     }
   }
 }
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <map>
 #include <cstdio>
+#include "keyed_table.h"
 
 
 // Statistics related variables and funcions
@@ -86,18 +87,58 @@ typedef struct branch {
   size_t mispredicted;
 } branch_t;
 
+// Per-PC profile of one static instruction (-g, --profile), collected at retire.
+// The binary dump (--profile=<n>,<file>) is the 8-byte magic "PCPROF01", a uint64_t
+// record count, then the records, each a pc_profile_t (eight uint64_t's).
+typedef struct pc_profile {
+  uint64_t pc;
+  uint64_t commits;             // Retired instances.
+  uint64_t mispredicted;        // Retired mispredicted branches.
+  uint64_t l1d_misses;          // Retired loads/stores that missed in the L1 D$...
+  uint64_t l2_misses;           // ...and in the L2$.
+  uint64_t forwards;            // Retired loads that received their value from the SQ.
+  uint64_t disambig_stalls;     // Retired loads that stalled for disambiguation.
+  uint64_t head_stall_cycles;   // Cycles spent at the AL head, not completed.
+} pc_profile_t;
+
+// Top-down CPI stack.  Every cycle, each of the dispatch_width dispatch slots
+// is either filled (TD_DISPATCHED) or left empty for one reason (TD_RECOVERY ...
+// TD_BE_FU); TD_RETIRING counts retired instructions.  Dispatched slots that
+// did not retire were wrong-path, and are bad speculation with TD_RECOVERY.
+typedef enum {
+  TD_DISPATCHED,        // Slot dispatched an instruction.
+  TD_RETIRING,          // Instructions retired.
+  TD_RECOVERY,          // Bad speculation: front-end refilling after a squash.
+  TD_FE_ICACHE,         // Frontend-bound: fetch is waiting for an I$ miss.
+  TD_FE_FQ_EMPTY,       // Frontend-bound: no dispatch bundle otherwise.
+  TD_BE_DCACHE,         // Backend-bound, the oldest load is waiting for a D$ miss...
+  TD_BE_L2,             // ...that also missed in the L2$.
+  TD_BE_LSQ,            // Backend-bound: LQ/SQ full...
+  TD_BE_IQ,             // ...IQ full...
+  TD_BE_ROB,            // ...Active List full...
+  TD_BE_FU,             // ...with ready instructions waiting for an Execution Lane.
+  TD_CATEGORIES
+} topdown_t;
+
+// Binary phase time series (--stats=json): the 8-byte magic "721PHS01", a
+// uint32_t column count, the NUL-terminated column names, then one row of
+// uint64_t's per phase.  Columns are phase_id, the phase counters, and the
+// phase's top-down slot counts (topdown.<category>).  See phases.py.
+#define PHASE_SERIES_MAGIC	"721PHS01"
+
 //Forward declaring classes
 class pipeline_t;
+class JsonWriter;
 
 class stats_t {
 public:
 
   stats_t(pipeline_t* _proc);
-  ~stats_t(){}
   void set_phase_interval(const char* name,uint64_t interval);
   void update_counter(const char* name,unsigned int inc=1);
   void update_pc_histogram(size_t pc);
   void update_br_histogram(size_t pc,bool misp);
+  pc_profile_t* get_pc_profile(size_t pc);
   uint64_t get_counter(const char* name);
   unsigned int get_knob(const char* name);
   void register_counter(const char* name, const char* hierarchy);
@@ -110,13 +151,23 @@ public:
   void reset_counters();
   void reset_phase_counters();
   void update_rates();
-  void dump_counters();  
+  void dump_counters(FILE* fp = NULL);
   void dump_phase_counters();  
-  void dump_rates();  
+  void dump_rates(FILE* fp = NULL);
   void dump_phase_rates();  
   void dump_knobs();  
   void dump_pc_histogram();  
   void dump_br_histogram();  
+  void set_topdown_width(unsigned int width){topdown_width = width;}
+  void set_pc_profile_file(const char* file){pc_profile_file = file;}
+  inline void update_topdown(topdown_t category, uint64_t slots){
+    topdown[category] += slots;
+    phase_topdown[category] += slots;
+  }
+  void dump_topdown(FILE* fp = NULL);
+  void dump_snapshot(FILE* fp);
+  void dump_json(JsonWriter& json);
+  void set_phase_series(FILE* fp);
 
   //inline void set_histogram(bool val){histogram_enabled = val;}
 
@@ -126,14 +177,23 @@ private:
   std::map<std::string, rate_t*, ltstr> rate_map;
   //map<const char*, counter_t*, ltstr> phase_counter_map;
   std::map<std::string, knob_t*, ltstr> knob_map;
-  std::map<size_t,size_t> pc_histogram;
-  std::map<size_t,branch_t> br_histogram;
+  // Per-PC profile.
+  KeyedTable<pc_profile_t, &pc_profile_t::pc> pc_profile;
+  const char* pc_profile_file;	// Binary profile of all PCs (--profile), or NULL.
+
+  // Top-down CPI stack: total and current phase.
+  unsigned int topdown_width;
+  uint64_t topdown[TD_CATEGORIES];
+  uint64_t phase_topdown[TD_CATEGORIES];
+  void print_topdown(FILE* fp, const uint64_t* slots);
 
   uint64_t phase_id;
   uint64_t phase_interval;
   char phase_counter_name[16];
   FILE* stats_log;
   FILE* phase_log;
+  FILE* phase_series;		// Binary phase time series, or NULL for text phases in phase_log.
+  void write_phase_row();
 
   pipeline_t* proc;
   //bool histogram_enabled;
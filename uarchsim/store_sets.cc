@@ -0,0 +1,129 @@
+/*--------------------------------------------------------------------------*\
+ | store_sets.cc
+ |
+ | Store Sets memory dependence predictor.  See store_sets.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
+#include "store_sets.h"
+
+StoreSetsClass::StoreSetsClass(unsigned int ssitSize, unsigned int lfstSize, uint64_t clearInterval)
+	: lfstSize(lfstSize), clearInterval(clearInterval)
+{
+	assert((ssitSize > 0) && !(ssitSize & (ssitSize - 1)));
+	assert((lfstSize > 0) && (lfstSize <= 65536));
+
+	ssit = new ssit_entry[ssitSize];
+	lfst = new lfst_entry[lfstSize];
+	memset(ssit, 0, ssitSize * sizeof(ssit_entry));
+	memset(lfst, 0, lfstSize * sizeof(lfst_entry));
+	ssitMask = (ssitSize - 1);
+	nextClear = clearInterval;
+	nextSsid = 0;
+
+	loads = 0;
+	loads_in_set = 0;
+	loads_waiting = 0;
+	violations = 0;
+	sets_allocated = 0;
+	sets_merged = 0;
+	clears = 0;
+}
+
+StoreSetsClass::~StoreSetsClass()
+{
+	delete [] ssit;
+	delete [] lfst;
+}
+
+bool StoreSetsClass::Load(reg_t pc, unsigned int* sq_index)
+{
+	ssit_entry* s = lookup(pc);
+
+	loads++;
+	if (!s->valid)
+		return(false);
+	loads_in_set++;
+	if (!lfst[s->ssid].valid)
+		return(false);
+	loads_waiting++;
+	*sq_index = lfst[s->ssid].sq_index;
+	return(true);
+}
+
+void StoreSetsClass::Store(reg_t pc, unsigned int sq_index)
+{
+	ssit_entry* s = lookup(pc);
+
+	if (s->valid) {
+		lfst[s->ssid].valid = true;
+		lfst[s->ssid].sq_index = sq_index;
+	}
+}
+
+void StoreSetsClass::StoreIssued(reg_t pc, unsigned int sq_index)
+{
+	ssit_entry* s = lookup(pc);
+
+	if (s->valid && lfst[s->ssid].valid && (lfst[s->ssid].sq_index == sq_index))
+		lfst[s->ssid].valid = false;
+}
+
+void StoreSetsClass::Violation(reg_t load_pc, reg_t store_pc)
+{
+	ssit_entry* l = lookup(load_pc);
+	ssit_entry* s = lookup(store_pc);
+
+	violations++;
+	if (!l->valid && !s->valid) {
+		l->ssid = s->ssid = nextSsid;
+		l->valid = s->valid = true;
+		lfst[nextSsid].valid = false;
+		nextSsid = ((nextSsid + 1) % lfstSize);
+		sets_allocated++;
+	}
+	else if (!l->valid) {
+		l->ssid = s->ssid;
+		l->valid = true;
+	}
+	else if (!s->valid) {
+		s->ssid = l->ssid;
+		s->valid = true;
+	}
+	else if (l->ssid != s->ssid) {
+		l->ssid = s->ssid = ((l->ssid < s->ssid) ? l->ssid : s->ssid);
+		sets_merged++;
+	}
+}
+
+void StoreSetsClass::Flush()
+{
+	for (unsigned int i = 0; i < lfstSize; i++)
+		lfst[i].valid = false;
+}
+
+void StoreSetsClass::Tick(uint64_t cycle)
+{
+	if (clearInterval && (cycle >= nextClear)) {
+		for (unsigned int i = 0; i <= ssitMask; i++)
+			ssit[i].valid = false;
+		nextClear = (cycle + clearInterval);
+		clears++;
+	}
+}
+
+void StoreSetsClass::Print(FILE* fp)
+{
+	fprintf(fp, "store sets (%u SSIT entries, %u LFST entries, cleared every %lu cycles)\n",
+	        (ssitMask + 1), lfstSize, clearInterval);
+	fprintf(fp, "   loads dispatched:       %lu\n", loads);
+	fprintf(fp, "   loads in a store set:   %lu\n", loads_in_set);
+	fprintf(fp, "   loads waiting on store: %lu\n", loads_waiting);
+	fprintf(fp, "   load violations:        %lu\n", violations);
+	fprintf(fp, "   sets allocated:         %lu\n", sets_allocated);
+	fprintf(fp, "   sets merged:            %lu\n", sets_merged);
+	fprintf(fp, "   SSIT clears:            %lu\n", clears);
+}
@@ -0,0 +1,103 @@
+#ifndef STORE_SETS_H
+#define STORE_SETS_H
+
+#include <cstdio>
+#include <cstdint>
+#include "decode.h"
+
+/*--------------------------------------------------------------------------*\
+ | store_sets.h
+ |
+ | Store Sets memory dependence predictor (Chrysos and Emer), used with
+ |  speculative memory disambiguation (see --disambig and --mdp).
+ |
+ | SSIT (store set identifier table): PC-indexed, holds the store set of
+ |  each load and store that has taken part in a load violation.  A
+ |  violation puts the load and the store in one set: a new set if neither
+ |  has one, the other's set if one has, and the smaller of the two sets if
+ |  both have.
+ |
+ | LFST (last fetched store table): indexed by store set, holds the SQ
+ |  index of the set's most recently dispatched store until that store
+ |  computes its address.  A load in a set waits only for that store's
+ |  address, and speculates past all other stores.
+ |
+ | The SSIT is invalidated every clearInterval cycles, so that stale
+ |  dependences (and sets merged by aliasing) do not serialize loads
+ |  forever.
+\*--------------------------------------------------------------------------*/
+
+class StoreSetsClass
+{
+public:
+	StoreSetsClass(unsigned int ssitSize, unsigned int lfstSize, uint64_t clearInterval);
+	~StoreSetsClass();
+
+	bool Load(reg_t pc, unsigned int* sq_index);
+	/*------------------------------------------------------------------------*\
+	 | Predicts the dependence of a load being dispatched.  Returns whether
+	 |  the load should wait for a store; if so, sq_index is set to the SQ
+	 |  index of that store.
+	\*------------------------------------------------------------------------*/
+
+	void Store(reg_t pc, unsigned int sq_index);
+	/*------------------------------------------------------------------------*\
+	 | Records a store being dispatched into the SQ at sq_index as its
+	 |  set's last store.
+	\*------------------------------------------------------------------------*/
+
+	void StoreIssued(reg_t pc, unsigned int sq_index);
+	/*------------------------------------------------------------------------*\
+	 | A store computed its address: loads need no longer wait for it.
+	\*------------------------------------------------------------------------*/
+
+	void Violation(reg_t load_pc, reg_t store_pc);
+	/*------------------------------------------------------------------------*\
+	 | Trains the predictor with a load that retired after a store it
+	 |  depended on executed too late.
+	\*------------------------------------------------------------------------*/
+
+	void Flush();
+	/*------------------------------------------------------------------------*\
+	 | The SQ was flushed: invalidates the LFST.
+	\*------------------------------------------------------------------------*/
+
+	void Tick(uint64_t cycle);
+	/*------------------------------------------------------------------------*\
+	 | Invalidates the SSIT every clearInterval cycles.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp);
+
+private:
+	typedef struct {
+		bool valid;
+		uint16_t ssid;
+	} ssit_entry;
+
+	typedef struct {
+		bool valid;
+		unsigned int sq_index;
+	} lfst_entry;
+
+	ssit_entry* ssit;
+	lfst_entry* lfst;
+	unsigned int ssitMask;
+	unsigned int lfstSize;
+	uint64_t clearInterval;
+	uint64_t nextClear;
+	unsigned int nextSsid;		// Allocated round-robin.
+
+	ssit_entry* lookup(reg_t pc) { return(&ssit[(pc >> 2) & ssitMask]); }
+
+	// Statistics.
+	uint64_t loads;
+	uint64_t loads_in_set;
+	uint64_t loads_waiting;		// Loads that waited for a store.
+	uint64_t violations;
+	uint64_t sets_allocated;
+	uint64_t sets_merged;
+	uint64_t clears;
+};
+
+#endif //STORE_SETS_H
@@ -0,0 +1,653 @@
+/*--------------------------------------------------------------------------*\
+ | tage.cc
+ |
+ | TAGE-SC-L conditional branch predictor and ITTAGE indirect target
+ |  predictor.  See tage.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+
+#include "common.h"
+#include "tage.h"
+
+#define GHIST_MASK		(GHIST_BUFFER_SIZE - 1)
+#define PATH_BITS		16
+
+#define TAGE_ENTRIES		(1 << TAGE_LOG_ENTRIES)
+#define BIMODAL_ENTRIES		(1 << TAGE_LOG_BIMODAL)
+#define TAGE_U_RESET_PERIOD	(1 << 18)	// Useful counters decay every 256K updates.
+
+#define SC_LOG_ENTRIES		10
+#define SC_ENTRIES		(1 << SC_LOG_ENTRIES)
+#define SC_TABLES		4
+#define SC_CTR_MAX		31
+#define SC_CTR_MIN		-32
+#define SC_THRESHOLD_INIT	12
+#define SC_THRESHOLD_MIN	4
+#define SC_THRESHOLD_MAX	64
+#define SC_TC_MAX		32
+
+#define LOOP_LOG_ENTRIES	8
+#define LOOP_ENTRIES		(1 << LOOP_LOG_ENTRIES)
+#define LOOP_TAG_MASK		0x3fff
+#define LOOP_CONF_MAX		7
+#define LOOP_AGE		64
+#define LOOP_ITER_MAX		0xffff
+
+#define ITTAGE_ENTRIES		(1 << ITTAGE_LOG_ENTRIES)
+#define ITTAGE_U_RESET_PERIOD	(1 << 18)
+
+// Global history lengths of the SC's GEHL tables.
+static const unsigned int sc_len[SC_TABLES] = { 6, 12, 24, 48 };
+
+static inline void ctr_update(int8_t* ctr, bool up, int min, int max)
+{
+	if (up) {
+		if (*ctr < max)
+			(*ctr)++;
+	}
+	else if (*ctr > min) {
+		(*ctr)--;
+	}
+}
+
+static inline int sat(int x, int min, int max)
+{
+	return((x < min) ? min : ((x > max) ? max : x));
+}
+
+// Shifts newbit into a history of length len folded into width bits;
+//  oldbit is the bit leaving the history.
+static inline uint16_t fold(uint16_t comp, unsigned int len, unsigned int width,
+                            unsigned int newbit, unsigned int oldbit)
+{
+	uint32_t c = (((uint32_t)comp << 1) | newbit);
+	c ^= (oldbit << (len % width));
+	c ^= (c >> width);
+	return(c & ((1u << width) - 1));
+}
+
+/*--------------------------------------------------------------------------*\
+ | Global and path history.
+\*--------------------------------------------------------------------------*/
+
+BranchHistoryClass::BranchHistoryClass()
+{
+	unsigned int i;
+
+	// Geometric series of history lengths.
+	for (i = 0; i < TAGE_TABLES; i++) {
+		tage_len[i] = (unsigned int)(TAGE_MIN_HIST *
+		              pow((double)TAGE_MAX_HIST / TAGE_MIN_HIST, (double)i / (TAGE_TABLES - 1)) + 0.5);
+		tage_tag_bits[i] = (7 + (i / 2));
+	}
+	for (i = 0; i < ITTAGE_TABLES; i++) {
+		it_len[i] = (unsigned int)(ITTAGE_MIN_HIST *
+		            pow((double)ITTAGE_MAX_HIST / ITTAGE_MIN_HIST, (double)i / (ITTAGE_TABLES - 1)) + 0.5);
+		it_tag_bits[i] = (9 + (i / 2));
+	}
+	assert((tage_len[TAGE_TABLES - 1] < GHIST_BUFFER_SIZE) && (it_len[ITTAGE_TABLES - 1] < GHIST_BUFFER_SIZE));
+
+	memset(ghist, 0, sizeof(ghist));
+}
+
+void BranchHistoryClass::Init(bp_history_t* h)
+{
+	memset(h, 0, sizeof(bp_history_t));
+}
+
+void BranchHistoryClass::Push(const bp_history_t* cur, bp_history_t* next, bool bit, unsigned int pc)
+{
+	unsigned int i;
+	unsigned int old;
+
+	*next = *cur;
+	next->ptr = ((cur->ptr - 1) & GHIST_MASK);
+	ghist[next->ptr] = bit;
+	next->ghr = ((cur->ghr << 1) | bit);
+	next->path = (((cur->path << 1) | ((pc >> 2) & 1)) & ((1u << PATH_BITS) - 1));
+
+	for (i = 0; i < TAGE_TABLES; i++) {
+		old = ghist[(next->ptr + tage_len[i]) & GHIST_MASK];
+		next->idx[i] = fold(cur->idx[i], tage_len[i], TAGE_LOG_ENTRIES, bit, old);
+		next->tag0[i] = fold(cur->tag0[i], tage_len[i], tage_tag_bits[i], bit, old);
+		next->tag1[i] = fold(cur->tag1[i], tage_len[i], (tage_tag_bits[i] - 1), bit, old);
+	}
+	for (i = 0; i < ITTAGE_TABLES; i++) {
+		old = ghist[(next->ptr + it_len[i]) & GHIST_MASK];
+		next->it_idx[i] = fold(cur->it_idx[i], it_len[i], ITTAGE_LOG_ENTRIES, bit, old);
+		next->it_tag0[i] = fold(cur->it_tag0[i], it_len[i], it_tag_bits[i], bit, old);
+		next->it_tag1[i] = fold(cur->it_tag1[i], it_len[i], (it_tag_bits[i] - 1), bit, old);
+	}
+}
+
+/*--------------------------------------------------------------------------*\
+ | TAGE-SC-L.
+\*--------------------------------------------------------------------------*/
+
+TageClass::TageClass(BranchHistoryClass* hist)
+	: hist(hist)
+{
+	unsigned int i;
+
+	bimodal = new int8_t[BIMODAL_ENTRIES];
+	memset(bimodal, 0, BIMODAL_ENTRIES);
+	for (i = 0; i < TAGE_TABLES; i++) {
+		table[i] = new tage_entry[TAGE_ENTRIES];
+		memset(table[i], 0, (TAGE_ENTRIES * sizeof(tage_entry)));
+	}
+	use_alt_on_na = 0;
+	tick = 0;
+	lfsr = 0xace1;
+
+	sc_bias = new int8_t[SC_ENTRIES];
+	memset(sc_bias, 0, SC_ENTRIES);
+	for (i = 0; i < SC_TABLES; i++) {
+		sc_gehl[i] = new int8_t[SC_ENTRIES];
+		memset(sc_gehl[i], 0, SC_ENTRIES);
+	}
+	sc_threshold = SC_THRESHOLD_INIT;
+	sc_tc = 0;
+
+	loop = new loop_entry[LOOP_ENTRIES];
+	memset(loop, 0, (LOOP_ENTRIES * sizeof(loop_entry)));
+	with_loop = -1;
+
+	memset(stat_provider, 0, sizeof(stat_provider));
+	stat_tage_miss = 0;
+	stat_sc_used = 0;
+	stat_sc_correct = 0;
+	stat_loop_used = 0;
+	stat_loop_correct = 0;
+}
+
+TageClass::~TageClass()
+{
+	unsigned int i;
+
+	delete [] bimodal;
+	for (i = 0; i < TAGE_TABLES; i++)
+		delete [] table[i];
+	delete [] sc_bias;
+	for (i = 0; i < SC_TABLES; i++)
+		delete [] sc_gehl[i];
+	delete [] loop;
+}
+
+unsigned int TageClass::index(unsigned int i, unsigned int pc, const bp_history_t* h)
+{
+	unsigned int pcw = (pc >> 2);
+	unsigned int path = (h->path & ((1u << MIN(hist->tage_len[i], PATH_BITS)) - 1));
+
+	return((pcw ^ (pcw >> (TAGE_LOG_ENTRIES - (i % 4))) ^ h->idx[i] ^ path ^ (path >> TAGE_LOG_ENTRIES)) &
+	       (TAGE_ENTRIES - 1));
+}
+
+uint16_t TageClass::tag(unsigned int i, unsigned int pc, const bp_history_t* h)
+{
+	return(((pc >> 2) ^ h->tag0[i] ^ (h->tag1[i] << 1)) & ((1u << hist->tage_tag_bits[i]) - 1));
+}
+
+unsigned int TageClass::sc_index(int j, unsigned int pc, const bp_history_t* h, bool tage_pred)
+{
+	unsigned int pcw = (pc >> 2);
+	uint64_t g;
+
+	// Bias table: indexed by the PC and TAGE's prediction.
+	if (j < 0)
+		return(((pcw << 1) | tage_pred) & (SC_ENTRIES - 1));
+
+	g = (h->ghr & ((1ull << sc_len[j]) - 1));
+	g ^= ((g >> SC_LOG_ENTRIES) ^ (g >> (2 * SC_LOG_ENTRIES)) ^ (g >> (3 * SC_LOG_ENTRIES)) ^ (g >> (4 * SC_LOG_ENTRIES)));
+	return((pcw ^ (pcw >> (j + 2)) ^ (unsigned int)g ^ ((unsigned int)tage_pred << (SC_LOG_ENTRIES - 1))) &
+	       (SC_ENTRIES - 1));
+}
+
+TageClass::loop_entry* TageClass::loop_lookup(unsigned int pc, bool* hit)
+{
+	unsigned int pcw = (pc >> 2);
+	loop_entry* e = &loop[pcw & (LOOP_ENTRIES - 1)];
+
+	*hit = ((e->age > 0) && (e->tag == ((pcw >> LOOP_LOG_ENTRIES) & LOOP_TAG_MASK)));
+	return(e);
+}
+
+bool TageClass::Predict(unsigned int pc, const bp_history_t* h, tage_pred_t* p)
+{
+	tage_entry* pe = NULL;
+	tage_entry* ae = NULL;
+	tage_entry* e;
+	loop_entry* le;
+	int8_t b;
+	int i;
+	int sum;
+	bool pred;
+
+	//
+	// TAGE
+	//
+	p->provider = -1;
+	p->alt = -1;
+	for (i = (TAGE_TABLES - 1); i >= 0; i--) {
+		e = &table[i][index(i, pc, h)];
+		if (e->tag == tag(i, pc, h)) {
+			if (!pe) {
+				p->provider = i;
+				pe = e;
+			}
+			else {
+				p->alt = i;
+				ae = e;
+				break;
+			}
+		}
+	}
+
+	b = bimodal[(pc >> 2) & (BIMODAL_ENTRIES - 1)];
+	p->alt_pred = (ae ? (ae->ctr >= 0) : (b >= 0));
+	if (pe) {
+		p->provider_pred = (pe->ctr >= 0);
+		// Newly allocated (weak, not yet useful) entries defer to the alternate prediction, if that has been better.
+		if ((pe->ctr == 0 || pe->ctr == -1) && (pe->u == 0) && (use_alt_on_na >= 0))
+			p->tage_pred = p->alt_pred;
+		else
+			p->tage_pred = p->provider_pred;
+		p->tage_high_conf = ((pe->ctr == 3) || (pe->ctr == -4));
+	}
+	else {
+		p->provider_pred = (b >= 0);
+		p->tage_pred = p->provider_pred;
+		p->tage_high_conf = ((b == 1) || (b == -2));
+	}
+
+	//
+	// SC
+	//
+	sum = (p->tage_pred ? 4 : -4);
+	sum += ((2 * sc_bias[sc_index(-1, pc, h, p->tage_pred)]) + 1);
+	for (i = 0; i < SC_TABLES; i++)
+		sum += ((2 * sc_gehl[i][sc_index(i, pc, h, p->tage_pred)]) + 1);
+	p->sc_sum = sum;
+	p->sc_pred = (sum >= 0);
+	p->sc_used = (!p->tage_high_conf && (p->sc_pred != p->tage_pred) && (abs(sum) >= sc_threshold));
+	pred = (p->sc_used ? p->sc_pred : p->tage_pred);
+
+	//
+	// L
+	//
+	le = loop_lookup(pc, &p->loop_hit);
+	p->loop_valid = (p->loop_hit && (le->conf >= LOOP_CONF_MAX));
+	p->loop_pred = ((le->cur == le->past) ? !le->dir : le->dir);
+	p->loop_used = (p->loop_valid && (with_loop >= 0));
+	if (p->loop_used)
+		pred = p->loop_pred;
+
+	p->pred = pred;
+	p->loop_spec = false;
+	return(pred);
+}
+
+void TageClass::SpecUpdate(unsigned int pc, bool taken, tage_pred_t* p)
+{
+	bool hit;
+	loop_entry* e = loop_lookup(pc, &hit);
+
+	p->loop_spec = hit;
+	if (hit) {
+		p->loop_index = (e - loop);
+		p->loop_prev_iter = e->cur;
+		if (taken == e->dir) {
+			if (e->cur < LOOP_ITER_MAX)
+				e->cur++;
+		}
+		else {
+			e->cur = 0;
+		}
+	}
+}
+
+void TageClass::SpecUndo(const tage_pred_t* p)
+{
+	if (p->loop_spec)
+		loop[p->loop_index].cur = p->loop_prev_iter;
+}
+
+void TageClass::Update(unsigned int pc, const bp_history_t* h, const tage_pred_t* p, bool taken)
+{
+	tage_entry* pe = NULL;
+	tage_entry* ae = NULL;
+	tage_entry* e;
+	int8_t* be;
+	loop_entry* le;
+	bool hit;
+	bool allocated;
+	unsigned int i;
+	unsigned int start;
+	unsigned int idx;
+
+	tick++;
+
+	//
+	// Statistics.
+	//
+	stat_provider[p->provider + 1]++;
+	if (p->tage_pred != taken)
+		stat_tage_miss++;
+	if (p->sc_used) {
+		stat_sc_used++;
+		if (p->sc_pred == taken)
+			stat_sc_correct++;
+	}
+	if (p->loop_used) {
+		stat_loop_used++;
+		if (p->loop_pred == taken)
+			stat_loop_correct++;
+	}
+
+	//
+	// L
+	//
+	if (p->loop_valid && (p->loop_pred != (p->sc_used ? p->sc_pred : p->tage_pred)))
+		with_loop = sat((with_loop + ((p->loop_pred == taken) ? 1 : -1)), -8, 7);
+
+	le = loop_lookup(pc, &hit);
+	if (hit) {
+		if (taken == le->dir) {
+			le->ret++;
+			if (le->past && (le->ret > le->past)) {
+				// The trip is longer than the learned trip count: relearn it.
+				le->past = 0;
+				le->conf = 0;
+			}
+			if (le->ret == LOOP_ITER_MAX)
+				le->age = 0;		// Not a loop: free the entry.
+		}
+		else {
+			if (le->ret == 0) {
+				le->age = 0;		// Exits without iterating: not a loop.
+			}
+			else if (le->ret == le->past) {
+				if (le->conf < LOOP_CONF_MAX)
+					le->conf++;
+				if (le->age < 255)
+					le->age++;
+			}
+			else {
+				le->past = le->ret;
+				le->conf = 0;
+			}
+			le->ret = 0;
+		}
+	}
+	else if (p->pred != taken) {
+		// Allocate on a misprediction, taking this outcome as the loop exit.
+		if (le->age > 0) {
+			le->age--;
+		}
+		else {
+			le->tag = (((pc >> 2) >> LOOP_LOG_ENTRIES) & LOOP_TAG_MASK);
+			le->dir = !taken;
+			le->past = 0;
+			le->cur = 0;
+			le->ret = 0;
+			le->conf = 0;
+			le->age = LOOP_AGE;
+		}
+	}
+
+	//
+	// SC
+	//
+	if (p->sc_pred != p->tage_pred) {
+		// Raise the threshold when the SC is wrong to disagree with TAGE; lower it when right.
+		sc_tc += ((p->sc_pred == taken) ? -1 : 1);
+		if (sc_tc >= SC_TC_MAX) {
+			sc_threshold = MIN((sc_threshold + 1), SC_THRESHOLD_MAX);
+			sc_tc = 0;
+		}
+		else if (sc_tc <= -SC_TC_MAX) {
+			sc_threshold = MAX((sc_threshold - 1), SC_THRESHOLD_MIN);
+			sc_tc = 0;
+		}
+	}
+	if ((p->sc_pred != taken) || (abs(p->sc_sum) < (2 * sc_threshold))) {
+		ctr_update(&sc_bias[sc_index(-1, pc, h, p->tage_pred)], taken, SC_CTR_MIN, SC_CTR_MAX);
+		for (i = 0; i < SC_TABLES; i++)
+			ctr_update(&sc_gehl[i][sc_index(i, pc, h, p->tage_pred)], taken, SC_CTR_MIN, SC_CTR_MAX);
+	}
+
+	//
+	// TAGE
+	//
+	// The provider and alternate entries may have been replaced since the prediction.
+	if (p->provider >= 0) {
+		pe = &table[p->provider][index(p->provider, pc, h)];
+		if (pe->tag != tag(p->provider, pc, h))
+			pe = NULL;
+	}
+	if (p->alt >= 0) {
+		ae = &table[p->alt][index(p->alt, pc, h)];
+		if (ae->tag != tag(p->alt, pc, h))
+			ae = NULL;
+	}
+	be = &bimodal[(pc >> 2) & (BIMODAL_ENTRIES - 1)];
+
+	if (pe && (pe->ctr == 0 || pe->ctr == -1) && (pe->u == 0) && (p->provider_pred != p->alt_pred))
+		use_alt_on_na = sat((use_alt_on_na + ((p->alt_pred == taken) ? 1 : -1)), -8, 7);
+
+	// Allocate an entry in a longer-history table on a misprediction.
+	if ((p->tage_pred != taken) && (p->provider < (TAGE_TABLES - 1))) {
+		lfsr = ((lfsr >> 1) ^ (-(lfsr & 1u) & 0xb400u));
+		start = (p->provider + 1);
+		if ((lfsr & 1) && (start < (TAGE_TABLES - 1)))
+			start++;		// Randomly skip a table, to spread allocations.
+
+		allocated = false;
+		for (i = start; (i < TAGE_TABLES) && !allocated; i++) {
+			e = &table[i][index(i, pc, h)];
+			if (e->u == 0) {
+				e->tag = tag(i, pc, h);
+				e->ctr = (taken ? 0 : -1);
+				allocated = true;
+			}
+		}
+		if (!allocated) {
+			for (i = start; i < TAGE_TABLES; i++) {
+				e = &table[i][index(i, pc, h)];
+				if (e->u > 0)
+					e->u--;
+			}
+		}
+	}
+
+	if (pe) {
+		ctr_update(&pe->ctr, taken, -4, 3);
+		if (pe->u == 0) {
+			if (ae)
+				ctr_update(&ae->ctr, taken, -4, 3);
+			else
+				ctr_update(be, taken, -2, 1);
+		}
+		if (p->provider_pred != p->alt_pred) {
+			if (p->provider_pred == taken) {
+				if (pe->u < 3)
+					pe->u++;
+			}
+			else if (pe->u > 0) {
+				pe->u--;
+			}
+		}
+	}
+	else {
+		ctr_update(be, taken, -2, 1);
+	}
+
+	// Periodically decay the useful counters, so stale entries can be replaced.
+	if ((tick % TAGE_U_RESET_PERIOD) == 0) {
+		for (i = 0; i < TAGE_TABLES; i++)
+			for (idx = 0; idx < TAGE_ENTRIES; idx++)
+				table[i][idx].u >>= 1;
+	}
+}
+
+void TageClass::Print(FILE* fp)
+{
+	unsigned int i;
+
+	fprintf(fp, "TAGE-SC-L\n");
+	fprintf(fp, "   provider bimodal:             %lu\n", stat_provider[0]);
+	for (i = 0; i < TAGE_TABLES; i++)
+		fprintf(fp, "   provider T%-2u (history %4u):  %lu\n", (i + 1), hist->tage_len[i], stat_provider[i + 1]);
+	fprintf(fp, "   TAGE mispredictions:          %lu\n", stat_tage_miss);
+	fprintf(fp, "   SC overrides:                 %lu (%lu correct)\n", stat_sc_used, stat_sc_correct);
+	fprintf(fp, "   SC threshold:                 %d\n", sc_threshold);
+	fprintf(fp, "   loop overrides:               %lu (%lu correct)\n", stat_loop_used, stat_loop_correct);
+}
+
+/*--------------------------------------------------------------------------*\
+ | ITTAGE.
+\*--------------------------------------------------------------------------*/
+
+ITTageClass::ITTageClass(BranchHistoryClass* hist)
+	: hist(hist)
+{
+	unsigned int i;
+
+	for (i = 0; i < ITTAGE_TABLES; i++) {
+		table[i] = new ittage_entry[ITTAGE_ENTRIES];
+		memset(table[i], 0, (ITTAGE_ENTRIES * sizeof(ittage_entry)));
+	}
+	tick = 0;
+
+	memset(stat_provider, 0, sizeof(stat_provider));
+	stat_miss = 0;
+}
+
+ITTageClass::~ITTageClass()
+{
+	for (unsigned int i = 0; i < ITTAGE_TABLES; i++)
+		delete [] table[i];
+}
+
+unsigned int ITTageClass::index(unsigned int i, unsigned int pc, const bp_history_t* h)
+{
+	unsigned int pcw = (pc >> 2);
+	unsigned int path = (h->path & ((1u << MIN(hist->it_len[i], PATH_BITS)) - 1));
+
+	return((pcw ^ (pcw >> (ITTAGE_LOG_ENTRIES - (i % 4))) ^ h->it_idx[i] ^ path ^ (path >> ITTAGE_LOG_ENTRIES)) &
+	       (ITTAGE_ENTRIES - 1));
+}
+
+uint16_t ITTageClass::tag(unsigned int i, unsigned int pc, const bp_history_t* h)
+{
+	return(((pc >> 2) ^ h->it_tag0[i] ^ (h->it_tag1[i] << 1)) & ((1u << hist->it_tag_bits[i]) - 1));
+}
+
+unsigned int ITTageClass::Predict(unsigned int pc, const bp_history_t* h, unsigned int btb_target, ittage_pred_t* p)
+{
+	ittage_entry* pe = NULL;
+	ittage_entry* ae = NULL;
+	ittage_entry* e;
+	int i;
+
+	p->provider = -1;
+	p->alt = -1;
+	for (i = (ITTAGE_TABLES - 1); i >= 0; i--) {
+		e = &table[i][index(i, pc, h)];
+		if (e->tag == tag(i, pc, h)) {
+			if (!pe) {
+				p->provider = i;
+				pe = e;
+			}
+			else {
+				p->alt = i;
+				ae = e;
+				break;
+			}
+		}
+	}
+
+	p->alt_target = (ae ? ae->target : btb_target);
+	if (!pe)
+		return(btb_target);
+	// A newly allocated (zero-confidence) entry defers to the alternate prediction.
+	return((pe->conf == 0) ? p->alt_target : pe->target);
+}
+
+void ITTageClass::Update(unsigned int pc, const bp_history_t* h, const ittage_pred_t* p,
+                         unsigned int predicted, unsigned int target)
+{
+	ittage_entry* pe = NULL;
+	ittage_entry* e;
+	bool allocated;
+	unsigned int i;
+	unsigned int idx;
+
+	tick++;
+
+	stat_provider[p->provider + 1]++;
+	if (predicted != target)
+		stat_miss++;
+
+	if (p->provider >= 0) {
+		pe = &table[p->provider][index(p->provider, pc, h)];
+		if (pe->tag != tag(p->provider, pc, h))
+			pe = NULL;
+	}
+
+	if (pe) {
+		if (pe->target == target) {
+			if (pe->conf < 3)
+				pe->conf++;
+			if (p->alt_target != target)
+				pe->u = 1;
+		}
+		else {
+			if (pe->conf > 0)
+				pe->conf--;
+			else
+				pe->target = target;
+			if (p->alt_target == target)
+				pe->u = 0;
+		}
+	}
+
+	// Allocate an entry in a longer-history table on a misprediction.
+	if ((predicted != target) && (p->provider < (ITTAGE_TABLES - 1))) {
+		allocated = false;
+		for (i = (p->provider + 1); (i < ITTAGE_TABLES) && !allocated; i++) {
+			e = &table[i][index(i, pc, h)];
+			if (e->u == 0) {
+				e->tag = tag(i, pc, h);
+				e->target = target;
+				e->conf = 0;
+				allocated = true;
+			}
+		}
+		if (!allocated) {
+			for (i = (p->provider + 1); i < ITTAGE_TABLES; i++)
+				table[i][index(i, pc, h)].u = 0;
+		}
+	}
+
+	if ((tick % ITTAGE_U_RESET_PERIOD) == 0) {
+		for (i = 0; i < ITTAGE_TABLES; i++)
+			for (idx = 0; idx < ITTAGE_ENTRIES; idx++)
+				table[i][idx].u = 0;
+	}
+}
+
+void ITTageClass::Print(FILE* fp)
+{
+	unsigned int i;
+
+	fprintf(fp, "ITTAGE\n");
+	fprintf(fp, "   provider BTB:                 %lu\n", stat_provider[0]);
+	for (i = 0; i < ITTAGE_TABLES; i++)
+		fprintf(fp, "   provider T%-2u (history %4u):  %lu\n", (i + 1), hist->it_len[i], stat_provider[i + 1]);
+	fprintf(fp, "   mispredictions:               %lu\n", stat_miss);
+}
@@ -0,0 +1,234 @@
+#ifndef TAGE_H
+#define TAGE_H
+
+#include <cstdio>
+#include <cstdint>
+
+/*--------------------------------------------------------------------------*\
+ | tage.h
+ |
+ | TAGE-SC-L conditional branch predictor and ITTAGE indirect target
+ |  predictor, used by bpred_interface (see --bpred).
+ |
+ | BranchHistoryClass: the long global (outcome) history and path history
+ |  shared by both predictors.  Outcome bits are kept in a circular
+ |  buffer; a history state (bp_history_t) is a pointer into the buffer
+ |  plus the folded (compressed) histories that index and tag the
+ |  predictors' tables.  bpred_interface keeps the state before each
+ |  in-flight CTI in its CTI queue, so a misprediction is repaired by
+ |  restoring the state of the mispredicted CTI and pushing its correct
+ |  outcome.  The buffer is large enough that the bits of in-flight CTIs
+ |  are never overwritten before they are read.
+ |
+ | TageClass: TAGE (a bimodal base table and TAGE_TABLES partially tagged
+ |  tables indexed with geometrically increasing history lengths), a
+ |  statistical corrector (SC) that reverts low-confidence TAGE
+ |  predictions that its bias and short-history tables disagree with,
+ |  and a loop predictor (L) for loops with a constant trip count.  The
+ |  loop predictor's iteration counts are updated speculatively, and
+ |  restored via SpecUndo() for squashed predictions.
+ |
+ | ITTageClass: ITTAGE.  Tagged tables of targets indexed like TAGE's;
+ |  the BTB target is the base prediction.
+ |
+ | All tables are packed arrays of small entries, allocated once.
+ |  Tables are trained when the CTI retires.
+\*--------------------------------------------------------------------------*/
+
+#define TAGE_TABLES		12
+#define TAGE_LOG_ENTRIES	10	// 1K entries per tagged table
+#define TAGE_LOG_BIMODAL	13
+#define TAGE_MIN_HIST		4
+#define TAGE_MAX_HIST		640
+
+#define ITTAGE_TABLES		8
+#define ITTAGE_LOG_ENTRIES	9
+#define ITTAGE_MIN_HIST		4
+#define ITTAGE_MAX_HIST		256
+
+#define GHIST_BUFFER_SIZE	4096	// Must exceed TAGE_MAX_HIST + CTIQ_SIZE.
+
+// History state before a CTI.
+typedef struct {
+	uint32_t ptr;				// Newest bit in the history buffer.
+	uint64_t ghr;				// Newest 64 outcome bits (for the SC).
+	uint32_t path;				// Path history: one PC bit per CTI.
+	uint16_t idx[TAGE_TABLES];		// Folded histories: TAGE index,
+	uint16_t tag0[TAGE_TABLES];		// ...tag,
+	uint16_t tag1[TAGE_TABLES];		// ...and tag (one bit shorter).
+	uint16_t it_idx[ITTAGE_TABLES];		// Likewise for ITTAGE.
+	uint16_t it_tag0[ITTAGE_TABLES];
+	uint16_t it_tag1[ITTAGE_TABLES];
+} bp_history_t;
+
+class BranchHistoryClass
+{
+public:
+	BranchHistoryClass();
+
+	void Init(bp_history_t* h);
+	/*------------------------------------------------------------------------*\
+	 | Sets h to the empty history.
+	\*------------------------------------------------------------------------*/
+
+	void Push(const bp_history_t* cur, bp_history_t* next, bool bit, unsigned int pc);
+	/*------------------------------------------------------------------------*\
+	 | Computes next: the history after a CTI at pc, whose history was cur,
+	 |  shifting in one outcome bit.
+	\*------------------------------------------------------------------------*/
+
+	// Geometry: history lengths and tag widths of the tagged tables.
+	unsigned int tage_len[TAGE_TABLES];
+	unsigned int tage_tag_bits[TAGE_TABLES];
+	unsigned int it_len[ITTAGE_TABLES];
+	unsigned int it_tag_bits[ITTAGE_TABLES];
+
+private:
+	uint8_t ghist[GHIST_BUFFER_SIZE];
+};
+
+// Prediction of one conditional branch, kept in its CTI queue entry.
+typedef struct {
+	int8_t provider;		// Longest matching tagged table, -1 if none.
+	int8_t alt;			// Next longest, -1 for the bimodal table.
+	bool provider_pred;
+	bool alt_pred;
+	bool tage_pred;			// TAGE's prediction.
+	bool tage_high_conf;		// TAGE's provider counter is saturated.
+	bool sc_pred;
+	int16_t sc_sum;
+	bool sc_used;			// SC reverted TAGE's prediction.
+	bool loop_hit;
+	bool loop_valid;		// Loop predictor is confident.
+	bool loop_pred;
+	bool loop_used;			// Loop predictor overrode TAGE-SC.
+	bool pred;			// Final prediction.
+	uint16_t loop_index;		// Loop entry updated speculatively,
+	uint16_t loop_prev_iter;	// ...and its previous iteration count.
+	bool loop_spec;
+} tage_pred_t;
+
+class TageClass
+{
+public:
+	TageClass(BranchHistoryClass* hist);
+	~TageClass();
+
+	bool Predict(unsigned int pc, const bp_history_t* h, tage_pred_t* p);
+	/*------------------------------------------------------------------------*\
+	 | Predicts the branch at pc, given the history before it.  Returns the
+	 |  final prediction; p keeps what Update() needs.
+	\*------------------------------------------------------------------------*/
+
+	void SpecUpdate(unsigned int pc, bool taken, tage_pred_t* p);
+	void SpecUndo(const tage_pred_t* p);
+	/*------------------------------------------------------------------------*\
+	 | Speculatively advances the loop predictor's iteration count for a
+	 |  branch predicted (or corrected to) taken, and restores it if the
+	 |  prediction is squashed.  Squashed predictions are undone youngest
+	 |  first.
+	\*------------------------------------------------------------------------*/
+
+	void Update(unsigned int pc, const bp_history_t* h, const tage_pred_t* p, bool taken);
+	/*------------------------------------------------------------------------*\
+	 | Trains the predictor with a retired branch's outcome.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp);
+
+private:
+	typedef struct {
+		uint16_t tag;
+		int8_t ctr;			// 3-bit signed: taken if >= 0.
+		uint8_t u;			// 2-bit useful counter.
+	} tage_entry;
+
+	typedef struct {
+		uint16_t tag;
+		uint16_t past;			// Trip count: iterations in dir.
+		uint16_t cur;			// Speculative iterations of this trip.
+		uint16_t ret;			// Retired iterations of this trip.
+		uint8_t conf;
+		uint8_t age;
+		bool dir;
+	} loop_entry;
+
+	BranchHistoryClass* hist;
+
+	int8_t* bimodal;
+	tage_entry* table[TAGE_TABLES];
+	int use_alt_on_na;
+	uint64_t tick;
+	uint32_t lfsr;
+
+	int8_t* sc_bias;
+	int8_t* sc_gehl[4];
+	int sc_threshold;
+	int sc_tc;
+
+	loop_entry* loop;
+	int with_loop;
+
+	unsigned int index(unsigned int i, unsigned int pc, const bp_history_t* h);
+	uint16_t tag(unsigned int i, unsigned int pc, const bp_history_t* h);
+	unsigned int sc_index(int j, unsigned int pc, const bp_history_t* h, bool tage_pred);
+	loop_entry* loop_lookup(unsigned int pc, bool* hit);
+
+	// Statistics.
+	uint64_t stat_provider[TAGE_TABLES + 1];	// [0]: bimodal
+	uint64_t stat_tage_miss;
+	uint64_t stat_sc_used;
+	uint64_t stat_sc_correct;
+	uint64_t stat_loop_used;
+	uint64_t stat_loop_correct;
+};
+
+// Prediction of one indirect jump, kept in its CTI queue entry.
+typedef struct {
+	int8_t provider;		// Longest matching table, -1 if none.
+	int8_t alt;
+	uint32_t alt_target;
+} ittage_pred_t;
+
+class ITTageClass
+{
+public:
+	ITTageClass(BranchHistoryClass* hist);
+	~ITTageClass();
+
+	unsigned int Predict(unsigned int pc, const bp_history_t* h, unsigned int btb_target, ittage_pred_t* p);
+	/*------------------------------------------------------------------------*\
+	 | Predicts the target of the indirect jump at pc, given the history
+	 |  before it and the BTB's target.
+	\*------------------------------------------------------------------------*/
+
+	void Update(unsigned int pc, const bp_history_t* h, const ittage_pred_t* p,
+	            unsigned int predicted, unsigned int target);
+	/*------------------------------------------------------------------------*\
+	 | Trains the predictor with a retired jump's target.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp);
+
+private:
+	typedef struct {
+		uint32_t target;
+		uint16_t tag;
+		uint8_t conf;			// 2-bit confidence.
+		uint8_t u;			// 1-bit useful.
+	} ittage_entry;
+
+	BranchHistoryClass* hist;
+
+	ittage_entry* table[ITTAGE_TABLES];
+	uint64_t tick;
+
+	unsigned int index(unsigned int i, unsigned int pc, const bp_history_t* h);
+	uint16_t tag(unsigned int i, unsigned int pc, const bp_history_t* h);
+
+	// Statistics.
+	uint64_t stat_provider[ITTAGE_TABLES + 1];	// [0]: BTB
+	uint64_t stat_miss;
+};
+
+#endif //TAGE_H
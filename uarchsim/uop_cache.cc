@@ -0,0 +1,165 @@
+/*--------------------------------------------------------------------------*\
+ | uop_cache.cc
+ |
+ | Decoded-uop (trace) cache and predecoded loop buffer of the fetch unit.
+ |  See uop_cache.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cassert>
+
+#include "uop_cache.h"
+
+/*--------------------------------------------------------------------------*\
+ | Decoded-uop (trace) cache.
+\*--------------------------------------------------------------------------*/
+
+UopCacheClass::UopCacheClass(unsigned int sets, unsigned int assoc, unsigned int width, unsigned int maxBlocks)
+	: array(sets, assoc),
+	  width((width < UOP_CACHE_MAX_TRACE) ? width : UOP_CACHE_MAX_TRACE),
+	  maxBlocks(maxBlocks)
+{
+	assert(maxBlocks > 0);
+	fill.length = 0;
+	fillStart = 0;
+	fillBlocks = 0;
+	lookups = 0;
+	hits = 0;
+	supplied = 0;
+	built = 0;
+}
+
+unsigned int UopCacheClass::Lookup(reg_t pc, const reg_t** next)
+{
+	bool hit;
+	reg_t old;
+	trace_t* t;
+
+	lookups++;
+	t = array.lookup((pc >> 2), &hit, &old, false, pc);
+	if (!hit)
+		return(0);
+
+	// The fill unit builds traces from I$ fetches only.
+	hits++;
+	fill.length = 0;
+	*next = t->next;
+	return(t->length);
+}
+
+void UopCacheClass::Supplied(unsigned int n)
+{
+	supplied += n;
+}
+
+void UopCacheClass::Fill(reg_t pc, reg_t next_pc, bool excepted)
+{
+	// Discard the trace being built on a redirect or exception.
+	if ((fill.length > 0) && (pc != fill.next[fill.length - 1]))
+		fill.length = 0;
+	if (excepted) {
+		fill.length = 0;
+		return;
+	}
+
+	if (fill.length == 0) {
+		fillStart = pc;
+		fillBlocks = 1;
+	}
+	fill.next[fill.length++] = next_pc;
+
+	// A taken control transfer ends a basic block.
+	if (next_pc != INCREMENT_PC(pc)) {
+		if (fillBlocks == maxBlocks) {
+			Install();
+			return;
+		}
+		fillBlocks++;
+	}
+
+	if (fill.length == width)
+		Install();
+}
+
+void UopCacheClass::Install()
+{
+	bool hit;
+	reg_t old;
+	trace_t* t;
+
+	t = array.lookup((fillStart >> 2), &hit, &old, true, fillStart);
+	*t = fill;
+	built++;
+	fill.length = 0;
+}
+
+void UopCacheClass::Print(FILE* fp)
+{
+	fprintf(fp, "uop cache (%u sets, %u-way, %u instructions, %u blocks per trace)\n",
+	        array.size, array.assoc, width, maxBlocks);
+	fprintf(fp, "   lookups:                %lu\n", lookups);
+	fprintf(fp, "   hits:                   %lu\n", hits);
+	fprintf(fp, "   hit rate:               %f\n", (lookups ? ((double)hits / (double)lookups) : 0.0));
+	fprintf(fp, "   instructions supplied:  %lu\n", supplied);
+	fprintf(fp, "   instructions per hit:   %f\n", (hits ? ((double)supplied / (double)hits) : 0.0));
+	fprintf(fp, "   traces built:           %lu\n", built);
+}
+
+/*--------------------------------------------------------------------------*\
+ | Predecoded loop buffer.
+\*--------------------------------------------------------------------------*/
+
+LoopBufferClass::LoopBufferClass(unsigned int size)
+	: size(size)
+{
+	captured = false;
+	start = 0;
+	end = 0;
+	candidate = 0;
+	captures = 0;
+	cycles = 0;
+	supplied = 0;
+}
+
+bool LoopBufferClass::Supplies(reg_t pc)
+{
+	return(captured && (pc >= start) && (pc <= end));
+}
+
+void LoopBufferClass::Train(reg_t pc, reg_t next_pc)
+{
+	if (captured) {
+		// Release the loop when fetch leaves it.
+		if ((next_pc < start) || (next_pc > end)) {
+			captured = false;
+			candidate = 0;
+		}
+	}
+	else if ((next_pc < pc) && ((((pc - next_pc) >> 2) + 1) <= size)) {
+		// A backward taken branch whose loop fits.
+		if (candidate == pc) {
+			captured = true;
+			start = next_pc;
+			end = pc;
+			captures++;
+		}
+		else {
+			candidate = pc;
+		}
+	}
+}
+
+void LoopBufferClass::Supplied(unsigned int n)
+{
+	cycles++;
+	supplied += n;
+}
+
+void LoopBufferClass::Print(FILE* fp)
+{
+	fprintf(fp, "loop buffer (%u instructions)\n", size);
+	fprintf(fp, "   loops captured:         %lu\n", captures);
+	fprintf(fp, "   fetch cycles supplied:  %lu\n", cycles);
+	fprintf(fp, "   instructions supplied:  %lu\n", supplied);
+	fprintf(fp, "   instructions per cycle: %f\n", (cycles ? ((double)supplied / (double)cycles) : 0.0));
+}
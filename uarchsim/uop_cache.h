@@ -0,0 +1,126 @@
+#ifndef UOP_CACHE_H
+#define UOP_CACHE_H
+
+#include <cstdio>
+#include <cstdint>
+#include "decode.h"
+#include "cache.h"
+
+/*--------------------------------------------------------------------------*\
+ | uop_cache.h
+ |
+ | Front-end structures that supply decoded instructions to the Fetch
+ |  Stage without the I$'s one-line, one-basic-block-per-cycle limit.
+ |
+ | UopCacheClass: a decoded-uop (trace) cache.  Each entry is a trace of
+ |  up to fetch width instructions, spanning up to maxBlocks basic blocks,
+ |  tagged by the PC of its first instruction.  The fill unit builds
+ |  traces from the instructions fetched from the I$ and installs them.
+ |  A hit supplies the trace's instructions for as long as the branch
+ |  predictor follows the trace's path, across taken branches and line
+ |  boundaries.
+ |
+ | LoopBufferClass: a predecoded loop buffer.  A loop (a backward taken
+ |  branch and its target) of at most size instructions is captured the
+ |  second time its branch is predicted taken in a row.  While fetch stays
+ |  inside a captured loop, the loop buffer supplies its instructions,
+ |  including multiple iterations per cycle.
+\*--------------------------------------------------------------------------*/
+
+#define UOP_CACHE_MAX_TRACE	32
+
+class UopCacheClass
+{
+public:
+	UopCacheClass(unsigned int sets, unsigned int assoc, unsigned int width, unsigned int maxBlocks);
+
+	unsigned int Lookup(reg_t pc, const reg_t** next);
+	/*------------------------------------------------------------------------*\
+	 | Looks up the trace starting at pc.
+	 |
+	 |  next              On a hit, set to the trace's next PCs: next[i] is
+	 |                     the PC following the trace's i-th instruction.
+	 |
+	 | Returns the length of the trace, or 0 on a miss.
+	\*------------------------------------------------------------------------*/
+
+	void Supplied(unsigned int n);
+	/*------------------------------------------------------------------------*\
+	 | Records that n instructions of the last trace hit were fetched.
+	\*------------------------------------------------------------------------*/
+
+	void Fill(reg_t pc, reg_t next_pc, bool excepted);
+	/*------------------------------------------------------------------------*\
+	 | Fill unit.  Appends an instruction fetched from the I$ (in program
+	 |  order, on either path) to the trace being built.  The trace is
+	 |  installed once it reaches the maximum length or number of blocks.
+	 |  The trace is discarded if the instruction does not follow it (a
+	 |  redirect), or excepted.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp);
+
+private:
+	typedef struct {
+		unsigned int length;
+		reg_t next[UOP_CACHE_MAX_TRACE];
+	} trace_t;
+
+	cache<trace_t> array;
+
+	unsigned int width;		/* Maximum instructions per trace.           */
+	unsigned int maxBlocks;		/* Maximum basic blocks per trace.           */
+
+	// Fill unit.
+	reg_t fillStart;
+	unsigned int fillBlocks;
+	trace_t fill;
+
+	void Install();
+
+	// Statistics.
+	uint64_t lookups;
+	uint64_t hits;
+	uint64_t supplied;		/* Instructions fetched from hits.            */
+	uint64_t built;			/* Traces installed.                          */
+};
+
+class LoopBufferClass
+{
+public:
+	LoopBufferClass(unsigned int size);
+
+	bool Supplies(reg_t pc);
+	/*------------------------------------------------------------------------*\
+	 | Returns whether a loop is captured and pc is inside it.
+	\*------------------------------------------------------------------------*/
+
+	void Train(reg_t pc, reg_t next_pc);
+	/*------------------------------------------------------------------------*\
+	 | Observes each fetched instruction and its predicted next PC.
+	 |  Captures a loop on the second consecutive taken prediction of the
+	 |  same backward branch, and releases it when fetch leaves the loop.
+	\*------------------------------------------------------------------------*/
+
+	void Supplied(unsigned int n);
+	/*------------------------------------------------------------------------*\
+	 | Records that n instructions were fetched from the loop buffer.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp);
+
+private:
+	unsigned int size;		/* Capacity in instructions.                 */
+
+	bool captured;
+	reg_t start;			/* The loop's target...                      */
+	reg_t end;			/* ...and backward branch.                   */
+	reg_t candidate;		/* Last backward taken branch that fit.      */
+
+	// Statistics.
+	uint64_t captures;
+	uint64_t cycles;		/* Fetch cycles supplied by the loop buffer.  */
+	uint64_t supplied;		/* Instructions supplied.                     */
+};
+
+#endif //UOP_CACHE_H
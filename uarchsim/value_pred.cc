@@ -0,0 +1,334 @@
+/*--------------------------------------------------------------------------*\
+ | value_pred.cc
+ |
+ | Value predictor.  See value_pred.h.
+\*--------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
+#include "value_pred.h"
+
+// Probability of incrementing confidence level i is 1/(1 << vp_fpc_shift[i]).
+static const unsigned int vp_fpc_shift[VP_CONF_MAX] = { 0, 0, 1, 1, 2, 2, 3 };
+
+static const char* const vp_names[] = { "none", "lvp", "stride", "vtage" };
+
+// Folds the newest len bits of history h into bits bits.
+static inline unsigned int fold(uint64_t h, unsigned int len, unsigned int bits)
+{
+	unsigned int f = 0;
+
+	if (len < 64)
+		h &= ((1ULL << len) - 1);
+	while (h) {
+		f ^= (unsigned int)(h & ((1ULL << bits) - 1));
+		h >>= bits;
+	}
+	return(f);
+}
+
+bool ValuePredClass::Exists(const char* name)
+{
+	for (unsigned int i = 0; i < (sizeof(vp_names) / sizeof(vp_names[0])); i++)
+		if (!strcmp(name, vp_names[i]))
+			return(true);
+	return(false);
+}
+
+ValuePredClass::ValuePredClass(const char* name, unsigned int size)
+	: name(name)
+{
+	unsigned int i;
+
+	assert((size >= 64) && !(size & (size - 1)));
+	use_lvp = (!strcmp(name, "lvp") || !strcmp(name, "vtage"));
+	use_stride = (!strcmp(name, "stride") || !strcmp(name, "vtage"));
+	use_vtage = !strcmp(name, "vtage");
+	assert(use_lvp || use_stride);
+
+	for (logSize = 0; (1U << logSize) < size; logSize++)
+		;
+	logTagged = (logSize - 2);
+
+	lvp = NULL;
+	stride = NULL;
+	if (use_lvp) {
+		lvp = new lvp_entry[size];
+		memset(lvp, 0, size * sizeof(lvp_entry));
+	}
+	if (use_stride) {
+		stride = new stride_entry[size];
+		memset(stride, 0, size * sizeof(stride_entry));
+	}
+	for (i = 0; i < VP_TAGGED_TABLES; i++) {
+		vtage[i] = NULL;
+		hist_len[i] = (2 << i);		// 2, 4, ..., 64
+		if (use_vtage) {
+			vtage[i] = new vtage_entry[1 << logTagged];
+			memset(vtage[i], 0, (1 << logTagged) * sizeof(vtage_entry));
+		}
+	}
+
+	ghr = 0;
+	ghr_retired = 0;
+	lfsr = 0xace1;
+
+	for (i = 0; i < 2; i++) {
+		eligible[i] = 0;
+		predicted[i] = 0;
+		correct[i] = 0;
+	}
+	for (i = 0; i < VP_SOURCES; i++) {
+		src_predicted[i] = 0;
+		src_correct[i] = 0;
+	}
+}
+
+ValuePredClass::~ValuePredClass()
+{
+	delete [] lvp;
+	delete [] stride;
+	for (unsigned int i = 0; i < VP_TAGGED_TABLES; i++)
+		delete [] vtage[i];
+}
+
+unsigned int ValuePredClass::vtage_index(unsigned int i, uint64_t pc, uint64_t h)
+{
+	return(((pc >> 2) ^ (pc >> (2 + logTagged)) ^ fold(h, hist_len[i], logTagged) ^ (i << 1)) & ((1 << logTagged) - 1));
+}
+
+uint16_t ValuePredClass::vtage_tag(unsigned int i, uint64_t pc, uint64_t h)
+{
+	return(((pc >> 2) ^ fold(h, hist_len[i], 12) ^ (fold(h, hist_len[i], 11) << 1)) & 0xfff);
+}
+
+int ValuePredClass::vtage_provider(uint64_t pc, uint64_t h)
+{
+	for (int i = (VP_TAGGED_TABLES - 1); i >= 0; i--)
+		if (vtage[i][vtage_index(i, pc, h)].tag == vtage_tag(i, pc, h))
+			return(i);
+	return(-1);
+}
+
+void ValuePredClass::conf_inc(uint8_t* conf)
+{
+	if (*conf < VP_CONF_MAX) {
+		lfsr = ((lfsr >> 1) ^ (-(lfsr & 1u) & 0xb400u));
+		if ((lfsr & ((1 << vp_fpc_shift[*conf]) - 1)) == 0)
+			(*conf)++;
+	}
+}
+
+void ValuePredClass::Predict(uint64_t pc, bool eligible, bool load, vp_info_t* p)
+{
+	int provider;
+
+	p->lookup = eligible;
+	p->predicted = false;
+	p->ghr = ghr;
+	p->load = load;
+	p->stride_inflight = false;
+	p->source = -1;
+	if (!eligible)
+		return;
+
+	if (use_vtage && ((provider = vtage_provider(pc, ghr)) >= 0)) {
+		vtage_entry* e = &vtage[provider][vtage_index(provider, pc, ghr)];
+		if (e->conf == VP_CONF_MAX) {
+			p->predicted = true;
+			p->value = e->value;
+			p->source = VP_SRC_VTAGE;
+		}
+	}
+
+	if (use_stride) {
+		stride_entry* e = &stride[lvp_index(pc)];
+		if (e->tag == pc_tag(pc)) {
+			if (!p->predicted && (e->conf == VP_CONF_MAX)) {
+				p->predicted = true;
+				p->value = (e->last + (uint64_t)(e->stride * (int64_t)(e->inflight + 1)));
+				p->source = VP_SRC_STRIDE;
+			}
+			e->inflight++;
+			p->stride_inflight = true;
+		}
+	}
+
+	if (use_lvp && !p->predicted) {
+		lvp_entry* e = &lvp[lvp_index(pc)];
+		if ((e->tag == pc_tag(pc)) && (e->conf == VP_CONF_MAX)) {
+			p->predicted = true;
+			p->value = e->value;
+			p->source = VP_SRC_LVP;
+		}
+	}
+}
+
+void ValuePredClass::Branch(bool taken)
+{
+	ghr = ((ghr << 1) | (taken ? 1 : 0));
+}
+
+void ValuePredClass::Recover(const vp_info_t* p, bool branch, bool taken)
+{
+	ghr = p->ghr;
+	if (branch)
+		Branch(taken);
+}
+
+void ValuePredClass::Squash(uint64_t pc, vp_info_t* p)
+{
+	if (p->lookup && p->stride_inflight) {
+		stride_entry* e = &stride[lvp_index(pc)];
+		if ((e->tag == pc_tag(pc)) && (e->inflight > 0))
+			e->inflight--;
+	}
+	p->lookup = false;
+}
+
+void ValuePredClass::Flush()
+{
+	ghr = ghr_retired;
+}
+
+void ValuePredClass::RetireBranch(bool taken)
+{
+	ghr_retired = ((ghr_retired << 1) | (taken ? 1 : 0));
+}
+
+void ValuePredClass::Update(uint64_t pc, vp_info_t* p, uint64_t value)
+{
+	bool base_correct = false;
+
+	if (!p->lookup)
+		return;
+
+	// Statistics.
+	eligible[p->load]++;
+	if (p->predicted) {
+		predicted[p->load]++;
+		src_predicted[p->source]++;
+		if (p->value == value) {
+			correct[p->load]++;
+			src_correct[p->source]++;
+		}
+	}
+
+	// Stride predictor.
+	if (use_stride) {
+		stride_entry* e = &stride[lvp_index(pc)];
+		if (e->tag == pc_tag(pc)) {
+			if (p->stride_inflight && (e->inflight > 0))
+				e->inflight--;
+			if ((int64_t)(value - e->last) == e->stride) {
+				conf_inc(&e->conf);
+			}
+			else {
+				e->stride = (int64_t)(value - e->last);
+				e->conf = 0;
+			}
+			e->last = value;
+		}
+		else {
+			e->tag = pc_tag(pc);
+			e->conf = 0;
+			e->inflight = 0;
+			e->last = value;
+			e->stride = 0;
+		}
+	}
+
+	// Last-value predictor (VTAGE's base table).
+	if (use_lvp) {
+		lvp_entry* e = &lvp[lvp_index(pc)];
+		if (e->tag == pc_tag(pc)) {
+			base_correct = (e->value == value);
+			if (base_correct) {
+				conf_inc(&e->conf);
+			}
+			else {
+				e->value = value;
+				e->conf = 0;
+			}
+		}
+		else {
+			e->tag = pc_tag(pc);
+			e->conf = 0;
+			e->value = value;
+		}
+	}
+
+	// VTAGE tagged tables.
+	if (use_vtage) {
+		int provider = vtage_provider(pc, p->ghr);
+		bool provider_correct = base_correct;
+		int i;
+
+		if (provider >= 0) {
+			vtage_entry* e = &vtage[provider][vtage_index(provider, pc, p->ghr)];
+			provider_correct = (e->value == value);
+			if (provider_correct) {
+				conf_inc(&e->conf);
+				if (e->conf == VP_CONF_MAX)
+					e->u = 1;
+			}
+			else {
+				if (e->conf == 0)
+					e->value = value;
+				e->conf = 0;
+				e->u = 0;
+			}
+		}
+
+		// Allocate in a table with a longer history.
+		if (!provider_correct) {
+			bool allocated = false;
+			for (i = (provider + 1); (i < VP_TAGGED_TABLES) && !allocated; i++) {
+				vtage_entry* e = &vtage[i][vtage_index(i, pc, p->ghr)];
+				if (e->u == 0) {
+					e->tag = vtage_tag(i, pc, p->ghr);
+					e->value = value;
+					e->conf = 0;
+					allocated = true;
+				}
+			}
+			if (!allocated) {
+				for (i = (provider + 1); i < VP_TAGGED_TABLES; i++)
+					vtage[i][vtage_index(i, pc, p->ghr)].u = 0;
+			}
+		}
+	}
+
+	p->lookup = false;
+}
+
+void ValuePredClass::Print(FILE* fp)
+{
+	static const char* const src_names[VP_SOURCES] = { "last value", "stride", "vtage" };
+	static const char* const class_names[2] = { "ALU", "loads" };
+	uint64_t all_eligible = (eligible[0] + eligible[1]);
+	uint64_t all_predicted = (predicted[0] + predicted[1]);
+	uint64_t all_correct = (correct[0] + correct[1]);
+	unsigned int i;
+
+	fprintf(fp, "value predictor (%s, %u entries", name, (1 << logSize));
+	if (use_vtage)
+		fprintf(fp, ", %u x %u tagged entries", VP_TAGGED_TABLES, (1 << logTagged));
+	fprintf(fp, ")\n");
+	fprintf(fp, "   eligible retired:       %lu\n", all_eligible);
+	fprintf(fp, "   predicted:              %lu\n", all_predicted);
+	fprintf(fp, "   correct:                %lu\n", all_correct);
+	fprintf(fp, "   mispredicted:           %lu\n", (all_predicted - all_correct));
+	fprintf(fp, "   coverage:               %f\n", (all_eligible ? ((double)all_predicted / (double)all_eligible) : 0.0));
+	fprintf(fp, "   accuracy:               %f\n", (all_predicted ? ((double)all_correct / (double)all_predicted) : 0.0));
+	for (i = 0; i < 2; i++)
+		fprintf(fp, "   %-6s eligible %12lu  coverage %f  accuracy %f\n", class_names[i], eligible[i],
+		        (eligible[i] ? ((double)predicted[i] / (double)eligible[i]) : 0.0),
+		        (predicted[i] ? ((double)correct[i] / (double)predicted[i]) : 0.0));
+	for (i = 0; i < VP_SOURCES; i++)
+		if (src_predicted[i])
+			fprintf(fp, "   %-10s predicted %12lu  accuracy %f\n", src_names[i], src_predicted[i],
+			        ((double)src_correct[i] / (double)src_predicted[i]));
+}
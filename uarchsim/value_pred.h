@@ -0,0 +1,163 @@
+#ifndef VALUE_PRED_H
+#define VALUE_PRED_H
+
+#include <cstdio>
+#include <cstdint>
+
+/*--------------------------------------------------------------------------*\
+ | value_pred.h
+ |
+ | Value predictor for loads and integer ALU instructions (see --vp).
+ |  The Rename Stage consults it; a confident prediction is written into
+ |  the destination physical register at dispatch, so dependents issue
+ |  without waiting for the producer.  The producer validates the
+ |  prediction when it executes, and a misprediction squashes everything
+ |  after the producer when it retires.  The predictor is trained with
+ |  the values of retired instructions.
+ |
+ | Predictors (by name):
+ |  none      No value prediction.
+ |  lvp       Last value: predicts the instruction's previous value.
+ |  stride    Last value plus the instruction's last stride, times the
+ |             number of its instances in flight.
+ |  vtage     EVES-style: VTAGE (a last-value base table and
+ |             VP_TAGGED_TABLES tagged tables indexed with geometrically
+ |             increasing global branch history lengths) and a stride
+ |             predictor.  VTAGE's prediction is used if it is confident,
+ |             otherwise the stride predictor's.
+ |
+ | Since a misprediction costs a full squash, predictions are used only at
+ |  saturated confidence, and confidence counters are forward
+ |  probabilistic: higher levels are reached with decreasing probability.
+ |
+ | The speculative global branch history is updated at rename with the
+ |  predicted direction of conditional branches, repaired at a branch
+ |  misprediction from the history recorded in the branch's payload, and
+ |  reset to the retired history on a full squash.
+\*--------------------------------------------------------------------------*/
+
+#define VP_TAGGED_TABLES	6
+#define VP_CONF_MAX		7
+
+// Prediction of one instruction, kept in its payload.
+typedef struct {
+	bool lookup;		// The instruction consulted the predictor, and has not retired or been squashed.
+	bool predicted;		// A confident prediction was made...
+	uint64_t value;		// ...of this value.
+	uint64_t ghr;		// Global branch history before the instruction.
+	bool load;
+	bool stride_inflight;	// Counted as an in-flight instance by the stride predictor.
+	int8_t source;		// Component that made the prediction (VP_SRC_*).
+} vp_info_t;
+
+class ValuePredClass
+{
+public:
+	static bool Exists(const char* name);
+	/*------------------------------------------------------------------------*\
+	 | Returns whether there is a value predictor (or "none") by that name.
+	\*------------------------------------------------------------------------*/
+
+	ValuePredClass(const char* name, unsigned int size);
+	/*------------------------------------------------------------------------*\
+	 | Creates the named predictor; its last-value and stride tables have
+	 |  size (a power of 2) entries, its tagged tables size/4 entries each.
+	\*------------------------------------------------------------------------*/
+
+	~ValuePredClass();
+
+	void Predict(uint64_t pc, bool eligible, bool load, vp_info_t* p);
+	/*------------------------------------------------------------------------*\
+	 | Called at rename for every instruction.  If the instruction is
+	 |  eligible for value prediction, consults the predictor.
+	\*------------------------------------------------------------------------*/
+
+	void Branch(bool taken);
+	/*------------------------------------------------------------------------*\
+	 | A conditional branch was renamed, predicted taken or not.
+	\*------------------------------------------------------------------------*/
+
+	void Recover(const vp_info_t* p, bool branch, bool taken);
+	/*------------------------------------------------------------------------*\
+	 | A mispredicted CTI resolved: restores the history before it (p),
+	 |  plus its outcome if it is a conditional branch.
+	\*------------------------------------------------------------------------*/
+
+	void Squash(uint64_t pc, vp_info_t* p);
+	/*------------------------------------------------------------------------*\
+	 | An instruction that consulted the predictor was squashed.
+	\*------------------------------------------------------------------------*/
+
+	void Flush();
+	/*------------------------------------------------------------------------*\
+	 | Full squash: restores the retired history.
+	\*------------------------------------------------------------------------*/
+
+	void Update(uint64_t pc, vp_info_t* p, uint64_t value);
+	/*------------------------------------------------------------------------*\
+	 | Trains the predictor with a retired instruction's value.
+	\*------------------------------------------------------------------------*/
+
+	void RetireBranch(bool taken);
+	/*------------------------------------------------------------------------*\
+	 | A conditional branch retired.
+	\*------------------------------------------------------------------------*/
+
+	void Print(FILE* fp);
+
+private:
+	enum {VP_SRC_LVP, VP_SRC_STRIDE, VP_SRC_VTAGE, VP_SOURCES};
+
+	typedef struct {
+		uint16_t tag;
+		uint8_t conf;
+		uint64_t value;
+	} lvp_entry;
+
+	typedef struct {
+		uint16_t tag;
+		uint8_t conf;
+		uint16_t inflight;	// Instances predicted but not retired.
+		uint64_t last;		// Last retired value.
+		int64_t stride;
+	} stride_entry;
+
+	typedef struct {
+		uint16_t tag;
+		uint8_t conf;
+		uint8_t u;		// Useful bit.
+		uint64_t value;
+	} vtage_entry;
+
+	const char* name;
+	bool use_lvp;			// lvp, or VTAGE's base table.
+	bool use_stride;
+	bool use_vtage;
+
+	unsigned int logSize;
+	unsigned int logTagged;
+	lvp_entry* lvp;
+	stride_entry* stride;
+	vtage_entry* vtage[VP_TAGGED_TABLES];
+	unsigned int hist_len[VP_TAGGED_TABLES];
+
+	uint64_t ghr;			// Speculative global branch history.
+	uint64_t ghr_retired;
+	uint32_t lfsr;
+
+	unsigned int lvp_index(uint64_t pc) { return((pc >> 2) & ((1 << logSize) - 1)); }
+	unsigned int vtage_index(unsigned int i, uint64_t pc, uint64_t h);
+	uint16_t pc_tag(uint64_t pc) { return((pc >> (2 + logSize)) & 0xffff); }
+	uint16_t vtage_tag(unsigned int i, uint64_t pc, uint64_t h);
+	int vtage_provider(uint64_t pc, uint64_t h);
+	void conf_inc(uint8_t* conf);
+
+	// Statistics.
+	uint64_t eligible[2];		// Retired eligible instructions: [0] ALU, [1] loads.
+	uint64_t predicted[2];
+	uint64_t correct[2];
+	uint64_t src_predicted[VP_SOURCES];
+	uint64_t src_correct[VP_SOURCES];
+};
+
+#endif //VALUE_PRED_H
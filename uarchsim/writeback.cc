@@ -46,7 +46,7 @@ void pipeline_t::writeback(unsigned int lane_number) {
             // the next time this branch is executed, it will calculate the right value.
 
             //assert(PAY.buf[index].next_pc == PAY.buf[index].c_next_pc);
-            assert((PAY.buf[index].next_pc == PAY.buf[index].c_next_pc) || !PAY.buf[index].good_instruction || SPEC_DISAMBIG);
+            assert((PAY.buf[index].next_pc == PAY.buf[index].c_next_pc) || !PAY.buf[index].good_instruction || SPEC_DISAMBIG || VP);
 
             // FIX_ME #15a
             // The simulator is running in perfect branch prediction mode, therefore, all branches are correctly predicted.
@@ -148,6 +148,13 @@ void pipeline_t::writeback(unsigned int lane_number) {
 
 			resolve(branch_ID, condition);
 
+            // Repair the value predictor: its in-flight instances after the branch, and its history.
+            if (VP) {
+               vp_squash(MOD((index + 2), PAYLOAD_BUFFER_SIZE));
+               VP->Recover(&PAY.buf[index].vp, (PAY.buf[index].inst.opcode() == OP_BRANCH),
+                           (PAY.buf[index].c_next_pc != INCREMENT_PC(PAY.buf[index].pc)));
+            }
+
             // Rollback PAY to the point of the branch.
             PAY.rollback(index);
          }
@@ -164,6 +171,7 @@ void pipeline_t::writeback(unsigned int lane_number) {
 		
 	  unsigned int AL_index=PAY.buf[index].AL_index;
 	  REN->set_complete(AL_index);	
+	  PAY.buf[index].complete_cycle = cycle;
 
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////